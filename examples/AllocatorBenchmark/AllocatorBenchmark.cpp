@@ -0,0 +1,142 @@
+#include "lpe/lpe.hpp"
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace lpe::rendering;
+
+struct Operation
+{
+  bool Allocate;
+  uint64_t Size;
+  uint64_t Alignment;
+  uint32_t Random;  // picks the freed allocation among the live ones
+};
+
+// streaming like trace: sizes from 4KiB to 8MiB (log uniform), live memory hovers around 512MiB
+std::vector<Operation> CreateTrace(size_t count)
+{
+  std::mt19937 random(1337);
+  std::vector<Operation> trace;
+  trace.reserve(count);
+
+  const uint64_t targetLive = 512ull << 20;
+  uint64_t live = 0;
+  std::vector<uint64_t> sizes;
+
+  for (size_t i = 0; i < count; i++)
+  {
+    bool allocate = sizes.empty() || random() % 100 < (live < targetLive ? 60u : 40u);
+
+    if (allocate)
+    {
+      uint64_t size = 4096ull << (random() % 11);
+      size += random() % size;
+      uint64_t alignment = 256ull << (random() % 9);
+
+      trace.push_back({ true, size, alignment, 0 });
+      sizes.push_back(size);
+      live += size;
+    }
+    else
+    {
+      uint32_t value = random();
+      size_t index = value % sizes.size();
+
+      trace.push_back({ false, 0, 0, value });
+      live -= sizes[index];
+      sizes[index] = sizes.back();
+      sizes.pop_back();
+    }
+  }
+
+  return trace;
+}
+
+int main()
+{
+  const size_t count = 200000;
+  const size_t samples = 10;
+  const uint64_t chunkSize = 64ull << 20;
+  const AllocationPolicy policies[] = { AllocationPolicy::BestFit, AllocationPolicy::Tlsf, AllocationPolicy::Buddy, AllocationPolicy::Linear };
+  const char* names[] = { "BestFit", "Tlsf", "Buddy", "Linear" };
+
+  auto trace = CreateTrace(count);
+
+  std::cout << count << " random allocations and frees, " << (chunkSize >> 20) << "MiB chunks" << std::endl;
+  std::cout << std::fixed << std::setprecision(2);
+
+  for (uint32_t i = 0; i < 4; i++)
+  {
+    HostMemoryBackend backend;
+    MemoryPool pool;
+    pool.Create(backend, 0, chunkSize, policies[i]);
+
+    std::vector<PoolAllocation> live;
+    std::vector<float> fragmentation;
+    std::vector<size_t> chunks;
+    size_t failed = 0;
+
+    auto start = std::chrono::high_resolution_clock::now();
+
+    for (size_t step = 0; step < trace.size(); step++)
+    {
+      auto& operation = trace[step];
+
+      if (operation.Allocate)
+      {
+        PoolAllocation allocation = {};
+        if (pool.Allocate(operation.Size, operation.Alignment, allocation))
+        {
+          live.push_back(allocation);
+        }
+        else
+        {
+          failed++;
+        }
+      }
+      else if (!live.empty())
+      {
+        size_t index = operation.Random % live.size();
+        pool.Free(live[index]);
+        live[index] = live.back();
+        live.pop_back();
+      }
+
+      if ((step + 1) % (count / samples) == 0)
+      {
+        fragmentation.push_back(pool.GetFragmentation());
+        chunks.push_back(pool.GetChunkCount());
+      }
+    }
+
+    std::chrono::duration<double> seconds = std::chrono::high_resolution_clock::now() - start;
+
+    std::cout << names[i] << std::endl;
+    std::cout << "  MOps/s          " << count / seconds.count() / 1000000.0 << std::endl;
+    std::cout << "  peak chunks     " << pool.GetPeakChunkCount() << std::endl;
+    std::cout << "  peak memory MiB " << (backend.GetPeakAllocatedSize() >> 20) << std::endl;
+    std::cout << "  failed          " << failed << std::endl;
+    std::cout << "  fragmentation  ";
+    for (auto value : fragmentation)
+    {
+      std::cout << " " << value;
+    }
+    std::cout << std::endl << "  chunks         ";
+    for (auto value : chunks)
+    {
+      std::cout << " " << value;
+    }
+    std::cout << std::endl;
+
+    for (auto&& allocation : live)
+    {
+      pool.Free(allocation);
+    }
+    pool.Destroy();
+  }
+
+  return 0;
+}
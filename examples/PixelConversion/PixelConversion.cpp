@@ -0,0 +1,62 @@
+#include "lpe/lpe.hpp"
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace lpe::rendering;
+
+// megapixels per second of the fastest of a few runs
+double Measure(const std::function<void()>& kernel,
+               size_t pixels)
+{
+  double best = 0;
+
+  for (size_t run = 0; run < 5; run++)
+  {
+    auto start = std::chrono::high_resolution_clock::now();
+    kernel();
+    std::chrono::duration<double> seconds = std::chrono::high_resolution_clock::now() - start;
+
+    best = std::max(best, pixels / seconds.count() / 1000000.0);
+  }
+
+  return best;
+}
+
+int main()
+{
+  const size_t pixels = 2048 * 2048;
+  const uint8_t bgra[4] = { 2, 1, 0, 3 };
+  const char* levels[] = { "Scalar", "SSE2", "SSSE3", "AVX2" };
+
+  std::mt19937 random;
+  std::vector<uint8_t> source(pixels * 4);
+  std::vector<uint8_t> target(pixels * 4);
+  std::vector<float> linear(pixels * 4);
+
+  for (auto&& value : source)
+  {
+    value = static_cast<uint8_t>(random());
+  }
+
+  auto supported = static_cast<uint32_t>(GetSupportedSimdLevel());
+
+  std::cout << "MPixel/s for a 2048x2048 image" << std::endl;
+
+  for (uint32_t level = 0; level <= supported; level++)
+  {
+    SetSimdLevel(static_cast<SimdLevel>(level));
+
+    std::cout << levels[level] << std::endl;
+    std::cout << "  RGB -> RGBA     " << Measure([&]() { ExpandRGBToRGBA(source.data(), target.data(), pixels); }, pixels) << std::endl;
+    std::cout << "  RGBA -> BGRA    " << Measure([&]() { SwizzleRGBA(source.data(), target.data(), pixels, bgra); }, pixels) << std::endl;
+    std::cout << "  premultiply     " << Measure([&]() { PremultiplyAlpha(source.data(), target.data(), pixels); }, pixels) << std::endl;
+    std::cout << "  normal map RG   " << Measure([&]() { PackNormalMap(source.data(), target.data(), pixels); }, pixels) << std::endl;
+    std::cout << "  sRGB -> linear  " << Measure([&]() { SrgbToLinear(source.data(), linear.data(), pixels); }, pixels) << std::endl;
+    std::cout << "  linear -> sRGB  " << Measure([&]() { LinearToSrgb(linear.data(), target.data(), pixels); }, pixels) << std::endl;
+  }
+
+  return 0;
+}
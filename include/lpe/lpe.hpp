@@ -11,10 +11,38 @@
 #include "../../src/LogManager.h"
 #include "../../src/RenderManager.h"
 #include "../../src/RenderObject.h"
+#include "../../src/Mesh.h"
+#include "../../src/StaticBatch.h"
+#include "../../src/MeshImporter.h"
+#include "../../src/CookedMesh.h"
+#include "../../src/BlockCompression.h"
+#include "../../src/CookedTexture.h"
+#include "../../src/MeshStreamer.h"
+#include "../../src/Triangulator.h"
+#include "../../src/TextureAtlas.h"
+#include "../../src/PixelConversion.h"
+#include "../../src/ThreadPool.h"
+#include "../../src/FrameArena.h"
+#include "../../src/HostAllocator.h"
+#include "../../src/MemoryBackend.h"
+#include "../../src/MemoryPool.h"
+#include "../../src/AliasingPlanner.h"
+#include "../../src/SubAllocator.h"
+#include "../../src/BestFitAllocator.h"
+#include "../../src/BuddyAllocator.h"
+#include "../../src/LinearAllocator.h"
+#include "../../src/RingAllocator.h"
+#include "../../src/TlsfAllocator.h"
 #include "../../src/VkAttachment.h"
 #include "../../src/VkMemoryManagement.h"
 #include "../../src/VkRenderPass.h"
 #include "../../src/VkTexture.h"
+#include "../../src/vulkan/AliasedRenderTargets.hpp"
+#include "../../src/vulkan/GeometryBuffer.hpp"
+#include "../../src/vulkan/HostAllocationCallbacks.hpp"
+#include "../../src/vulkan/RingBufferAllocator.hpp"
+#include "../../src/vulkan/TextureLoader.hpp"
+#include "../../src/vulkan/TextureResidency.hpp"
 #include "../../src/vulkan/VulkanManager.hpp"
 
 namespace lpe
@@ -0,0 +1,168 @@
+#include "AliasingPlanner.h"
+
+#include <algorithm>
+#include <cassert>
+#include <numeric>
+
+namespace
+{
+  uint64_t AlignUp(uint64_t value,
+                   uint64_t alignment)
+  {
+    return (value + alignment - 1) / alignment * alignment;
+  }
+}
+
+lpe::rendering::AliasingPlanner::AliasingPlanner()
+  : size(0)
+{
+}
+
+bool lpe::rendering::AliasingPlanner::LifetimesOverlap(const AliasedResource& first,
+                                                       const AliasedResource& second)
+{
+  return first.FirstPass <= second.LastPass && second.FirstPass <= first.LastPass;
+}
+
+uint32_t lpe::rendering::AliasingPlanner::Add(uint64_t size,
+                                              uint64_t alignment,
+                                              uint32_t firstPass,
+                                              uint32_t lastPass)
+{
+  assert(alignment > 0 && (alignment & (alignment - 1)) == 0);
+  assert(firstPass <= lastPass);
+
+  resources.push_back({ size, alignment, firstPass, lastPass });
+  offsets.push_back(0);
+
+  return static_cast<uint32_t>(resources.size() - 1);
+}
+
+void lpe::rendering::AliasingPlanner::Clear()
+{
+  resources.clear();
+  offsets.clear();
+  size = 0;
+}
+
+uint64_t lpe::rendering::AliasingPlanner::Plan()
+{
+  struct Range
+  {
+    uint64_t Begin;
+    uint64_t End;
+  };
+
+  std::vector<uint32_t> order(resources.size());
+  std::iota(std::begin(order), std::end(order), 0);
+
+  // large resources first, the small ones fill the gaps between them
+  std::stable_sort(std::begin(order),
+                   std::end(order),
+                   [this](uint32_t first, uint32_t second)
+                   {
+                     return resources[first].Size > resources[second].Size;
+                   });
+
+  std::vector<uint32_t> placed;
+  std::vector<Range> blocked;
+  uint64_t maxAlignment = 1;
+  size = 0;
+
+  for (auto index : order)
+  {
+    auto& resource = resources[index];
+
+    blocked.clear();
+    for (auto other : placed)
+    {
+      if (LifetimesOverlap(resource, resources[other]))
+      {
+        blocked.push_back({ offsets[other], offsets[other] + resources[other].Size });
+      }
+    }
+
+    std::sort(std::begin(blocked),
+              std::end(blocked),
+              [](const Range& first, const Range& second)
+              {
+                return first.Begin < second.Begin;
+              });
+
+    // lowest gap between the ranges of resources alive at the same time
+    uint64_t offset = 0;
+    for (auto&& range : blocked)
+    {
+      if (AlignUp(offset, resource.Alignment) + resource.Size <= range.Begin)
+      {
+        break;
+      }
+
+      offset = std::max(offset, range.End);
+    }
+
+    offsets[index] = AlignUp(offset, resource.Alignment);
+    placed.push_back(index);
+
+    size = std::max(size, offsets[index] + resource.Size);
+    maxAlignment = std::max(maxAlignment, resource.Alignment);
+  }
+
+  size = AlignUp(size, maxAlignment);
+
+  return size;
+}
+
+uint64_t lpe::rendering::AliasingPlanner::GetOffset(uint32_t index) const
+{
+  assert(index < offsets.size());
+
+  return offsets[index];
+}
+
+const lpe::rendering::AliasedResource& lpe::rendering::AliasingPlanner::GetResource(uint32_t index) const
+{
+  assert(index < resources.size());
+
+  return resources[index];
+}
+
+size_t lpe::rendering::AliasingPlanner::GetResourceCount() const
+{
+  return resources.size();
+}
+
+uint64_t lpe::rendering::AliasingPlanner::GetSize() const
+{
+  return size;
+}
+
+uint64_t lpe::rendering::AliasingPlanner::GetUnaliasedSize() const
+{
+  uint64_t total = 0;
+  for (auto&& resource : resources)
+  {
+    total = AlignUp(total, resource.Alignment) + resource.Size;
+  }
+
+  return total;
+}
+
+std::vector<uint32_t> lpe::rendering::AliasingPlanner::GetAliases(uint32_t index) const
+{
+  assert(index < resources.size());
+
+  std::vector<uint32_t> aliases;
+  auto begin = offsets[index];
+  auto end = begin + resources[index].Size;
+
+  for (uint32_t other = 0; other < resources.size(); ++other)
+  {
+    if (other != index && offsets[other] < end && begin < offsets[other] + resources[other].Size)
+    {
+      aliases.push_back(other);
+    }
+  }
+
+  return aliases;
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace lpe
+{
+  namespace rendering
+  {
+    /**
+     * \brief Resource which only lives between two passes of a frame, e.g. a shadow map or a post process target
+     */
+    struct AliasedResource
+    {
+      uint64_t Size;
+      uint64_t Alignment;
+      uint32_t FirstPass;
+      uint32_t LastPass;  // inclusive
+    };
+
+    /**
+     * \brief Places resources with known lifetimes in one memory block, resources which are never alive
+     * at the same time may share bytes. Greedy: largest resources first, each at the lowest offset which
+     * doesn't overlap a placed resource with an overlapping lifetime.
+     * Only offsets are computed, the memory and the aliasing barriers are up to the owner
+     * (see vulkan::AliasedRenderTargets).
+     */
+    class AliasingPlanner
+    {
+    private:
+      std::vector<AliasedResource> resources;
+      std::vector<uint64_t> offsets;
+      uint64_t size;
+
+      static bool LifetimesOverlap(const AliasedResource& first,
+                                   const AliasedResource& second);
+    public:
+      AliasingPlanner();
+      AliasingPlanner(const AliasingPlanner& other) = default;
+      AliasingPlanner(AliasingPlanner&& other) noexcept = default;
+      AliasingPlanner& operator=(const AliasingPlanner& other) = default;
+      AliasingPlanner& operator=(AliasingPlanner&& other) noexcept = default;
+      ~AliasingPlanner() = default;
+
+      /**
+       * \param alignment power of two
+       * \return index of the resource
+       */
+      uint32_t Add(uint64_t size,
+                   uint64_t alignment,
+                   uint32_t firstPass,
+                   uint32_t lastPass);
+      void Clear();
+
+      /**
+       * \brief Computes the offsets of all resources added so far
+       * \return size of the memory block, a multiple of the largest alignment
+       */
+      uint64_t Plan();
+
+      uint64_t GetOffset(uint32_t index) const;
+      const AliasedResource& GetResource(uint32_t index) const;
+      size_t GetResourceCount() const;
+
+      /**
+       * \brief Size of the block after Plan
+       */
+      uint64_t GetSize() const;
+
+      /**
+       * \brief Memory the resources would take without aliasing, including alignment padding
+       */
+      uint64_t GetUnaliasedSize() const;
+
+      /**
+       * \brief Resources which share bytes with the resource, the first use of one of them has to wait
+       * until the others are done with the memory (and discards their contents)
+       */
+      std::vector<uint32_t> GetAliases(uint32_t index) const;
+    };
+  }
+}
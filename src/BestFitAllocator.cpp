@@ -0,0 +1,167 @@
+#include "BestFitAllocator.h"
+
+#include <cassert>
+
+lpe::rendering::BestFitAllocator::BestFitAllocator()
+{
+  Create(0);
+}
+
+void lpe::rendering::BestFitAllocator::Create(uint64_t size)
+{
+  this->size = size;
+  this->usage = 0;
+
+  freeBySize.clear();
+  freeByOffset.clear();
+  allocations.clear();
+
+  if (size > 0)
+  {
+    InsertFree(0, size);
+  }
+}
+
+void lpe::rendering::BestFitAllocator::InsertFree(uint64_t offset,
+                                                  uint64_t size)
+{
+  freeByOffset.emplace(offset, size);
+  freeBySize.emplace(size, offset);
+}
+
+void lpe::rendering::BestFitAllocator::RemoveFree(std::map<uint64_t, uint64_t>::iterator iter)
+{
+  auto range = freeBySize.equal_range(iter->second);
+  for (auto bySize = range.first; bySize != range.second; ++bySize)
+  {
+    if (bySize->second == iter->first)
+    {
+      freeBySize.erase(bySize);
+      break;
+    }
+  }
+
+  freeByOffset.erase(iter);
+}
+
+std::multimap<uint64_t, uint64_t>::const_iterator lpe::rendering::BestFitAllocator::FindFree(uint64_t size,
+                                                                                             uint64_t alignment) const
+{
+  // the smallest ranges might not fit because of the alignment padding
+  for (auto iter = freeBySize.lower_bound(size); iter != std::end(freeBySize); ++iter)
+  {
+    uint64_t padding = (iter->second + alignment - 1) / alignment * alignment - iter->second;
+    if (iter->first >= size + padding)
+    {
+      return iter;
+    }
+  }
+
+  return std::end(freeBySize);
+}
+
+uint64_t lpe::rendering::BestFitAllocator::Allocate(uint64_t size,
+                                                    uint64_t alignment)
+{
+  assert(size > 0);
+  assert(alignment > 0 && (alignment & (alignment - 1)) == 0);
+
+  auto found = FindFree(size, alignment);
+  if (found == std::end(freeBySize))
+  {
+    return InvalidOffset;
+  }
+
+  uint64_t begin = found->second;
+  uint64_t end = begin + found->first;
+  uint64_t offset = (begin + alignment - 1) / alignment * alignment;
+
+  RemoveFree(freeByOffset.find(begin));
+
+  if (offset > begin)
+  {
+    InsertFree(begin, offset - begin);
+  }
+
+  if (offset + size < end)
+  {
+    InsertFree(offset + size, end - offset - size);
+  }
+
+  usage += size;
+  allocations.emplace(offset, size);
+
+  return offset;
+}
+
+void lpe::rendering::BestFitAllocator::Free(uint64_t offset)
+{
+  auto iter = allocations.find(offset);
+  assert(iter != std::end(allocations));
+
+  uint64_t begin = offset;
+  uint64_t end = offset + iter->second;
+
+  usage -= iter->second;
+  allocations.erase(iter);
+
+  auto next = freeByOffset.lower_bound(begin);
+  if (next != std::end(freeByOffset) && next->first == end)
+  {
+    end += next->second;
+    next = std::next(next);
+    RemoveFree(std::prev(next));
+  }
+
+  if (next != std::begin(freeByOffset))
+  {
+    auto prev = std::prev(next);
+    if (prev->first + prev->second == begin)
+    {
+      begin = prev->first;
+      RemoveFree(prev);
+    }
+  }
+
+  InsertFree(begin, end - begin);
+}
+
+bool lpe::rendering::BestFitAllocator::CanAllocate(uint64_t size,
+                                                   uint64_t alignment) const
+{
+  return size > 0 && FindFree(size, alignment) != std::end(freeBySize);
+}
+
+uint64_t lpe::rendering::BestFitAllocator::GetRequiredSize(uint64_t size,
+                                                           uint64_t /*alignment*/) const
+{
+  // the only free range of an empty allocator starts at 0, which is aligned to anything
+  return size;
+}
+
+uint64_t lpe::rendering::BestFitAllocator::GetSize() const
+{
+  return size;
+}
+
+uint64_t lpe::rendering::BestFitAllocator::GetUsage() const
+{
+  return usage;
+}
+
+size_t lpe::rendering::BestFitAllocator::GetAllocationCount() const
+{
+  return allocations.size();
+}
+
+uint64_t lpe::rendering::BestFitAllocator::GetLargestFreeBlock() const
+{
+  return freeBySize.empty() ?
+         0 :
+         freeBySize.rbegin()->first;
+}
+
+std::unique_ptr<lpe::rendering::ISubAllocator> lpe::rendering::BestFitAllocator::Clone() const
+{
+  return std::make_unique<BestFitAllocator>(*this);
+}
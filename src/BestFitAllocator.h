@@ -0,0 +1,56 @@
+#pragma once
+
+#include "SubAllocator.h"
+
+#include <map>
+#include <unordered_map>
+
+namespace lpe
+{
+  namespace rendering
+  {
+    /**
+     * \brief Picks the smallest free range which fits (sorted by size), free neighbours are merged on free
+     */
+    class BestFitAllocator : public ISubAllocator
+    {
+    private:
+      uint64_t size;
+      uint64_t usage;
+
+      std::multimap<uint64_t, uint64_t> freeBySize;
+      std::map<uint64_t, uint64_t> freeByOffset;
+      std::unordered_map<uint64_t, uint64_t> allocations;
+
+      void InsertFree(uint64_t offset,
+                      uint64_t size);
+      void RemoveFree(std::map<uint64_t, uint64_t>::iterator iter);
+      std::multimap<uint64_t, uint64_t>::const_iterator FindFree(uint64_t size,
+                                                                 uint64_t alignment) const;
+    public:
+      BestFitAllocator();
+      BestFitAllocator(const BestFitAllocator& other) = default;
+      BestFitAllocator(BestFitAllocator&& other) noexcept = default;
+      BestFitAllocator& operator=(const BestFitAllocator& other) = default;
+      BestFitAllocator& operator=(BestFitAllocator&& other) noexcept = default;
+      ~BestFitAllocator() override = default;
+
+      void Create(uint64_t size) override;
+
+      uint64_t Allocate(uint64_t size,
+                        uint64_t alignment = 1) override;
+      void Free(uint64_t offset) override;
+      bool CanAllocate(uint64_t size,
+                       uint64_t alignment = 1) const override;
+      uint64_t GetRequiredSize(uint64_t size,
+                               uint64_t alignment = 1) const override;
+
+      uint64_t GetSize() const override;
+      uint64_t GetUsage() const override;
+      size_t GetAllocationCount() const override;
+      uint64_t GetLargestFreeBlock() const override;
+
+      std::unique_ptr<ISubAllocator> Clone() const override;
+    };
+  }
+}
@@ -0,0 +1,504 @@
+#include "BlockCompression.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace
+{
+  struct BitWriter
+  {
+    uint8_t* Data;
+    uint32_t Position;
+
+    void Write(uint32_t value,
+               uint32_t count)
+    {
+      for (uint32_t bit = 0; bit < count; ++bit, ++Position)
+      {
+        if ((value >> bit) & 1)
+        {
+          Data[Position >> 3] |= static_cast<uint8_t>(1 << (Position & 7));
+        }
+      }
+    }
+  };
+
+  /**
+   * \brief Fits a line through the block colors (principal axis by power iteration)
+   * and returns its extremes, the first endpoint is the lower one.
+   */
+  template<uint32_t TChannels>
+  void FitEndpoints(const uint8_t* rgba,
+                    float* e0,
+                    float* e1)
+  {
+    float mean[TChannels] = {};
+    float low[TChannels];
+    float high[TChannels];
+
+    std::fill(low, low + TChannels, 255.0f);
+    std::fill(high, high + TChannels, 0.0f);
+
+    for (uint32_t i = 0; i < 16; ++i)
+    {
+      for (uint32_t c = 0; c < TChannels; ++c)
+      {
+        float value = rgba[i * 4 + c];
+
+        mean[c] += value;
+        low[c] = std::min(low[c], value);
+        high[c] = std::max(high[c], value);
+      }
+    }
+
+    float covariance[TChannels][TChannels] = {};
+
+    for (uint32_t c = 0; c < TChannels; ++c)
+    {
+      mean[c] /= 16.0f;
+    }
+
+    for (uint32_t i = 0; i < 16; ++i)
+    {
+      float delta[TChannels];
+      for (uint32_t c = 0; c < TChannels; ++c)
+      {
+        delta[c] = rgba[i * 4 + c] - mean[c];
+      }
+
+      for (uint32_t a = 0; a < TChannels; ++a)
+      {
+        for (uint32_t b = 0; b < TChannels; ++b)
+        {
+          covariance[a][b] += delta[a] * delta[b];
+        }
+      }
+    }
+
+    // start at the bounding box diagonal, a few iterations are plenty for 16 points
+    float axis[TChannels];
+    for (uint32_t c = 0; c < TChannels; ++c)
+    {
+      axis[c] = high[c] - low[c];
+    }
+
+    for (uint32_t iteration = 0; iteration < 8; ++iteration)
+    {
+      float next[TChannels] = {};
+      float largest = 0.0f;
+
+      for (uint32_t a = 0; a < TChannels; ++a)
+      {
+        for (uint32_t b = 0; b < TChannels; ++b)
+        {
+          next[a] += covariance[a][b] * axis[b];
+        }
+
+        largest = std::max(largest, std::abs(next[a]));
+      }
+
+      if (largest == 0.0f)
+      {
+        break;
+      }
+
+      for (uint32_t c = 0; c < TChannels; ++c)
+      {
+        axis[c] = next[c] / largest;
+      }
+    }
+
+    float length = 0.0f;
+    for (uint32_t c = 0; c < TChannels; ++c)
+    {
+      length += axis[c] * axis[c];
+    }
+
+    if (length == 0.0f)
+    {
+      std::copy(mean, mean + TChannels, e0);
+      std::copy(mean, mean + TChannels, e1);
+
+      return;
+    }
+
+    length = std::sqrt(length);
+    for (uint32_t c = 0; c < TChannels; ++c)
+    {
+      axis[c] /= length;
+    }
+
+    float minT = 0.0f;
+    float maxT = 0.0f;
+
+    for (uint32_t i = 0; i < 16; ++i)
+    {
+      float t = 0.0f;
+      for (uint32_t c = 0; c < TChannels; ++c)
+      {
+        t += (rgba[i * 4 + c] - mean[c]) * axis[c];
+      }
+
+      minT = std::min(minT, t);
+      maxT = std::max(maxT, t);
+    }
+
+    for (uint32_t c = 0; c < TChannels; ++c)
+    {
+      e0[c] = std::min(std::max(mean[c] + minT * axis[c], 0.0f), 255.0f);
+      e1[c] = std::min(std::max(mean[c] + maxT * axis[c], 0.0f), 255.0f);
+    }
+  }
+
+  uint16_t To565(const float* color)
+  {
+    auto r = static_cast<uint16_t>(color[0] * 31.0f / 255.0f + 0.5f);
+    auto g = static_cast<uint16_t>(color[1] * 63.0f / 255.0f + 0.5f);
+    auto b = static_cast<uint16_t>(color[2] * 31.0f / 255.0f + 0.5f);
+
+    return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+  }
+
+  void From565(uint16_t value,
+               int32_t* color)
+  {
+    int32_t r = (value >> 11) & 31;
+    int32_t g = (value >> 5) & 63;
+    int32_t b = value & 31;
+
+    color[0] = (r << 3) | (r >> 2);
+    color[1] = (g << 2) | (g >> 4);
+    color[2] = (b << 3) | (b >> 2);
+  }
+
+  void EncodeColorBlock(const uint8_t* rgba,
+                        uint8_t* block)
+  {
+    float e0[3];
+    float e1[3];
+    FitEndpoints<3>(rgba, e0, e1);
+
+    // c0 > c1 selects the 4 color mode
+    uint16_t c0 = To565(e1);
+    uint16_t c1 = To565(e0);
+    if (c0 < c1)
+    {
+      std::swap(c0, c1);
+    }
+
+    uint32_t indices = 0;
+
+    if (c0 != c1)
+    {
+      int32_t palette[4][3];
+      From565(c0, palette[0]);
+      From565(c1, palette[1]);
+
+      for (uint32_t c = 0; c < 3; ++c)
+      {
+        palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+        palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+      }
+
+      for (uint32_t i = 0; i < 16; ++i)
+      {
+        uint32_t best = 0;
+        int32_t bestError = std::numeric_limits<int32_t>::max();
+
+        for (uint32_t p = 0; p < 4; ++p)
+        {
+          int32_t error = 0;
+          for (uint32_t c = 0; c < 3; ++c)
+          {
+            int32_t delta = rgba[i * 4 + c] - palette[p][c];
+            error += delta * delta;
+          }
+
+          if (error < bestError)
+          {
+            best = p;
+            bestError = error;
+          }
+        }
+
+        indices |= best << (2 * i);
+      }
+    }
+
+    block[0] = static_cast<uint8_t>(c0);
+    block[1] = static_cast<uint8_t>(c0 >> 8);
+    block[2] = static_cast<uint8_t>(c1);
+    block[3] = static_cast<uint8_t>(c1 >> 8);
+
+    for (uint32_t i = 0; i < 4; ++i)
+    {
+      block[4 + i] = static_cast<uint8_t>(indices >> (8 * i));
+    }
+  }
+
+  void EncodeAlphaBlock(const uint8_t* rgba,
+                        uint8_t* block)
+  {
+    uint8_t a0 = 0;
+    uint8_t a1 = 255;
+
+    for (uint32_t i = 0; i < 16; ++i)
+    {
+      a0 = std::max(a0, rgba[i * 4 + 3]);
+      a1 = std::min(a1, rgba[i * 4 + 3]);
+    }
+
+    // a0 > a1 selects 8 interpolated values
+    uint64_t indices = 0;
+
+    if (a0 != a1)
+    {
+      int32_t palette[8] = { a0, a1 };
+      for (int32_t p = 1; p < 7; ++p)
+      {
+        palette[p + 1] = ((7 - p) * a0 + p * a1) / 7;
+      }
+
+      for (uint32_t i = 0; i < 16; ++i)
+      {
+        uint64_t best = 0;
+        int32_t bestError = 256;
+
+        for (uint32_t p = 0; p < 8; ++p)
+        {
+          int32_t error = std::abs(rgba[i * 4 + 3] - palette[p]);
+          if (error < bestError)
+          {
+            best = p;
+            bestError = error;
+          }
+        }
+
+        indices |= best << (3 * i);
+      }
+    }
+
+    block[0] = a0;
+    block[1] = a1;
+
+    for (uint32_t i = 0; i < 6; ++i)
+    {
+      block[2 + i] = static_cast<uint8_t>(indices >> (8 * i));
+    }
+  }
+
+  /**
+   * \brief 7 bit endpoint plus shared p-bit, picks the p-bit with the lower error
+   */
+  void QuantizeEndpoint(const float* endpoint,
+                        uint32_t* quantized,
+                        uint32_t& pBit)
+  {
+    float bestError = std::numeric_limits<float>::max();
+
+    for (uint32_t p = 0; p < 2; ++p)
+    {
+      uint32_t candidate[4];
+      float error = 0.0f;
+
+      for (uint32_t c = 0; c < 4; ++c)
+      {
+        float value = std::round((endpoint[c] - p) / 2.0f);
+        candidate[c] = static_cast<uint32_t>(std::min(std::max(value, 0.0f), 127.0f));
+
+        float delta = endpoint[c] - static_cast<float>((candidate[c] << 1) | p);
+        error += delta * delta;
+      }
+
+      if (error < bestError)
+      {
+        bestError = error;
+        pBit = p;
+        std::copy(candidate, candidate + 4, quantized);
+      }
+    }
+  }
+}
+
+uint32_t lpe::rendering::GetBlockSize(BlockFormat format)
+{
+  switch (format)
+  {
+    case BlockFormat::RGBA8:
+      return 4;
+    case BlockFormat::BC1:
+      return 8;
+    case BlockFormat::BC3:
+    case BlockFormat::BC7:
+      return 16;
+  }
+
+  return 0;
+}
+
+uint64_t lpe::rendering::GetCompressedSize(BlockFormat format,
+                                           uint32_t width,
+                                           uint32_t height)
+{
+  if (format == BlockFormat::RGBA8)
+  {
+    return static_cast<uint64_t>(width) * height * 4;
+  }
+
+  uint64_t blocksX = (width + 3) / 4;
+  uint64_t blocksY = (height + 3) / 4;
+
+  return blocksX * blocksY * GetBlockSize(format);
+}
+
+void lpe::rendering::EncodeBC1Block(const uint8_t* rgba,
+                                    uint8_t* block)
+{
+  EncodeColorBlock(rgba, block);
+}
+
+void lpe::rendering::EncodeBC3Block(const uint8_t* rgba,
+                                    uint8_t* block)
+{
+  EncodeAlphaBlock(rgba, block);
+  EncodeColorBlock(rgba, block + 8);
+}
+
+void lpe::rendering::EncodeBC7Block(const uint8_t* rgba,
+                                    uint8_t* block)
+{
+  static const uint32_t weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+  float e0[4];
+  float e1[4];
+  FitEndpoints<4>(rgba, e0, e1);
+
+  uint32_t endpoints[2][4];
+  uint32_t pBits[2];
+  QuantizeEndpoint(e0, endpoints[0], pBits[0]);
+  QuantizeEndpoint(e1, endpoints[1], pBits[1]);
+
+  int32_t palette[16][4];
+  for (uint32_t c = 0; c < 4; ++c)
+  {
+    uint32_t low = (endpoints[0][c] << 1) | pBits[0];
+    uint32_t high = (endpoints[1][c] << 1) | pBits[1];
+
+    for (uint32_t i = 0; i < 16; ++i)
+    {
+      palette[i][c] = static_cast<int32_t>(((64 - weights[i]) * low + weights[i] * high + 32) >> 6);
+    }
+  }
+
+  uint32_t indices[16];
+  for (uint32_t i = 0; i < 16; ++i)
+  {
+    uint32_t best = 0;
+    int32_t bestError = std::numeric_limits<int32_t>::max();
+
+    for (uint32_t p = 0; p < 16; ++p)
+    {
+      int32_t error = 0;
+      for (uint32_t c = 0; c < 4; ++c)
+      {
+        int32_t delta = rgba[i * 4 + c] - palette[p][c];
+        error += delta * delta;
+      }
+
+      if (error < bestError)
+      {
+        best = p;
+        bestError = error;
+      }
+    }
+
+    indices[i] = best;
+  }
+
+  // the msb of the anchor index is implicit 0
+  if (indices[0] & 8)
+  {
+    std::swap(endpoints[0], endpoints[1]);
+    std::swap(pBits[0], pBits[1]);
+
+    for (auto&& index : indices)
+    {
+      index = 15 - index;
+    }
+  }
+
+  memset(block, 0, 16);
+  BitWriter writer = { block, 0 };
+
+  writer.Write(1 << 6, 7); // mode 6
+
+  for (uint32_t c = 0; c < 4; ++c)
+  {
+    writer.Write(endpoints[0][c], 7);
+    writer.Write(endpoints[1][c], 7);
+  }
+
+  writer.Write(pBits[0], 1);
+  writer.Write(pBits[1], 1);
+
+  writer.Write(indices[0], 3);
+  for (uint32_t i = 1; i < 16; ++i)
+  {
+    writer.Write(indices[i], 4);
+  }
+
+  assert(writer.Position == 128);
+}
+
+std::vector<uint8_t> lpe::rendering::CompressImage(const uint8_t* rgba,
+                                                   uint32_t width,
+                                                   uint32_t height,
+                                                   BlockFormat format)
+{
+  std::vector<uint8_t> out(GetCompressedSize(format, width, height));
+
+  if (format == BlockFormat::RGBA8)
+  {
+    memcpy(out.data(), rgba, out.size());
+
+    return out;
+  }
+
+  uint32_t blockSize = GetBlockSize(format);
+  uint8_t* block = out.data();
+  uint8_t pixels[64];
+
+  for (uint32_t y = 0; y < height; y += 4)
+  {
+    for (uint32_t x = 0; x < width; x += 4)
+    {
+      for (uint32_t i = 0; i < 16; ++i)
+      {
+        uint32_t px = std::min(x + i % 4, width - 1);
+        uint32_t py = std::min(y + i / 4, height - 1);
+
+        memcpy(pixels + i * 4, rgba + (static_cast<uint64_t>(py) * width + px) * 4, 4);
+      }
+
+      switch (format)
+      {
+        case BlockFormat::BC1:
+          EncodeBC1Block(pixels, block);
+          break;
+        case BlockFormat::BC3:
+          EncodeBC3Block(pixels, block);
+          break;
+        default:
+          EncodeBC7Block(pixels, block);
+          break;
+      }
+
+      block += blockSize;
+    }
+  }
+
+  return out;
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace lpe
+{
+  namespace rendering
+  {
+    enum class BlockFormat : uint32_t
+    {
+      RGBA8 = 0,
+      BC1 = 1, // RGB, 4 bit per pixel
+      BC3 = 2, // RGBA, 8 bit per pixel
+      BC7 = 3  // RGBA, 8 bit per pixel, mode 6 only
+    };
+
+    /**
+     * \brief Bytes per 4x4 block (per pixel for RGBA8)
+     */
+    uint32_t GetBlockSize(BlockFormat format);
+
+    /**
+     * \brief Byte size of a width x height image, partial blocks count as full blocks
+     */
+    uint64_t GetCompressedSize(BlockFormat format,
+                               uint32_t width,
+                               uint32_t height);
+
+    /**
+     * \brief Encoders for a single 4x4 block of RGBA8 pixels (row major, 64 bytes).
+     * Endpoints are fitted along the principal axis of the block colors.
+     */
+    void EncodeBC1Block(const uint8_t* rgba,
+                        uint8_t* block);
+    void EncodeBC3Block(const uint8_t* rgba,
+                        uint8_t* block);
+    void EncodeBC7Block(const uint8_t* rgba,
+                        uint8_t* block);
+
+    /**
+     * \brief Compresses a whole RGBA8 image, edge blocks repeat the last row/column
+     */
+    std::vector<uint8_t> CompressImage(const uint8_t* rgba,
+                                       uint32_t width,
+                                       uint32_t height,
+                                       BlockFormat format);
+  }
+}
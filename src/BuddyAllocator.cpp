@@ -0,0 +1,196 @@
+#include "BuddyAllocator.h"
+
+#include <algorithm>
+#include <cassert>
+
+lpe::rendering::BuddyAllocator::BuddyAllocator(uint64_t minBlockSize)
+  : minBlockSize(minBlockSize)
+{
+  assert(minBlockSize > 0 && (minBlockSize & (minBlockSize - 1)) == 0);
+
+  Create(0);
+}
+
+void lpe::rendering::BuddyAllocator::Create(uint64_t size)
+{
+  this->size = size;
+  this->usage = 0;
+  this->maxOrder = 0;
+
+  while (GetBlockSize(maxOrder) <= size / 2)
+  {
+    ++maxOrder;
+  }
+
+  freeBlocks.assign(maxOrder + 1, {});
+  allocations.clear();
+
+  // largest blocks first, so every top block is aligned to its own size
+  uint64_t offset = 0;
+  for (int64_t order = maxOrder; order >= 0; --order)
+  {
+    auto blockSize = GetBlockSize(static_cast<uint32_t>(order));
+    if (offset + blockSize <= size)
+    {
+      freeBlocks[order].insert(offset);
+      offset += blockSize;
+    }
+  }
+}
+
+uint32_t lpe::rendering::BuddyAllocator::GetOrder(uint64_t size,
+                                                  uint64_t alignment) const
+{
+  uint64_t required = std::max(size, alignment);
+  uint32_t order = 0;
+
+  while (GetBlockSize(order) < required)
+  {
+    if (order == maxOrder)
+    {
+      return order + 1;
+    }
+
+    ++order;
+  }
+
+  return order;
+}
+
+uint64_t lpe::rendering::BuddyAllocator::GetBlockSize(uint32_t order) const
+{
+  return minBlockSize << order;
+}
+
+uint64_t lpe::rendering::BuddyAllocator::Allocate(uint64_t size,
+                                                  uint64_t alignment)
+{
+  assert(size > 0);
+  assert(alignment > 0 && (alignment & (alignment - 1)) == 0);
+
+  auto order = GetOrder(size, alignment);
+
+  auto found = order;
+  while (found <= maxOrder && freeBlocks[found].empty())
+  {
+    ++found;
+  }
+
+  if (found > maxOrder)
+  {
+    return InvalidOffset;
+  }
+
+  auto iter = std::begin(freeBlocks[found]);
+  uint64_t offset = *iter;
+  freeBlocks[found].erase(iter);
+
+  // keep the lower half, the upper half becomes free
+  while (found > order)
+  {
+    --found;
+    freeBlocks[found].insert(offset + GetBlockSize(found));
+  }
+
+  usage += GetBlockSize(order);
+  allocations.emplace(offset, order);
+
+  return offset;
+}
+
+void lpe::rendering::BuddyAllocator::Free(uint64_t offset)
+{
+  auto iter = allocations.find(offset);
+  assert(iter != std::end(allocations));
+
+  auto order = iter->second;
+  usage -= GetBlockSize(order);
+  allocations.erase(iter);
+
+  while (order < maxOrder)
+  {
+    auto buddy = freeBlocks[order].find(offset ^ GetBlockSize(order));
+    if (buddy == std::end(freeBlocks[order]))
+    {
+      break;
+    }
+
+    offset = std::min(offset, *buddy);
+    freeBlocks[order].erase(buddy);
+    ++order;
+  }
+
+  freeBlocks[order].insert(offset);
+}
+
+bool lpe::rendering::BuddyAllocator::CanAllocate(uint64_t size,
+                                                 uint64_t alignment) const
+{
+  if (size == 0)
+  {
+    return false;
+  }
+
+  for (auto order = GetOrder(size, alignment); order <= maxOrder; ++order)
+  {
+    if (!freeBlocks[order].empty())
+    {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+uint64_t lpe::rendering::BuddyAllocator::GetRequiredSize(uint64_t size,
+                                                         uint64_t alignment) const
+{
+  // one top block of the rounded size, placed at offset 0
+  uint64_t required = std::max(size, alignment);
+  uint64_t blockSize = minBlockSize;
+
+  while (blockSize < required)
+  {
+    if (blockSize > UINT64_MAX / 2)
+    {
+      return UINT64_MAX;
+    }
+
+    blockSize <<= 1;
+  }
+
+  return blockSize;
+}
+
+uint64_t lpe::rendering::BuddyAllocator::GetSize() const
+{
+  return size;
+}
+
+uint64_t lpe::rendering::BuddyAllocator::GetUsage() const
+{
+  return usage;
+}
+
+size_t lpe::rendering::BuddyAllocator::GetAllocationCount() const
+{
+  return allocations.size();
+}
+
+uint64_t lpe::rendering::BuddyAllocator::GetLargestFreeBlock() const
+{
+  for (int64_t order = maxOrder; order >= 0; --order)
+  {
+    if (!freeBlocks[order].empty())
+    {
+      return GetBlockSize(static_cast<uint32_t>(order));
+    }
+  }
+
+  return 0;
+}
+
+std::unique_ptr<lpe::rendering::ISubAllocator> lpe::rendering::BuddyAllocator::Clone() const
+{
+  return std::make_unique<BuddyAllocator>(*this);
+}
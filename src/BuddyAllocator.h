@@ -0,0 +1,62 @@
+#pragma once
+
+#include "SubAllocator.h"
+
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace lpe
+{
+  namespace rendering
+  {
+    /**
+     * \brief Splits the memory into power of two blocks, freed blocks merge with their buddy (offset ^ size).
+     * Allocations are rounded up to a power of two and aligned to their own size. Memory sizes which aren't a
+     * power of two start as several top blocks (one per set bit), only the rest below minBlockSize stays unused.
+     */
+    class BuddyAllocator : public ISubAllocator
+    {
+    private:
+      uint64_t size;
+      uint64_t usage;
+      uint64_t minBlockSize;
+      uint32_t maxOrder;
+
+      // free block offsets per order, order 0 = minBlockSize
+      std::vector<std::unordered_set<uint64_t>> freeBlocks;
+      std::unordered_map<uint64_t, uint32_t> allocations;
+
+      uint32_t GetOrder(uint64_t size,
+                        uint64_t alignment) const;
+      uint64_t GetBlockSize(uint32_t order) const;
+    public:
+      /**
+       * \param minBlockSize power of two, smaller allocations get rounded up to it
+       */
+      explicit BuddyAllocator(uint64_t minBlockSize = 256);
+      BuddyAllocator(const BuddyAllocator& other) = default;
+      BuddyAllocator(BuddyAllocator&& other) noexcept = default;
+      BuddyAllocator& operator=(const BuddyAllocator& other) = default;
+      BuddyAllocator& operator=(BuddyAllocator&& other) noexcept = default;
+      ~BuddyAllocator() override = default;
+
+      void Create(uint64_t size) override;
+
+      uint64_t Allocate(uint64_t size,
+                        uint64_t alignment = 1) override;
+      void Free(uint64_t offset) override;
+      bool CanAllocate(uint64_t size,
+                       uint64_t alignment = 1) const override;
+      uint64_t GetRequiredSize(uint64_t size,
+                               uint64_t alignment = 1) const override;
+
+      uint64_t GetSize() const override;
+      uint64_t GetUsage() const override;
+      size_t GetAllocationCount() const override;
+      uint64_t GetLargestFreeBlock() const override;
+
+      std::unique_ptr<ISubAllocator> Clone() const override;
+    };
+  }
+}
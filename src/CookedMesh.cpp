@@ -0,0 +1,212 @@
+#include "CookedMesh.h"
+#include "Resource.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <fstream>
+
+namespace
+{
+  constexpr uint64_t VertexSize = sizeof(float) * 9;
+
+  template<typename TType>
+  void Write(std::vector<uint8_t>& out,
+             const TType& value)
+  {
+    auto bytes = reinterpret_cast<const uint8_t*>(&value);
+    out.insert(std::end(out), bytes, bytes + sizeof(TType));
+  }
+
+  void Write(std::vector<uint8_t>& out,
+             glm::vec3 value)
+  {
+    Write(out, value.x);
+    Write(out, value.y);
+    Write(out, value.z);
+  }
+
+  glm::vec3 ReadVec3(const uint8_t* data)
+  {
+    float values[3];
+    memcpy(values, data, sizeof(values));
+
+    return { values[0], values[1], values[2] };
+  }
+}
+
+uint64_t lpe::rendering::CookedMeshLod::GetSize() const
+{
+  return VertexCount * VertexSize + IndexCount * sizeof(uint32_t);
+}
+
+std::vector<uint8_t> lpe::rendering::CookMesh(const Mesh& mesh,
+                                              uint32_t maxLods)
+{
+  assert(maxLods > 0);
+
+  std::vector<Mesh> lods;
+  lods.push_back(mesh);
+
+  // halve the grid until a LOD does not save enough triangles anymore
+  uint32_t resolution = 32;
+  while (lods.size() < maxLods && resolution >= 2)
+  {
+    Mesh coarse = mesh.Simplify(resolution);
+    size_t previous = lods.back().GetIndices().size();
+
+    if (!coarse.GetIndices().empty() &&
+        coarse.GetIndices().size() * 10 < previous * 9)
+    {
+      coarse.Optimize();
+      lods.push_back(std::move(coarse));
+    }
+
+    resolution /= 2;
+  }
+
+  std::reverse(std::begin(lods), std::end(lods));
+
+  CookedMeshHeader header = {};
+  header.Magic = CookedMeshMagic;
+  header.Version = CookedMeshVersion;
+  header.LodCount = static_cast<uint32_t>(lods.size());
+
+  const Bounds& bounds = mesh.GetBounds();
+  header.BoundsMin[0] = bounds.Min.x;
+  header.BoundsMin[1] = bounds.Min.y;
+  header.BoundsMin[2] = bounds.Min.z;
+  header.BoundsMax[0] = bounds.Max.x;
+  header.BoundsMax[1] = bounds.Max.y;
+  header.BoundsMax[2] = bounds.Max.z;
+
+  std::vector<CookedMeshLod> table(lods.size());
+  uint64_t offset = sizeof(CookedMeshHeader) + sizeof(CookedMeshLod) * table.size();
+
+  for (size_t i = 0; i < lods.size(); ++i)
+  {
+    table[i].Offset = offset;
+    table[i].VertexCount = static_cast<uint32_t>(lods[i].GetVertices().size());
+    table[i].IndexCount = static_cast<uint32_t>(lods[i].GetIndices().size());
+
+    offset += table[i].GetSize();
+  }
+
+  std::vector<uint8_t> out;
+  out.reserve(offset);
+
+  Write(out, header);
+  for (auto&& lod : table)
+  {
+    Write(out, lod);
+  }
+
+  for (auto&& lod : lods)
+  {
+    for (auto&& vertex : lod.GetVertices())
+    {
+      Write(out, vertex.Position);
+      Write(out, vertex.Normal);
+      Write(out, vertex.Color);
+    }
+
+    for (auto&& index : lod.GetIndices())
+    {
+      Write(out, index);
+    }
+  }
+
+  assert(out.size() == offset);
+
+  return out;
+}
+
+bool lpe::rendering::CookMesh(const char* source,
+                              const char* destination,
+                              uint32_t maxLods)
+{
+  lpe::utils::Resource resource;
+  resource.Load(source);
+
+  const uint8_t* data;
+  uint64_t size = resource.GetData(&data);
+
+  Mesh mesh;
+  if (size == 0 || !mesh.Load(data, size))
+  {
+    return false;
+  }
+
+  mesh.Optimize();
+
+  auto cooked = CookMesh(mesh, maxLods);
+
+  std::ofstream ofs(destination,
+                    std::ios::binary);
+  ofs.write(reinterpret_cast<const char*>(cooked.data()), cooked.size());
+
+  return ofs.good();
+}
+
+bool lpe::rendering::ReadCookedMeshHeader(const uint8_t* data,
+                                          uint64_t size,
+                                          CookedMeshHeader& header,
+                                          std::vector<CookedMeshLod>& lods)
+{
+  if (size < sizeof(CookedMeshHeader))
+  {
+    return false;
+  }
+
+  memcpy(&header, data, sizeof(CookedMeshHeader));
+
+  if (header.Magic != CookedMeshMagic ||
+      header.Version != CookedMeshVersion ||
+      size < sizeof(CookedMeshHeader) + header.LodCount * sizeof(CookedMeshLod))
+  {
+    return false;
+  }
+
+  lods.resize(header.LodCount);
+  memcpy(lods.data(), data + sizeof(CookedMeshHeader), header.LodCount * sizeof(CookedMeshLod));
+
+  return true;
+}
+
+bool lpe::rendering::ReadCookedMeshLod(const uint8_t* data,
+                                       uint64_t size,
+                                       const CookedMeshLod& lod,
+                                       Mesh& mesh)
+{
+  if (size < lod.GetSize())
+  {
+    return false;
+  }
+
+  std::vector<Vertex> vertices(lod.VertexCount);
+  for (auto&& vertex : vertices)
+  {
+    vertex.Position = ReadVec3(data);
+    vertex.Normal = ReadVec3(data + sizeof(float) * 3);
+    vertex.Color = ReadVec3(data + sizeof(float) * 6);
+
+    data += VertexSize;
+  }
+
+  std::vector<uint32_t> indices(lod.IndexCount);
+  memcpy(indices.data(), data, indices.size() * sizeof(uint32_t));
+
+  for (auto&& index : indices)
+  {
+    if (index >= lod.VertexCount)
+    {
+      return false;
+    }
+  }
+
+  mesh.SetVertices(std::move(vertices));
+  mesh.SetIndices(std::move(indices));
+  mesh.ComputeBounds();
+
+  return true;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "Mesh.h"
+
+namespace lpe
+{
+  namespace rendering
+  {
+    constexpr uint32_t CookedMeshMagic = 0x4D45504C; // "LPEM"
+    constexpr uint32_t CookedMeshVersion = 1;
+
+    /**
+     * \brief Layout of a cooked mesh file:
+     * header | LodCount x CookedMeshLod | LOD data (coarsest first)
+     * Each LOD is VertexCount x (position, normal, color as 9 floats) followed by IndexCount x uint32.
+     * Coarse LODs come first, so a sequential read gives something to draw as early as possible.
+     */
+    struct CookedMeshHeader
+    {
+      uint32_t Magic;
+      uint32_t Version;
+      uint32_t LodCount;
+      uint32_t Reserved;
+      float BoundsMin[3];
+      float BoundsMax[3];
+    };
+
+    struct CookedMeshLod
+    {
+      uint64_t Offset;
+      uint32_t VertexCount;
+      uint32_t IndexCount;
+
+      uint64_t GetSize() const;
+    };
+
+    /**
+     * \brief Builds up to maxLods LODs by repeated clustering and serializes them coarsest first
+     */
+    std::vector<uint8_t> CookMesh(const Mesh& mesh,
+                                  uint32_t maxLods = 4);
+    bool CookMesh(const char* source,
+                  const char* destination,
+                  uint32_t maxLods = 4);
+
+    bool ReadCookedMeshHeader(const uint8_t* data,
+                              uint64_t size,
+                              CookedMeshHeader& header,
+                              std::vector<CookedMeshLod>& lods);
+
+    /**
+     * \param data points to the first byte of the LOD (not the file)
+     */
+    bool ReadCookedMeshLod(const uint8_t* data,
+                           uint64_t size,
+                           const CookedMeshLod& lod,
+                           Mesh& mesh);
+  }
+}
@@ -0,0 +1,175 @@
+#include "CookedTexture.h"
+#include "Resource.h"
+#include "vulkan/VulkanImage.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <fstream>
+
+std::vector<uint8_t> lpe::rendering::CookTexture(const uint8_t* rgba,
+                                                 uint32_t width,
+                                                 uint32_t height,
+                                                 BlockFormat format,
+                                                 uint32_t maxLevels)
+{
+  assert(rgba && width > 0 && height > 0);
+
+  uint32_t levelCount = vulkan::common::GetMipLevelCount({ width, height, 1 });
+  if (maxLevels > 0)
+  {
+    levelCount = std::min(levelCount, maxLevels);
+  }
+
+  std::vector<CookedTextureLevel> table(levelCount);
+  std::vector<std::vector<uint8_t>> levels(levelCount);
+  std::vector<uint8_t> current(rgba, rgba + static_cast<uint64_t>(width) * height * 4);
+  std::vector<uint8_t> next;
+
+  for (uint32_t level = 0; level < levelCount; ++level)
+  {
+    table[level].Width = width;
+    table[level].Height = height;
+
+    levels[level] = CompressImage(current.data(), width, height, format);
+    table[level].Size = levels[level].size();
+
+    if (level + 1 < levelCount)
+    {
+      uint32_t nextWidth = std::max(width / 2, 1u);
+      uint32_t nextHeight = std::max(height / 2, 1u);
+
+      next.resize(static_cast<uint64_t>(nextWidth) * nextHeight * 4);
+      vulkan::common::DownsampleImage(current.data(), width, height, 4, next.data());
+
+      std::swap(current, next);
+      width = nextWidth;
+      height = nextHeight;
+    }
+  }
+
+  auto align = [](uint64_t offset)
+  {
+    return (offset + CookedTextureAlignment - 1) / CookedTextureAlignment * CookedTextureAlignment;
+  };
+
+  // smallest level first, so a partial read already has something to show
+  uint64_t offset = align(sizeof(CookedTextureHeader) + sizeof(CookedTextureLevel) * table.size());
+  for (uint32_t level = levelCount; level-- > 0;)
+  {
+    table[level].Offset = offset;
+    offset = align(offset + table[level].Size);
+  }
+
+  CookedTextureHeader header = {};
+  header.Magic = CookedTextureMagic;
+  header.Version = CookedTextureVersion;
+  header.Format = static_cast<uint32_t>(format);
+  header.Width = table[0].Width;
+  header.Height = table[0].Height;
+  header.LevelCount = levelCount;
+
+  std::vector<uint8_t> out(offset, 0);
+
+  memcpy(out.data(), &header, sizeof(CookedTextureHeader));
+  memcpy(out.data() + sizeof(CookedTextureHeader), table.data(), sizeof(CookedTextureLevel) * table.size());
+
+  for (uint32_t level = 0; level < levelCount; ++level)
+  {
+    memcpy(out.data() + table[level].Offset, levels[level].data(), levels[level].size());
+  }
+
+  return out;
+}
+
+bool lpe::rendering::CookTexture(const char* source,
+                                 const char* destination,
+                                 BlockFormat format,
+                                 uint32_t maxLevels)
+{
+  lpe::utils::Resource resource;
+  resource.Load(source);
+
+  const uint8_t* data;
+  uint64_t size = resource.GetData(&data);
+
+  if (size == 0)
+  {
+    return false;
+  }
+
+  int width, height, channels;
+  auto stbImage = stbi_load_from_memory(data, static_cast<int>(size), &width, &height, &channels, STBI_rgb_alpha);
+
+  if (!stbImage)
+  {
+    return false;
+  }
+
+  auto cooked = CookTexture(stbImage,
+                            static_cast<uint32_t>(width),
+                            static_cast<uint32_t>(height),
+                            format,
+                            maxLevels);
+
+  stbi_image_free(stbImage);
+
+  std::ofstream ofs(destination,
+                    std::ios::binary);
+  ofs.write(reinterpret_cast<const char*>(cooked.data()), cooked.size());
+
+  return ofs.good();
+}
+
+bool lpe::rendering::ReadCookedTextureHeader(const uint8_t* data,
+                                             uint64_t size,
+                                             CookedTextureHeader& header,
+                                             std::vector<CookedTextureLevel>& levels)
+{
+  if (size < sizeof(CookedTextureHeader))
+  {
+    return false;
+  }
+
+  memcpy(&header, data, sizeof(CookedTextureHeader));
+
+  // everything below comes from the file, uploads copy the levels as one range without further checks
+  if (header.Magic != CookedTextureMagic ||
+      header.Version != CookedTextureVersion ||
+      header.Format > static_cast<uint32_t>(BlockFormat::BC7) ||
+      header.Width == 0 ||
+      header.Height == 0 ||
+      header.LevelCount == 0 ||
+      header.LevelCount > vulkan::common::GetMipLevelCount({ header.Width, header.Height, 1 }) ||
+      header.LevelCount > (size - sizeof(CookedTextureHeader)) / sizeof(CookedTextureLevel))
+  {
+    return false;
+  }
+
+  levels.resize(header.LevelCount);
+  memcpy(levels.data(), data + sizeof(CookedTextureHeader), header.LevelCount * sizeof(CookedTextureLevel));
+
+  auto format = static_cast<BlockFormat>(header.Format);
+
+  // smallest level first, every level starts behind the end of the next smaller one
+  uint64_t end = sizeof(CookedTextureHeader) + header.LevelCount * sizeof(CookedTextureLevel);
+  for (uint32_t i = header.LevelCount; i-- > 0;)
+  {
+    const auto& level = levels[i];
+
+    if (level.Width != std::max(header.Width >> i, 1u) ||
+        level.Height != std::max(header.Height >> i, 1u) ||
+        level.Size != GetCompressedSize(format, level.Width, level.Height) ||
+        level.Offset % CookedTextureAlignment != 0 ||
+        level.Offset < end ||
+        level.Offset > size ||
+        level.Size > size - level.Offset)
+    {
+      return false;
+    }
+
+    end = level.Offset + level.Size;
+  }
+
+  return true;
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "BlockCompression.h"
+
+namespace lpe
+{
+  namespace rendering
+  {
+    constexpr uint32_t CookedTextureMagic = 0x5445504C; // "LPET"
+    constexpr uint32_t CookedTextureVersion = 1;
+    constexpr uint64_t CookedTextureAlignment = 16;
+
+    /**
+     * \brief Layout of a cooked texture file (similar to KTX2):
+     * header | LevelCount x CookedTextureLevel | level data (smallest level first)
+     * The level table starts with the full resolution level, every level offset is aligned to 16 bytes
+     * so the data can be copied to the GPU as is.
+     */
+    struct CookedTextureHeader
+    {
+      uint32_t Magic;
+      uint32_t Version;
+      uint32_t Format;
+      uint32_t Width;
+      uint32_t Height;
+      uint32_t LevelCount;
+      uint32_t Reserved[2];
+    };
+
+    struct CookedTextureLevel
+    {
+      uint64_t Offset;
+      uint64_t Size;
+      uint32_t Width;
+      uint32_t Height;
+    };
+
+    /**
+     * \brief Builds the mip chain (maxLevels 0 = full chain) of an RGBA8 image and encodes every level
+     */
+    std::vector<uint8_t> CookTexture(const uint8_t* rgba,
+                                     uint32_t width,
+                                     uint32_t height,
+                                     BlockFormat format = BlockFormat::BC7,
+                                     uint32_t maxLevels = 0);
+    bool CookTexture(const char* source,
+                     const char* destination,
+                     BlockFormat format = BlockFormat::BC7,
+                     uint32_t maxLevels = 0);
+
+    /**
+     * \brief Copies the header and the level table, false if the data is no cooked texture of this version
+     * or the table doesn't match the header (level sizes, order, bounds)
+     */
+    bool ReadCookedTextureHeader(const uint8_t* data,
+                                 uint64_t size,
+                                 CookedTextureHeader& header,
+                                 std::vector<CookedTextureLevel>& levels);
+  }
+}
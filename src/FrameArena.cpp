@@ -0,0 +1,144 @@
+#include "FrameArena.h"
+
+#include <algorithm>
+#include <cassert>
+
+lpe::utils::LinearArena::LinearArena(uint64_t size)
+{
+  this->offset = 0;
+  this->usage = 0;
+  this->peakUsage = 0;
+
+  AddBlock(std::max<uint64_t>(size, 1));
+}
+
+void lpe::utils::LinearArena::AddBlock(uint64_t size)
+{
+  blocks.push_back({ std::unique_ptr<uint8_t[]>(new uint8_t[size]), size });
+  offset = 0;
+}
+
+void* lpe::utils::LinearArena::Allocate(uint64_t size,
+                                        uint64_t alignment)
+{
+  assert(alignment > 0 && (alignment & (alignment - 1)) == 0);
+
+  auto* block = &blocks.back();
+  auto address = reinterpret_cast<uintptr_t>(block->Data.get());
+  uint64_t begin = (address + offset + alignment - 1) / alignment * alignment - address;
+
+  if (begin > block->Size || size > block->Size - begin)
+  {
+    // the next block takes at least the whole request, doubling keeps the number of blocks low
+    AddBlock(std::max(block->Size * 2, size + alignment));
+
+    block = &blocks.back();
+    address = reinterpret_cast<uintptr_t>(block->Data.get());
+    begin = (address + alignment - 1) / alignment * alignment - address;
+  }
+
+  offset = begin + size;
+  usage += size;
+  peakUsage = std::max(peakUsage, usage);
+
+  return block->Data.get() + begin;
+}
+
+void lpe::utils::LinearArena::Reset()
+{
+  if (blocks.size() > 1)
+  {
+    // one block for everything the last frames needed
+    auto capacity = GetCapacity();
+
+    blocks.clear();
+    AddBlock(capacity);
+  }
+
+  offset = 0;
+  usage = 0;
+}
+
+uint64_t lpe::utils::LinearArena::GetCapacity() const
+{
+  uint64_t capacity = 0;
+  for (auto&& block : blocks)
+  {
+    capacity += block.Size;
+  }
+
+  return capacity;
+}
+
+uint64_t lpe::utils::LinearArena::GetUsage() const
+{
+  return usage;
+}
+
+uint64_t lpe::utils::LinearArena::GetPeakUsage() const
+{
+  return peakUsage;
+}
+
+lpe::utils::FrameArena::FrameArena(uint64_t size,
+                                   uint64_t threadSize)
+  : main(size),
+    threadSize(threadSize)
+{
+}
+
+lpe::utils::LinearArena& lpe::utils::FrameArena::Get()
+{
+  return main;
+}
+
+lpe::utils::LinearArena& lpe::utils::FrameArena::GetThreadArena()
+{
+  std::lock_guard<std::mutex> lock(mutex);
+
+  auto& arena = threads[std::this_thread::get_id()];
+  if (!arena)
+  {
+    arena = std::make_unique<LinearArena>(threadSize);
+  }
+
+  return *arena;
+}
+
+void lpe::utils::FrameArena::Reset()
+{
+  std::lock_guard<std::mutex> lock(mutex);
+
+  main.Reset();
+
+  for (auto&& thread : threads)
+  {
+    thread.second->Reset();
+  }
+}
+
+uint64_t lpe::utils::FrameArena::GetUsage()
+{
+  std::lock_guard<std::mutex> lock(mutex);
+
+  uint64_t usage = main.GetUsage();
+  for (auto&& thread : threads)
+  {
+    usage += thread.second->GetUsage();
+  }
+
+  return usage;
+}
+
+uint64_t lpe::utils::FrameArena::GetPeakUsage()
+{
+  std::lock_guard<std::mutex> lock(mutex);
+
+  uint64_t peakUsage = main.GetPeakUsage();
+  for (auto&& thread : threads)
+  {
+    peakUsage += thread.second->GetPeakUsage();
+  }
+
+  return peakUsage;
+}
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace lpe
+{
+  namespace utils
+  {
+    /**
+     * \brief Bump allocator for short lived CPU data, everything gets released at once by Reset.
+     * Allocations which don't fit anymore go to an extra block, Reset merges the blocks into one large enough
+     * for the peak, so after a few frames a frame doesn't touch the heap at all. Destructors are never called.
+     * Not thread safe, use one arena per thread (see FrameArena).
+     */
+    class LinearArena
+    {
+    private:
+      struct Block
+      {
+        std::unique_ptr<uint8_t[]> Data;
+        uint64_t Size;
+      };
+
+      std::vector<Block> blocks;
+      uint64_t offset;
+      uint64_t usage;
+      uint64_t peakUsage;
+
+      void AddBlock(uint64_t size);
+    public:
+      /**
+       * \param size of the first block, grows on demand
+       */
+      explicit LinearArena(uint64_t size = 64 * 1024);
+      LinearArena(const LinearArena& other) = delete;
+      LinearArena(LinearArena&& other) noexcept = default;
+      LinearArena& operator=(const LinearArena& other) = delete;
+      LinearArena& operator=(LinearArena&& other) noexcept = default;
+      ~LinearArena() = default;
+
+      /**
+       * \param alignment power of two
+       */
+      void* Allocate(uint64_t size,
+                     uint64_t alignment = alignof(std::max_align_t));
+
+      /**
+       * \brief Releases all allocations in O(1), pointers into the arena become invalid
+       */
+      void Reset();
+
+      uint64_t GetCapacity() const;
+      uint64_t GetUsage() const;
+      uint64_t GetPeakUsage() const;
+    };
+
+    /**
+     * \brief std allocator on a LinearArena, deallocate does nothing. Containers must not outlive the next Reset.
+     */
+    template<typename T>
+    class ArenaAllocator
+    {
+    private:
+      template<typename U>
+      friend class ArenaAllocator;
+
+      LinearArena* arena;
+    public:
+      using value_type = T;
+
+      explicit ArenaAllocator(LinearArena& arena) noexcept;
+      template<typename U>
+      ArenaAllocator(const ArenaAllocator<U>& other) noexcept;
+
+      T* allocate(size_t count);
+      void deallocate(T* pointer,
+                      size_t count) noexcept;
+
+      template<typename U>
+      bool operator==(const ArenaAllocator<U>& other) const noexcept;
+      template<typename U>
+      bool operator!=(const ArenaAllocator<U>& other) const noexcept;
+    };
+
+    template<typename T>
+    using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+    /**
+     * \brief Scratch memory of one frame: an arena for the main thread and one sub arena per worker thread,
+     * so workers allocate without locking. Reset at the end of the frame once no worker uses its arena anymore.
+     */
+    class FrameArena
+    {
+    private:
+      LinearArena main;
+      uint64_t threadSize;
+
+      std::mutex mutex;
+      std::map<std::thread::id, std::unique_ptr<LinearArena>> threads;
+    public:
+      /**
+       * \param size of the main arena
+       * \param threadSize of every sub arena
+       */
+      explicit FrameArena(uint64_t size = 1024 * 1024,
+                          uint64_t threadSize = 64 * 1024);
+      FrameArena(const FrameArena& other) = delete;
+      FrameArena(FrameArena&& other) noexcept = delete;
+      FrameArena& operator=(const FrameArena& other) = delete;
+      FrameArena& operator=(FrameArena&& other) noexcept = delete;
+      ~FrameArena() = default;
+
+      LinearArena& Get();
+
+      /**
+       * \brief Arena of the calling thread, created on its first call. Locks, so fetch it once per task.
+       */
+      LinearArena& GetThreadArena();
+
+      /**
+       * \brief Resets the main and all thread arenas
+       */
+      void Reset();
+
+      uint64_t GetUsage();
+      uint64_t GetPeakUsage();
+    };
+  }
+}
+
+#include "FrameArena.inl"
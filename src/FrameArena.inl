@@ -0,0 +1,43 @@
+#pragma once
+
+#include "FrameArena.h"
+
+template<typename T>
+lpe::utils::ArenaAllocator<T>::ArenaAllocator(LinearArena& arena) noexcept
+  : arena(&arena)
+{
+}
+
+template<typename T>
+template<typename U>
+lpe::utils::ArenaAllocator<T>::ArenaAllocator(const ArenaAllocator<U>& other) noexcept
+  : arena(other.arena)
+{
+}
+
+template<typename T>
+T* lpe::utils::ArenaAllocator<T>::allocate(size_t count)
+{
+  return static_cast<T*>(arena->Allocate(count * sizeof(T), alignof(T)));
+}
+
+template<typename T>
+void lpe::utils::ArenaAllocator<T>::deallocate(T* /*pointer*/,
+                                               size_t /*count*/) noexcept
+{
+  // released by LinearArena::Reset
+}
+
+template<typename T>
+template<typename U>
+bool lpe::utils::ArenaAllocator<T>::operator==(const ArenaAllocator<U>& other) const noexcept
+{
+  return arena == other.arena;
+}
+
+template<typename T>
+template<typename U>
+bool lpe::utils::ArenaAllocator<T>::operator!=(const ArenaAllocator<U>& other) const noexcept
+{
+  return arena != other.arena;
+}
@@ -0,0 +1,270 @@
+#include "HostAllocator.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <new>
+
+lpe::utils::HostAllocator::HostAllocator(uint32_t scopeCount)
+  : statistics(std::max<uint32_t>(scopeCount, 1), HostAllocationStatistics{})
+{
+  freeSlots.fill(nullptr);
+}
+
+lpe::utils::HostAllocator::~HostAllocator()
+{
+  for (auto slab : slabs)
+  {
+    ::operator delete(slab, std::align_val_t(MaxPooledSize));
+  }
+}
+
+uint8_t* lpe::utils::HostAllocator::AllocateSlot(uint32_t sizeClass)
+{
+  if (!freeSlots[sizeClass])
+  {
+    // slabs are aligned to the largest class, so every slot is aligned to its own size
+    auto slab = static_cast<uint8_t*>(::operator new(SlabSize, std::align_val_t(MaxPooledSize), std::nothrow));
+    if (!slab)
+    {
+      return nullptr;
+    }
+    slabs.push_back(slab);
+
+    uint64_t slotSize = 1ull << (sizeClass + MinClassShift);
+    for (uint64_t offset = SlabSize; offset >= slotSize; offset -= slotSize)
+    {
+      auto slot = reinterpret_cast<FreeSlot*>(slab + offset - slotSize);
+      slot->Next = freeSlots[sizeClass];
+      freeSlots[sizeClass] = slot;
+    }
+  }
+
+  auto slot = freeSlots[sizeClass];
+  freeSlots[sizeClass] = slot->Next;
+
+  return reinterpret_cast<uint8_t*>(slot);
+}
+
+void lpe::utils::HostAllocator::TrackAllocation(uint32_t scope,
+                                                uint64_t size)
+{
+  auto& scopeStatistics = statistics[scope];
+
+  scopeStatistics.Usage += size;
+  scopeStatistics.PeakUsage = std::max(scopeStatistics.PeakUsage, scopeStatistics.Usage);
+  scopeStatistics.AllocationCount++;
+  scopeStatistics.TotalAllocations++;
+}
+
+void lpe::utils::HostAllocator::TrackFree(uint32_t scope,
+                                          uint64_t size)
+{
+  auto& scopeStatistics = statistics[scope];
+
+  scopeStatistics.Usage -= size;
+  scopeStatistics.AllocationCount--;
+  scopeStatistics.TotalFrees++;
+}
+
+void* lpe::utils::HostAllocator::Allocate(uint64_t size,
+                                          uint64_t alignment,
+                                          uint32_t scope)
+{
+  assert(scope < statistics.size());
+  assert(alignment > 0 && (alignment & (alignment - 1)) == 0);
+
+  if (size == 0)
+  {
+    return nullptr;
+  }
+
+  // the header sits right in front of the returned pointer, alignment bytes keep the pointer aligned
+  uint64_t offset = std::max<uint64_t>(sizeof(Header), alignment);
+  uint64_t total = offset + size;
+
+  uint8_t* block = nullptr;
+  uint16_t sizeClass = LargeClass;
+
+  if (total <= MaxPooledSize)
+  {
+    sizeClass = 0;
+    while ((1ull << (sizeClass + MinClassShift)) < total)
+    {
+      sizeClass++;
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(mutex);
+
+  if (sizeClass == LargeClass)
+  {
+    block = static_cast<uint8_t*>(::operator new(total, std::align_val_t(offset), std::nothrow));
+  }
+  else
+  {
+    block = AllocateSlot(sizeClass);
+  }
+
+  if (!block)
+  {
+    return nullptr;
+  }
+
+  auto header = reinterpret_cast<Header*>(block + offset) - 1;
+  header->Size = size;
+  header->Class = sizeClass;
+  header->Scope = static_cast<uint16_t>(scope);
+  header->Offset = static_cast<uint32_t>(offset);
+
+  TrackAllocation(scope, size);
+
+  return block + offset;
+}
+
+void* lpe::utils::HostAllocator::Reallocate(void* pointer,
+                                            uint64_t size,
+                                            uint64_t alignment,
+                                            uint32_t scope)
+{
+  if (!pointer)
+  {
+    return Allocate(size, alignment, scope);
+  }
+
+  if (size == 0)
+  {
+    Free(pointer);
+
+    return nullptr;
+  }
+
+  auto header = static_cast<Header*>(pointer) - 1;
+  uint64_t capacity = header->Class == LargeClass ?
+                      header->Size :
+                      (1ull << (header->Class + MinClassShift)) - header->Offset;
+
+  if (size <= capacity && alignment <= header->Offset)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto& oldStatistics = statistics[header->Scope];
+    oldStatistics.Usage -= header->Size;
+    oldStatistics.AllocationCount--;
+
+    auto& newStatistics = statistics[scope];
+    newStatistics.Usage += size;
+    newStatistics.PeakUsage = std::max(newStatistics.PeakUsage, newStatistics.Usage);
+    newStatistics.AllocationCount++;
+
+    // a shrunk large block moves when it grows again, its header only knows the current size
+    header->Size = size;
+    header->Scope = static_cast<uint16_t>(scope);
+
+    return pointer;
+  }
+
+  auto moved = Allocate(size, alignment, scope);
+  if (moved)
+  {
+    std::memcpy(moved, pointer, std::min(size, header->Size));
+    Free(pointer);
+  }
+
+  return moved;
+}
+
+void lpe::utils::HostAllocator::Free(void* pointer)
+{
+  if (!pointer)
+  {
+    return;
+  }
+
+  auto header = static_cast<Header*>(pointer) - 1;
+  auto block = static_cast<uint8_t*>(pointer) - header->Offset;
+
+  std::lock_guard<std::mutex> lock(mutex);
+
+  TrackFree(header->Scope, header->Size);
+
+  if (header->Class == LargeClass)
+  {
+    ::operator delete(block, std::align_val_t(header->Offset));
+  }
+  else
+  {
+    auto slot = reinterpret_cast<FreeSlot*>(block);
+    slot->Next = freeSlots[header->Class];
+    freeSlots[header->Class] = slot;
+  }
+}
+
+void lpe::utils::HostAllocator::NotifyInternalAllocation(uint64_t size,
+                                                         uint32_t scope)
+{
+  assert(scope < statistics.size());
+
+  std::lock_guard<std::mutex> lock(mutex);
+
+  statistics[scope].InternalUsage += size;
+}
+
+void lpe::utils::HostAllocator::NotifyInternalFree(uint64_t size,
+                                                   uint32_t scope)
+{
+  assert(scope < statistics.size());
+
+  std::lock_guard<std::mutex> lock(mutex);
+
+  statistics[scope].InternalUsage -= size;
+}
+
+uint32_t lpe::utils::HostAllocator::GetScopeCount() const
+{
+  return static_cast<uint32_t>(statistics.size());
+}
+
+lpe::utils::HostAllocationStatistics lpe::utils::HostAllocator::GetStatistics(uint32_t scope)
+{
+  assert(scope < statistics.size());
+
+  std::lock_guard<std::mutex> lock(mutex);
+
+  return statistics[scope];
+}
+
+lpe::utils::HostAllocationStatistics lpe::utils::HostAllocator::GetTotalStatistics()
+{
+  std::lock_guard<std::mutex> lock(mutex);
+
+  HostAllocationStatistics total = {};
+  for (auto&& scopeStatistics : statistics)
+  {
+    total.Usage += scopeStatistics.Usage;
+    total.PeakUsage += scopeStatistics.PeakUsage;
+    total.AllocationCount += scopeStatistics.AllocationCount;
+    total.TotalAllocations += scopeStatistics.TotalAllocations;
+    total.TotalFrees += scopeStatistics.TotalFrees;
+    total.InternalUsage += scopeStatistics.InternalUsage;
+  }
+
+  return total;
+}
+
+uint64_t lpe::utils::HostAllocator::GetSlabSize()
+{
+  std::lock_guard<std::mutex> lock(mutex);
+
+  return slabs.size() * SlabSize;
+}
+
+void lpe::utils::HostAllocator::ResetPeaks()
+{
+  std::lock_guard<std::mutex> lock(mutex);
+
+  for (auto&& scopeStatistics : statistics)
+  {
+    scopeStatistics.PeakUsage = scopeStatistics.Usage;
+  }
+}
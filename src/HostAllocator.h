@@ -0,0 +1,124 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace lpe
+{
+  namespace utils
+  {
+    /**
+     * \brief Bytes and calls of one allocation scope of a HostAllocator
+     */
+    struct HostAllocationStatistics
+    {
+      uint64_t Usage;
+      uint64_t PeakUsage;
+      uint64_t AllocationCount;
+      uint64_t TotalAllocations;  // every Allocate and moving Reallocate, the churn
+      uint64_t TotalFrees;
+      uint64_t InternalUsage;  // reported by NotifyInternalAllocation, e.g. executable memory of a driver
+    };
+
+    /**
+     * \brief malloc/realloc/free replacement which keeps statistics per scope, made for VkAllocationCallbacks.
+     * Small allocations come from free lists of power of two size classes carved out of 64KiB slabs,
+     * so the many short lived allocations of a driver (command recording, descriptor updates) don't reach
+     * the general heap. Larger ones are forwarded to aligned operator new.
+     * Free only gets the pointer, so every allocation carries a 16 byte header (or alignment bytes).
+     * Thread safe, drivers call it from every thread which creates objects or records commands.
+     */
+    class HostAllocator
+    {
+    private:
+      static constexpr uint32_t MinClassShift = 5;   // 32 bytes
+      static constexpr uint32_t MaxClassShift = 12;  // 4KiB
+      static constexpr uint32_t ClassCount = MaxClassShift - MinClassShift + 1;
+      static constexpr uint16_t LargeClass = UINT16_MAX;
+      static constexpr uint64_t SlabSize = 64 * 1024;
+
+      struct Header
+      {
+        uint64_t Size;
+        uint16_t Class;
+        uint16_t Scope;
+        uint32_t Offset;  // from the start of the slot (or the operator new block) to the user pointer
+      };
+
+      struct FreeSlot
+      {
+        FreeSlot* Next;
+      };
+
+      std::mutex mutex;
+      std::array<FreeSlot*, ClassCount> freeSlots;
+      std::vector<uint8_t*> slabs;
+      std::vector<HostAllocationStatistics> statistics;
+
+      uint8_t* AllocateSlot(uint32_t sizeClass);
+      void TrackAllocation(uint32_t scope,
+                           uint64_t size);
+      void TrackFree(uint32_t scope,
+                     uint64_t size);
+    public:
+      static constexpr uint64_t MaxPooledSize = 1ull << MaxClassShift;
+
+      /**
+       * \param scopeCount e.g. the number of VkSystemAllocationScope values
+       */
+      explicit HostAllocator(uint32_t scopeCount = 1);
+      HostAllocator(const HostAllocator& other) = delete;
+      HostAllocator(HostAllocator&& other) noexcept = delete;
+      HostAllocator& operator=(const HostAllocator& other) = delete;
+      HostAllocator& operator=(HostAllocator&& other) noexcept = delete;
+      /**
+       * \brief Releases the slabs, allocations still in use become invalid
+       */
+      ~HostAllocator();
+
+      /**
+       * \param alignment power of two
+       * \return nullptr if the heap is exhausted
+       */
+      void* Allocate(uint64_t size,
+                     uint64_t alignment,
+                     uint32_t scope = 0);
+
+      /**
+       * \brief realloc semantics: nullptr allocates, size 0 frees and returns nullptr.
+       * Shrinking or growing inside the size class keeps the pointer.
+       * \return nullptr on failure, the original allocation stays valid then
+       */
+      void* Reallocate(void* pointer,
+                       uint64_t size,
+                       uint64_t alignment,
+                       uint32_t scope = 0);
+
+      /**
+       * \param pointer nullptr is ignored
+       */
+      void Free(void* pointer);
+
+      /**
+       * \brief Counts memory the caller allocated on its own, e.g. vkInternalAllocationNotification
+       */
+      void NotifyInternalAllocation(uint64_t size,
+                                    uint32_t scope = 0);
+      void NotifyInternalFree(uint64_t size,
+                              uint32_t scope = 0);
+
+      uint32_t GetScopeCount() const;
+      HostAllocationStatistics GetStatistics(uint32_t scope);
+      HostAllocationStatistics GetTotalStatistics();
+
+      /**
+       * \brief Bytes reserved by the slabs of the small size classes
+       */
+      uint64_t GetSlabSize();
+      void ResetPeaks();
+    };
+  }
+}
@@ -0,0 +1,97 @@
+#include "LinearAllocator.h"
+
+#include <cassert>
+
+lpe::rendering::LinearAllocator::LinearAllocator()
+{
+  Create(0);
+}
+
+void lpe::rendering::LinearAllocator::Create(uint64_t size)
+{
+  this->size = size;
+  this->usage = 0;
+  this->offset = 0;
+
+  allocations.clear();
+}
+
+uint64_t lpe::rendering::LinearAllocator::Allocate(uint64_t size,
+                                                   uint64_t alignment)
+{
+  assert(size > 0);
+  assert(alignment > 0 && (alignment & (alignment - 1)) == 0);
+
+  if (!CanAllocate(size, alignment))
+  {
+    return InvalidOffset;
+  }
+
+  uint64_t begin = (offset + alignment - 1) / alignment * alignment;
+  offset = begin + size;
+
+  usage += size;
+  allocations.emplace(begin, offset);
+
+  return begin;
+}
+
+void lpe::rendering::LinearAllocator::Free(uint64_t offset)
+{
+  auto iter = allocations.find(offset);
+  assert(iter != std::end(allocations));
+
+  usage -= iter->second - iter->first;
+
+  bool last = std::next(iter) == std::end(allocations);
+  iter = allocations.erase(iter);
+
+  if (allocations.empty())
+  {
+    this->offset = 0;
+  }
+  else if (last)
+  {
+    this->offset = std::prev(iter)->second;
+  }
+}
+
+bool lpe::rendering::LinearAllocator::CanAllocate(uint64_t size,
+                                                  uint64_t alignment) const
+{
+  uint64_t begin = (offset + alignment - 1) / alignment * alignment;
+
+  return size > 0 && begin <= this->size && size <= this->size - begin;
+}
+
+uint64_t lpe::rendering::LinearAllocator::GetRequiredSize(uint64_t size,
+                                                          uint64_t /*alignment*/) const
+{
+  return size;
+}
+
+uint64_t lpe::rendering::LinearAllocator::GetSize() const
+{
+  return size;
+}
+
+uint64_t lpe::rendering::LinearAllocator::GetUsage() const
+{
+  return usage;
+}
+
+size_t lpe::rendering::LinearAllocator::GetAllocationCount() const
+{
+  return allocations.size();
+}
+
+uint64_t lpe::rendering::LinearAllocator::GetLargestFreeBlock() const
+{
+  // ranges freed below the newest allocation only return once it is freed as well
+  return size - offset;
+}
+
+std::unique_ptr<lpe::rendering::ISubAllocator> lpe::rendering::LinearAllocator::Clone() const
+{
+  return std::make_unique<LinearAllocator>(*this);
+}
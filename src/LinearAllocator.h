@@ -0,0 +1,50 @@
+#pragma once
+
+#include "SubAllocator.h"
+
+#include <map>
+
+namespace lpe
+{
+  namespace rendering
+  {
+    /**
+     * \brief Bump pointer, freeing the newest allocation moves the pointer back and
+     * the memory starts over as soon as every allocation is freed
+     */
+    class LinearAllocator : public ISubAllocator
+    {
+    private:
+      uint64_t size;
+      uint64_t usage;
+      uint64_t offset;
+
+      // offset -> end
+      std::map<uint64_t, uint64_t> allocations;
+    public:
+      LinearAllocator();
+      LinearAllocator(const LinearAllocator& other) = default;
+      LinearAllocator(LinearAllocator&& other) noexcept = default;
+      LinearAllocator& operator=(const LinearAllocator& other) = default;
+      LinearAllocator& operator=(LinearAllocator&& other) noexcept = default;
+      ~LinearAllocator() override = default;
+
+      void Create(uint64_t size) override;
+
+      uint64_t Allocate(uint64_t size,
+                        uint64_t alignment = 1) override;
+      void Free(uint64_t offset) override;
+      bool CanAllocate(uint64_t size,
+                       uint64_t alignment = 1) const override;
+      uint64_t GetRequiredSize(uint64_t size,
+                               uint64_t alignment = 1) const override;
+
+      uint64_t GetSize() const override;
+      uint64_t GetUsage() const override;
+      size_t GetAllocationCount() const override;
+      uint64_t GetLargestFreeBlock() const override;
+
+      std::unique_ptr<ISubAllocator> Clone() const override;
+    };
+  }
+}
@@ -0,0 +1,85 @@
+#include "MemoryBackend.h"
+
+#include <algorithm>
+#include <cassert>
+#include <new>
+
+lpe::rendering::HostMemoryBackend::HostMemoryBackend(uint64_t limit,
+                                                     bool commit)
+  : limit(limit),
+    commit(commit),
+    nextHandle(1),
+    allocated(0),
+    peakAllocated(0),
+    peakCount(0)
+{
+}
+
+uint64_t lpe::rendering::HostMemoryBackend::Allocate(uint64_t size,
+                                                     uint32_t /*memoryType*/,
+                                                     const void* /*next*/)
+{
+  assert(size > 0);
+
+  if (size > limit - allocated)
+  {
+    return InvalidHandle;
+  }
+
+  Block block = { nullptr, size };
+  if (commit)
+  {
+    block.Data.reset(new (std::nothrow) uint8_t[size]);
+    if (!block.Data)
+    {
+      return InvalidHandle;
+    }
+  }
+
+  auto handle = nextHandle++;
+  blocks.emplace(handle, std::move(block));
+
+  allocated += size;
+  peakAllocated = std::max(peakAllocated, allocated);
+  peakCount = std::max(peakCount, blocks.size());
+
+  return handle;
+}
+
+void lpe::rendering::HostMemoryBackend::Free(uint64_t handle)
+{
+  auto iter = blocks.find(handle);
+  assert(iter != std::end(blocks));
+
+  allocated -= iter->second.Size;
+  blocks.erase(iter);
+}
+
+uint8_t* lpe::rendering::HostMemoryBackend::GetData(uint64_t handle) const
+{
+  auto iter = blocks.find(handle);
+
+  return iter != std::end(blocks) ?
+         iter->second.Data.get() :
+         nullptr;
+}
+
+size_t lpe::rendering::HostMemoryBackend::GetAllocationCount() const
+{
+  return blocks.size();
+}
+
+uint64_t lpe::rendering::HostMemoryBackend::GetAllocatedSize() const
+{
+  return allocated;
+}
+
+uint64_t lpe::rendering::HostMemoryBackend::GetPeakAllocatedSize() const
+{
+  return peakAllocated;
+}
+
+size_t lpe::rendering::HostMemoryBackend::GetPeakAllocationCount() const
+{
+  return peakCount;
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+
+namespace lpe
+{
+  namespace rendering
+  {
+    /**
+     * \brief Source of the memory blocks which get sub allocated by MemoryPool, e.g. vk::DeviceMemory.
+     * Handles are opaque to the pools.
+     */
+    class IMemoryBackend
+    {
+    public:
+      static constexpr uint64_t InvalidHandle = 0;
+
+      IMemoryBackend() = default;
+      virtual ~IMemoryBackend() = default;
+
+      /**
+       * \param next backend specific extension (e.g. vk::MemoryDedicatedAllocateInfo), backends may ignore it
+       * \return handle or InvalidHandle if the memory is exhausted or over budget
+       */
+      virtual uint64_t Allocate(uint64_t size,
+                                uint32_t memoryType,
+                                const void* next = nullptr) = 0;
+      virtual void Free(uint64_t handle) = 0;
+    };
+
+    /**
+     * \brief Backend without a GPU for tests, benchmarks and fuzzing of the pools.
+     * Only bookkeeping by default, commit allocates real host memory (e.g. to let sanitizers check writes).
+     */
+    class HostMemoryBackend : public IMemoryBackend
+    {
+    private:
+      struct Block
+      {
+        std::unique_ptr<uint8_t[]> Data;
+        uint64_t Size;
+      };
+
+      uint64_t limit;
+      bool commit;
+      uint64_t nextHandle;
+      uint64_t allocated;
+      uint64_t peakAllocated;
+      size_t peakCount;
+
+      std::unordered_map<uint64_t, Block> blocks;
+    public:
+      /**
+       * \param limit total size of all blocks, Allocate fails beyond it like a full heap
+       * \param commit allocate host memory for every block
+       */
+      explicit HostMemoryBackend(uint64_t limit = UINT64_MAX,
+                                 bool commit = false);
+      HostMemoryBackend(const HostMemoryBackend& other) = delete;
+      HostMemoryBackend(HostMemoryBackend&& other) noexcept = default;
+      HostMemoryBackend& operator=(const HostMemoryBackend& other) = delete;
+      HostMemoryBackend& operator=(HostMemoryBackend&& other) noexcept = default;
+      ~HostMemoryBackend() override = default;
+
+      uint64_t Allocate(uint64_t size,
+                        uint32_t memoryType,
+                        const void* next = nullptr) override;
+      void Free(uint64_t handle) override;
+
+      /**
+       * \return nullptr if the backend doesn't commit memory
+       */
+      uint8_t* GetData(uint64_t handle) const;
+
+      size_t GetAllocationCount() const;
+      uint64_t GetAllocatedSize() const;
+      uint64_t GetPeakAllocatedSize() const;
+      size_t GetPeakAllocationCount() const;
+    };
+  }
+}
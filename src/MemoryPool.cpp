@@ -0,0 +1,408 @@
+#include "MemoryPool.h"
+
+#include <algorithm>
+#include <cassert>
+
+lpe::rendering::MemoryChunk::MemoryChunk()
+{
+  this->backend = nullptr;
+  this->handle = IMemoryBackend::InvalidHandle;
+  this->size = 0;
+  this->memoryType = 0;
+  this->dedicated = false;
+  this->occupied = false;
+}
+
+bool lpe::rendering::MemoryChunk::Create(IMemoryBackend& backend,
+                                         uint64_t size,
+                                         uint32_t memoryType,
+                                         AllocationPolicy policy,
+                                         const void* next,
+                                         bool dedicated)
+{
+  assert(handle == IMemoryBackend::InvalidHandle);
+  assert(size > 0);
+
+  this->handle = backend.Allocate(size, memoryType, next);
+  if (handle == IMemoryBackend::InvalidHandle)
+  {
+    return false;
+  }
+
+  this->backend = &backend;
+  this->size = size;
+  this->memoryType = memoryType;
+  this->dedicated = dedicated;
+  this->occupied = false;
+
+  if (!dedicated)
+  {
+    allocator = CreateSubAllocator(policy);
+    allocator->Create(size);
+  }
+
+  return true;
+}
+
+void lpe::rendering::MemoryChunk::Destroy()
+{
+  if (handle != IMemoryBackend::InvalidHandle)
+  {
+    backend->Free(handle);
+    handle = IMemoryBackend::InvalidHandle;
+  }
+
+  allocator.reset();
+  size = 0;
+  occupied = false;
+}
+
+uint64_t lpe::rendering::MemoryChunk::Allocate(uint64_t size,
+                                               uint64_t alignment)
+{
+  if (dedicated)
+  {
+    if (!Fits(size, alignment))
+    {
+      return ISubAllocator::InvalidOffset;
+    }
+
+    occupied = true;
+
+    return 0;
+  }
+
+  return allocator->Allocate(size, alignment);
+}
+
+void lpe::rendering::MemoryChunk::Free(uint64_t offset)
+{
+  if (dedicated)
+  {
+    assert(occupied && offset == 0);
+
+    occupied = false;
+
+    return;
+  }
+
+  allocator->Free(offset);
+}
+
+bool lpe::rendering::MemoryChunk::Fits(uint64_t size,
+                                       uint64_t alignment) const
+{
+  if (dedicated)
+  {
+    // offset 0 of a fresh allocation satisfies every alignment
+    return handle != IMemoryBackend::InvalidHandle && !occupied && size > 0 && size <= this->size;
+  }
+
+  return allocator && allocator->CanAllocate(size, alignment);
+}
+
+bool lpe::rendering::MemoryChunk::IsEmpty() const
+{
+  if (dedicated)
+  {
+    return !occupied;
+  }
+
+  return !allocator || allocator->GetAllocationCount() == 0;
+}
+
+bool lpe::rendering::MemoryChunk::IsDedicated() const
+{
+  return dedicated;
+}
+
+uint64_t lpe::rendering::MemoryChunk::GetHandle() const
+{
+  return handle;
+}
+
+uint64_t lpe::rendering::MemoryChunk::GetSize() const
+{
+  return size;
+}
+
+uint64_t lpe::rendering::MemoryChunk::GetUsage() const
+{
+  if (dedicated)
+  {
+    return occupied ? size : 0;
+  }
+
+  return allocator ? allocator->GetUsage() : 0;
+}
+
+uint64_t lpe::rendering::MemoryChunk::GetLargestFreeBlock() const
+{
+  if (dedicated)
+  {
+    return occupied ? 0 : size;
+  }
+
+  return allocator ? allocator->GetLargestFreeBlock() : 0;
+}
+
+size_t lpe::rendering::MemoryChunk::GetAllocationCount() const
+{
+  if (dedicated)
+  {
+    return occupied ? 1 : 0;
+  }
+
+  return allocator ? allocator->GetAllocationCount() : 0;
+}
+
+uint32_t lpe::rendering::MemoryChunk::GetMemoryType() const
+{
+  return memoryType;
+}
+
+lpe::rendering::MemoryPool::MemoryPool()
+{
+  this->backend = nullptr;
+  this->memoryType = 0;
+  this->chunkSize = 0;
+  this->policy = AllocationPolicy::Tlsf;
+  this->peakChunkCount = 0;
+}
+
+void lpe::rendering::MemoryPool::Create(IMemoryBackend& backend,
+                                        uint32_t memoryType,
+                                        uint64_t chunkSize,
+                                        AllocationPolicy policy)
+{
+  assert(chunks.empty() && dedicated.empty());
+  assert(chunkSize > 0);
+
+  this->backend = &backend;
+  this->memoryType = memoryType;
+  this->chunkSize = chunkSize;
+  this->policy = policy;
+  this->peakChunkCount = 0;
+}
+
+void lpe::rendering::MemoryPool::Destroy()
+{
+  for (auto&& chunk : chunks)
+  {
+    chunk->Destroy();
+  }
+
+  for (auto&& chunk : dedicated)
+  {
+    chunk->Destroy();
+  }
+
+  chunks.clear();
+  dedicated.clear();
+  draining.clear();
+}
+
+void lpe::rendering::MemoryPool::SetChunkSize(uint64_t chunkSize)
+{
+  assert(chunkSize > 0);
+
+  this->chunkSize = chunkSize;
+}
+
+lpe::rendering::MemoryChunk* lpe::rendering::MemoryPool::CreateChunk(uint64_t size,
+                                                                     const void* next,
+                                                                     bool dedicated)
+{
+  auto chunk = std::make_unique<MemoryChunk>();
+  if (!chunk->Create(*backend, size, memoryType, policy, next, dedicated))
+  {
+    return nullptr;
+  }
+
+  auto& list = dedicated ? this->dedicated : chunks;
+  list.push_back(std::move(chunk));
+
+  peakChunkCount = std::max(peakChunkCount, GetChunkCount());
+
+  return list.back().get();
+}
+
+bool lpe::rendering::MemoryPool::Allocate(uint64_t size,
+                                          uint64_t alignment,
+                                          PoolAllocation& allocation)
+{
+  for (auto&& chunk : chunks)
+  {
+    if (draining.count(chunk.get()) > 0)
+    {
+      continue;
+    }
+
+    auto offset = chunk->Allocate(size, alignment);
+    if (offset != ISubAllocator::InvalidOffset)
+    {
+      allocation = { chunk.get(), offset };
+
+      return true;
+    }
+  }
+
+  // allocations larger than a chunk get a chunk of their own size, rounded so the policy can place them
+  auto required = CreateSubAllocator(policy)->GetRequiredSize(size, alignment);
+  auto chunk = CreateChunk(std::max(chunkSize, required), nullptr, false);
+  if (!chunk)
+  {
+    return false;
+  }
+
+  auto offset = chunk->Allocate(size, alignment);
+  if (offset == ISubAllocator::InvalidOffset)
+  {
+    DestroyChunk(chunk);
+
+    return false;
+  }
+
+  allocation = { chunk, offset };
+
+  return true;
+}
+
+bool lpe::rendering::MemoryPool::AllocateDedicated(uint64_t size,
+                                                   const void* next,
+                                                   PoolAllocation& allocation)
+{
+  auto chunk = CreateChunk(size, next, true);
+  if (!chunk)
+  {
+    return false;
+  }
+
+  auto offset = chunk->Allocate(size, 1);
+  if (offset == ISubAllocator::InvalidOffset)
+  {
+    DestroyChunk(chunk);
+
+    return false;
+  }
+
+  allocation = { chunk, offset };
+
+  return true;
+}
+
+void lpe::rendering::MemoryPool::Free(const PoolAllocation& allocation)
+{
+  auto chunk = allocation.Chunk;
+  chunk->Free(allocation.Offset);
+
+  if (!chunk->IsEmpty())
+  {
+    return;
+  }
+
+  // keep one empty chunk, resources often get recreated right away
+  if (!chunk->IsDedicated() && chunks.size() <= 1)
+  {
+    return;
+  }
+
+  DestroyChunk(chunk);
+}
+
+void lpe::rendering::MemoryPool::DestroyChunk(MemoryChunk* chunk)
+{
+  auto& list = chunk->IsDedicated() ? dedicated : chunks;
+
+  auto found = std::find_if(std::begin(list),
+                            std::end(list),
+                            [chunk](const std::unique_ptr<MemoryChunk>& other)
+                            {
+                              return other.get() == chunk;
+                            });
+  assert(found != std::end(list));
+
+  draining.erase(chunk);
+
+  (*found)->Destroy();
+  list.erase(found);
+}
+
+void lpe::rendering::MemoryPool::SetDraining(const MemoryChunk* chunk)
+{
+  draining.insert(chunk);
+}
+
+bool lpe::rendering::MemoryPool::IsDraining(const MemoryChunk* chunk) const
+{
+  return draining.count(chunk) > 0;
+}
+
+void lpe::rendering::MemoryPool::ClearDraining()
+{
+  draining.clear();
+}
+
+const std::vector<std::unique_ptr<lpe::rendering::MemoryChunk>>& lpe::rendering::MemoryPool::GetChunks() const
+{
+  return chunks;
+}
+
+const std::vector<std::unique_ptr<lpe::rendering::MemoryChunk>>& lpe::rendering::MemoryPool::GetDedicatedChunks() const
+{
+  return dedicated;
+}
+
+size_t lpe::rendering::MemoryPool::GetChunkCount() const
+{
+  return chunks.size() + dedicated.size();
+}
+
+size_t lpe::rendering::MemoryPool::GetPeakChunkCount() const
+{
+  return peakChunkCount;
+}
+
+uint64_t lpe::rendering::MemoryPool::GetSize() const
+{
+  uint64_t size = 0;
+  for (auto list : { &chunks, &dedicated })
+  {
+    for (auto&& chunk : *list)
+    {
+      size += chunk->GetSize();
+    }
+  }
+
+  return size;
+}
+
+uint64_t lpe::rendering::MemoryPool::GetUsage() const
+{
+  uint64_t usage = 0;
+  for (auto list : { &chunks, &dedicated })
+  {
+    for (auto&& chunk : *list)
+    {
+      usage += chunk->GetUsage();
+    }
+  }
+
+  return usage;
+}
+
+float lpe::rendering::MemoryPool::GetFragmentation() const
+{
+  uint64_t free = 0;
+  uint64_t largest = 0;
+
+  for (auto&& chunk : chunks)
+  {
+    free += chunk->GetSize() - chunk->GetUsage();
+    largest += chunk->GetLargestFreeBlock();
+  }
+
+  return free > 0 ?
+         1.0f - static_cast<float>(largest) / free :
+         0.0f;
+}
@@ -0,0 +1,160 @@
+#pragma once
+
+#include "MemoryBackend.h"
+#include "SubAllocator.h"
+
+#include <set>
+#include <vector>
+
+namespace lpe
+{
+  namespace rendering
+  {
+    /**
+     * \brief One block of an IMemoryBackend, resources get ranges of it
+     */
+    class MemoryChunk
+    {
+    private:
+      IMemoryBackend* backend;
+      uint64_t handle;
+      uint64_t size;
+      uint32_t memoryType;
+      bool dedicated;
+      bool occupied;  // a dedicated chunk holds its one resource at offset 0, it has no allocator
+
+      std::unique_ptr<ISubAllocator> allocator;
+    public:
+      MemoryChunk();
+      MemoryChunk(const MemoryChunk& other) = delete;
+      MemoryChunk(MemoryChunk&& other) noexcept = default;
+      MemoryChunk& operator=(const MemoryChunk& other) = delete;
+      MemoryChunk& operator=(MemoryChunk&& other) noexcept = default;
+      ~MemoryChunk() = default;
+
+      /**
+       * \param next passed to the backend, e.g. vk::MemoryDedicatedAllocateInfo
+       * \param dedicated the chunk belongs to one resource at offset 0 and never gets shared, the policy is unused
+       * \return false if the backend is out of memory
+       */
+      bool Create(IMemoryBackend& backend,
+                  uint64_t size,
+                  uint32_t memoryType,
+                  AllocationPolicy policy = AllocationPolicy::Tlsf,
+                  const void* next = nullptr,
+                  bool dedicated = false);
+      void Destroy();
+
+      /**
+       * \return offset or ISubAllocator::InvalidOffset if the chunk is too full
+       */
+      uint64_t Allocate(uint64_t size,
+                        uint64_t alignment);
+      void Free(uint64_t offset);
+
+      bool Fits(uint64_t size,
+                uint64_t alignment) const;
+      bool IsEmpty() const;
+      bool IsDedicated() const;
+
+      uint64_t GetHandle() const;
+      uint64_t GetSize() const;
+      uint64_t GetUsage() const;
+      uint64_t GetLargestFreeBlock() const;
+      size_t GetAllocationCount() const;
+      uint32_t GetMemoryType() const;
+    };
+
+    struct PoolAllocation
+    {
+      MemoryChunk* Chunk;
+      uint64_t Offset;
+    };
+
+    /**
+     * \brief Chunks of one memory type. Allocations go into the first chunk with room, a new chunk of chunkSize
+     * (or the size the policy needs for the allocation if larger) is created when none fits. Chunks which become empty are released
+     * except the last one, resources often get recreated right away.
+     * No graphics API calls, the memory comes from the backend (see vulkan::DeviceMemoryBackend, HostMemoryBackend).
+     */
+    class MemoryPool
+    {
+    private:
+      IMemoryBackend* backend;
+      uint32_t memoryType;
+      uint64_t chunkSize;
+      AllocationPolicy policy;
+      size_t peakChunkCount;
+
+      std::vector<std::unique_ptr<MemoryChunk>> chunks;
+      std::vector<std::unique_ptr<MemoryChunk>> dedicated;
+      std::set<const MemoryChunk*> draining;
+
+      MemoryChunk* CreateChunk(uint64_t size,
+                               const void* next,
+                               bool dedicated);
+      void DestroyChunk(MemoryChunk* chunk);
+    public:
+      MemoryPool();
+      MemoryPool(const MemoryPool& other) = delete;
+      MemoryPool(MemoryPool&& other) noexcept = default;
+      MemoryPool& operator=(const MemoryPool& other) = delete;
+      MemoryPool& operator=(MemoryPool&& other) noexcept = default;
+      ~MemoryPool() = default;
+
+      void Create(IMemoryBackend& backend,
+                  uint32_t memoryType,
+                  uint64_t chunkSize,
+                  AllocationPolicy policy = AllocationPolicy::Tlsf);
+
+      /**
+       * \brief Frees all chunks, allocations which are still alive are gone as well
+       */
+      void Destroy();
+
+      /**
+       * \brief Only affects chunks created afterwards
+       */
+      void SetChunkSize(uint64_t chunkSize);
+
+      /**
+       * \param alignment power of two
+       * \return false if nothing fits and the backend couldn't provide another chunk
+       */
+      bool Allocate(uint64_t size,
+                    uint64_t alignment,
+                    PoolAllocation& allocation);
+
+      /**
+       * \brief Creates a chunk of exactly size bytes for one resource, the offset is always 0
+       * \param next passed to the backend, e.g. vk::MemoryDedicatedAllocateInfo
+       * \return false if the backend couldn't provide the chunk
+       */
+      bool AllocateDedicated(uint64_t size,
+                             const void* next,
+                             PoolAllocation& allocation);
+      void Free(const PoolAllocation& allocation);
+
+      /**
+       * \brief Draining chunks don't take new allocations (they get emptied by a defragmentation)
+       */
+      void SetDraining(const MemoryChunk* chunk);
+      bool IsDraining(const MemoryChunk* chunk) const;
+      void ClearDraining();
+
+      const std::vector<std::unique_ptr<MemoryChunk>>& GetChunks() const;
+      const std::vector<std::unique_ptr<MemoryChunk>>& GetDedicatedChunks() const;
+
+      size_t GetChunkCount() const;
+      size_t GetPeakChunkCount() const;
+      uint64_t GetSize() const;
+      uint64_t GetUsage() const;
+
+      /**
+       * \brief Share of the free memory of the shared chunks which isn't part of the largest free block of its chunk.
+       * 0 means every chunk has its free memory in one range, close to 1 means a lot of small holes.
+       */
+      float GetFragmentation() const;
+    };
+  }
+}
@@ -0,0 +1,826 @@
+#include "Mesh.h"
+#include "ServiceLocator.h"
+#include "Triangulator.h"
+
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <set>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+
+namespace
+{
+  struct PlyElement
+  {
+    std::string Name;
+    uint64_t Count;
+    std::vector<std::string> Properties;
+    bool IsList;
+  };
+
+  void Log(const char* message)
+  {
+    auto manager = lpe::ServiceLocator::LogManager.Get()
+                                                  .lock();
+    if (manager)
+    {
+      manager->Log(message);
+    }
+  }
+
+  int32_t FindProperty(const PlyElement& element,
+                       const char* name)
+  {
+    for (size_t i = 0; i < element.Properties.size(); ++i)
+    {
+      if (element.Properties[i] == name)
+      {
+        return static_cast<int32_t>(i);
+      }
+    }
+
+    return -1;
+  }
+
+  void HashCombine(size_t& seed,
+                   float value)
+  {
+    // +0.0f maps -0.0f onto 0.0f so both end up in the same bucket
+    value += 0.0f;
+
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+
+    seed ^= std::hash<uint32_t>()(bits) + 0x9E3779B9 + (seed << 6) + (seed >> 2);
+  }
+
+  bool IsNear(glm::vec3 a,
+              glm::vec3 b,
+              float epsilon)
+  {
+    glm::vec3 delta = glm::abs(a - b);
+
+    return delta.x <= epsilon && delta.y <= epsilon && delta.z <= epsilon;
+  }
+
+  uint64_t PackCell(int64_t x,
+                    int64_t y,
+                    int64_t z)
+  {
+    return ((static_cast<uint64_t>(x) & 0x1FFFFF) << 42) |
+           ((static_cast<uint64_t>(y) & 0x1FFFFF) << 21) |
+           (static_cast<uint64_t>(z) & 0x1FFFFF);
+  }
+
+  uint64_t GetMajorDirection(glm::vec3 normal)
+  {
+    glm::vec3 a = glm::abs(normal);
+
+    if (a.x >= a.y && a.x >= a.z)
+    {
+      return normal.x >= 0.0f ? 0 : 1;
+    }
+
+    if (a.y >= a.z)
+    {
+      return normal.y >= 0.0f ? 2 : 3;
+    }
+
+    return normal.z >= 0.0f ? 4 : 5;
+  }
+}
+
+lpe::rendering::Vertex::Vertex(glm::vec3 position,
+                               glm::vec3 normal,
+                               glm::vec3 color)
+  : Position(position),
+    Normal(normal),
+    Color(color)
+{
+}
+
+bool lpe::rendering::Vertex::operator==(const Vertex& other) const
+{
+  return Position == other.Position &&
+         Normal == other.Normal &&
+         Color == other.Color;
+}
+
+bool lpe::rendering::Vertex::operator!=(const Vertex& other) const
+{
+  return !this->operator==(other);
+}
+
+lpe::rendering::Bounds::Bounds()
+  : Min(std::numeric_limits<float>::max()),
+    Max(std::numeric_limits<float>::lowest())
+{
+}
+
+lpe::rendering::Bounds::Bounds(glm::vec3 min,
+                               glm::vec3 max)
+  : Min(min),
+    Max(max)
+{
+}
+
+void lpe::rendering::Bounds::Extend(glm::vec3 point)
+{
+  Min = glm::min(Min, point);
+  Max = glm::max(Max, point);
+}
+
+void lpe::rendering::Bounds::Extend(const Bounds& other)
+{
+  if (other.IsEmpty())
+  {
+    return;
+  }
+
+  Min = glm::min(Min, other.Min);
+  Max = glm::max(Max, other.Max);
+}
+
+glm::vec3 lpe::rendering::Bounds::GetCenter() const
+{
+  return (Min + Max) * 0.5f;
+}
+
+glm::vec3 lpe::rendering::Bounds::GetExtent() const
+{
+  return (Max - Min) * 0.5f;
+}
+
+bool lpe::rendering::Bounds::IsEmpty() const
+{
+  return Min.x > Max.x || Min.y > Max.y || Min.z > Max.z;
+}
+
+bool lpe::rendering::Mesh::Load(const std::weak_ptr<lpe::utils::Resource>& resource)
+{
+  auto ptr = resource.lock();
+  if (!ptr)
+  {
+    return false;
+  }
+
+  const uint8_t* data;
+  uint64_t size = ptr->GetData(&data);
+
+  return Load(data, size);
+}
+
+bool lpe::rendering::Mesh::Load(const uint8_t* data,
+                                uint64_t size)
+{
+  Clear();
+
+  std::istringstream stream(std::string(reinterpret_cast<const char*>(data), size));
+  std::string line;
+  std::string token;
+
+  std::getline(stream, line);
+  if (line.compare(0, 3, "ply") != 0)
+  {
+    Log("Mesh is no PLY file.");
+    return false;
+  }
+
+  std::vector<PlyElement> elements;
+
+  while (std::getline(stream, line))
+  {
+    std::istringstream header(line);
+    header >> token;
+
+    if (token == "format")
+    {
+      header >> token;
+      if (token != "ascii")
+      {
+        Log("Only ascii PLY files are supported.");
+        return false;
+      }
+    }
+    else if (token == "element")
+    {
+      PlyElement element = {};
+      header >> element.Name >> element.Count;
+      element.IsList = false;
+      elements.push_back(element);
+    }
+    else if (token == "property" && !elements.empty())
+    {
+      std::string type;
+      header >> type;
+
+      if (type == "list")
+      {
+        std::string countType, indexType;
+        header >> countType >> indexType;
+        elements.back().IsList = true;
+      }
+
+      header >> token;
+      elements.back().Properties.push_back(token);
+    }
+    else if (token == "end_header")
+    {
+      break;
+    }
+  }
+
+  for (auto&& element : elements)
+  {
+    if (element.Name == "vertex")
+    {
+      int32_t x = FindProperty(element, "x");
+      int32_t y = FindProperty(element, "y");
+      int32_t z = FindProperty(element, "z");
+      int32_t nx = FindProperty(element, "nx");
+      int32_t ny = FindProperty(element, "ny");
+      int32_t nz = FindProperty(element, "nz");
+      int32_t r = FindProperty(element, "red");
+      int32_t g = FindProperty(element, "green");
+      int32_t b = FindProperty(element, "blue");
+
+      if (x < 0 || y < 0 || z < 0)
+      {
+        Log("PLY vertex element has no position.");
+        return false;
+      }
+
+      std::vector<float> values(element.Properties.size());
+      vertices.reserve(element.Count);
+
+      for (uint64_t i = 0; i < element.Count; ++i)
+      {
+        for (auto&& value : values)
+        {
+          stream >> value;
+        }
+
+        Vertex vertex = {};
+        vertex.Position = { values[x], values[y], values[z] };
+        vertex.Normal = nx >= 0 && ny >= 0 && nz >= 0 ?
+                        glm::vec3(values[nx], values[ny], values[nz]) :
+                        glm::vec3(0.0f);
+        vertex.Color = r >= 0 && g >= 0 && b >= 0 ?
+                       glm::vec3(values[r] / 255.0f, values[g] / 255.0f, values[b] / 255.0f) :
+                       glm::vec3(1.0f);
+
+        vertices.push_back(vertex);
+      }
+    }
+    else if (element.Name == "face" && element.IsList)
+    {
+      std::vector<uint32_t> polygon;
+      indices.reserve(element.Count * 3);
+
+      for (uint64_t i = 0; i < element.Count; ++i)
+      {
+        uint32_t count = 0;
+        stream >> count;
+
+        polygon.resize(count);
+        for (auto&& index : polygon)
+        {
+          stream >> index;
+        }
+
+        for (uint32_t corner = 2; corner < count; ++corner)
+        {
+          indices.push_back(polygon[0]);
+          indices.push_back(polygon[corner - 1]);
+          indices.push_back(polygon[corner]);
+        }
+      }
+    }
+    else
+    {
+      for (uint64_t i = 0; i < element.Count; ++i)
+      {
+        std::getline(stream >> std::ws, line);
+      }
+    }
+
+    if (stream.fail())
+    {
+      Log("PLY file is truncated.");
+      Clear();
+      return false;
+    }
+  }
+
+  for (auto&& index : indices)
+  {
+    if (index >= vertices.size())
+    {
+      Log("PLY face references a missing vertex.");
+      Clear();
+      return false;
+    }
+  }
+
+  // Blender duplicates vertices per face, exact welding is lossless
+  Weld();
+  ComputeBounds();
+
+  return true;
+}
+
+void lpe::rendering::Mesh::SetVertices(std::vector<Vertex>&& vertices)
+{
+  this->vertices = std::move(vertices);
+}
+
+void lpe::rendering::Mesh::SetVertices(const std::vector<Vertex>& vertices)
+{
+  this->vertices = vertices;
+}
+
+void lpe::rendering::Mesh::SetIndices(std::vector<uint32_t>&& indices)
+{
+  this->indices = std::move(indices);
+}
+
+void lpe::rendering::Mesh::SetIndices(const std::vector<uint32_t>& indices)
+{
+  this->indices = indices;
+}
+
+const std::vector<lpe::rendering::Vertex>& lpe::rendering::Mesh::GetVertices() const
+{
+  return vertices;
+}
+
+const std::vector<uint32_t>& lpe::rendering::Mesh::GetIndices() const
+{
+  return indices;
+}
+
+void lpe::rendering::Mesh::Append(const Mesh& other,
+                                  const glm::mat4& transform)
+{
+  auto base = static_cast<uint32_t>(vertices.size());
+  glm::mat3 normalMatrix = glm::transpose(glm::inverse(glm::mat3(transform)));
+
+  vertices.reserve(vertices.size() + other.vertices.size());
+  indices.reserve(indices.size() + other.indices.size());
+
+  for (auto&& vertex : other.vertices)
+  {
+    glm::vec4 position = transform * glm::vec4(vertex.Position, 1.0f);
+    glm::vec3 normal = normalMatrix * vertex.Normal;
+
+    vertices.emplace_back(glm::vec3(position.x, position.y, position.z),
+                          glm::length(normal) > 0.0f ? glm::normalize(normal) : normal,
+                          vertex.Color);
+
+    bounds.Extend(vertices.back().Position);
+  }
+
+  for (auto&& index : other.indices)
+  {
+    indices.push_back(base + index);
+  }
+}
+
+uint32_t lpe::rendering::Mesh::AddPolygon(const std::vector<Vertex>& polygon,
+                                          const std::vector<uint32_t>& holes)
+{
+  auto base = static_cast<uint32_t>(vertices.size());
+  std::vector<glm::vec3> points;
+  points.reserve(polygon.size());
+
+  for (auto&& vertex : polygon)
+  {
+    points.push_back(vertex.Position);
+  }
+
+  Triangulator triangulator;
+  uint32_t count = triangulator.Triangulate(points, holes, indices, base);
+
+  if (count > 0)
+  {
+    vertices.insert(std::end(vertices), std::begin(polygon), std::end(polygon));
+
+    for (auto&& vertex : polygon)
+    {
+      bounds.Extend(vertex.Position);
+    }
+  }
+
+  return count / 3;
+}
+
+uint32_t lpe::rendering::Mesh::Weld(float epsilon)
+{
+  if (indices.empty())
+  {
+    indices.resize(vertices.size() - vertices.size() % 3);
+    std::iota(std::begin(indices), std::end(indices), 0);
+  }
+
+  std::vector<Vertex> welded;
+  std::vector<uint32_t> remap(vertices.size());
+  welded.reserve(vertices.size());
+
+  if (epsilon <= 0.0f)
+  {
+    std::unordered_map<Vertex, uint32_t> unique;
+    unique.reserve(vertices.size());
+
+    for (size_t i = 0; i < vertices.size(); ++i)
+    {
+      auto result = unique.emplace(vertices[i], static_cast<uint32_t>(welded.size()));
+      if (result.second)
+      {
+        welded.push_back(vertices[i]);
+      }
+
+      remap[i] = result.first->second;
+    }
+  }
+  else
+  {
+    // cells are epsilon wide, so every candidate lies in the surrounding 27 cells
+    std::unordered_multimap<uint64_t, uint32_t> cells;
+    cells.reserve(vertices.size());
+
+    for (size_t i = 0; i < vertices.size(); ++i)
+    {
+      const Vertex& vertex = vertices[i];
+      glm::vec3 cell = glm::floor(vertex.Position / epsilon);
+      auto x = static_cast<int64_t>(cell.x);
+      auto y = static_cast<int64_t>(cell.y);
+      auto z = static_cast<int64_t>(cell.z);
+
+      uint32_t match = std::numeric_limits<uint32_t>::max();
+
+      for (int64_t dx = -1; dx <= 1 && match == std::numeric_limits<uint32_t>::max(); ++dx)
+      {
+        for (int64_t dy = -1; dy <= 1 && match == std::numeric_limits<uint32_t>::max(); ++dy)
+        {
+          for (int64_t dz = -1; dz <= 1 && match == std::numeric_limits<uint32_t>::max(); ++dz)
+          {
+            auto range = cells.equal_range(PackCell(x + dx, y + dy, z + dz));
+            for (auto iter = range.first; iter != range.second; ++iter)
+            {
+              const Vertex& candidate = welded[iter->second];
+
+              if (IsNear(candidate.Position, vertex.Position, epsilon) &&
+                  IsNear(candidate.Normal, vertex.Normal, epsilon) &&
+                  IsNear(candidate.Color, vertex.Color, epsilon))
+              {
+                match = iter->second;
+                break;
+              }
+            }
+          }
+        }
+      }
+
+      if (match == std::numeric_limits<uint32_t>::max())
+      {
+        match = static_cast<uint32_t>(welded.size());
+        welded.push_back(vertex);
+        cells.emplace(PackCell(x, y, z), match);
+      }
+
+      remap[i] = match;
+    }
+  }
+
+  for (auto&& index : indices)
+  {
+    index = remap[index];
+  }
+
+  if (epsilon > 0.0f)
+  {
+    // welding within a tolerance can collapse small triangles
+    size_t count = 0;
+    for (size_t i = 0; i + 2 < indices.size(); i += 3)
+    {
+      uint32_t a = indices[i];
+      uint32_t b = indices[i + 1];
+      uint32_t c = indices[i + 2];
+
+      if (a != b && b != c && a != c)
+      {
+        indices[count++] = a;
+        indices[count++] = b;
+        indices[count++] = c;
+      }
+    }
+
+    indices.resize(count);
+  }
+
+  auto removed = static_cast<uint32_t>(vertices.size() - welded.size());
+  vertices = std::move(welded);
+
+  return removed;
+}
+
+void lpe::rendering::Mesh::Optimize(uint32_t cacheSize)
+{
+  const auto vertexCount = static_cast<uint32_t>(vertices.size());
+  const auto triangleCount = static_cast<uint32_t>(indices.size() / 3);
+
+  if (triangleCount == 0)
+  {
+    return;
+  }
+
+  // vertex -> triangle adjacency as one flat list
+  std::vector<uint32_t> live(vertexCount, 0);
+  std::vector<uint32_t> offsets(vertexCount + 1, 0);
+  std::vector<uint32_t> adjacency(triangleCount * 3);
+
+  for (uint32_t i = 0; i < triangleCount * 3; ++i)
+  {
+    live[indices[i]]++;
+  }
+
+  for (uint32_t v = 0; v < vertexCount; ++v)
+  {
+    offsets[v + 1] = offsets[v] + live[v];
+  }
+
+  {
+    std::vector<uint32_t> fill(std::begin(offsets), std::end(offsets) - 1);
+    for (uint32_t i = 0; i < triangleCount * 3; ++i)
+    {
+      adjacency[fill[indices[i]]++] = i / 3;
+    }
+  }
+
+  std::vector<uint32_t> cache(vertexCount, 0);
+  std::vector<bool> emitted(triangleCount, false);
+  std::vector<uint32_t> deadEnds;
+  std::vector<uint32_t> candidates;
+  std::vector<uint32_t> output;
+  output.reserve(triangleCount * 3);
+
+  uint32_t time = cacheSize + 1;
+  uint32_t cursor = 0;
+  int64_t fanning = indices[0];
+
+  while (fanning >= 0)
+  {
+    candidates.clear();
+
+    for (uint32_t a = offsets[fanning]; a < offsets[fanning + 1]; ++a)
+    {
+      uint32_t triangle = adjacency[a];
+      if (emitted[triangle])
+      {
+        continue;
+      }
+
+      for (uint32_t corner = 0; corner < 3; ++corner)
+      {
+        uint32_t v = indices[triangle * 3 + corner];
+
+        output.push_back(v);
+        deadEnds.push_back(v);
+        candidates.push_back(v);
+        live[v]--;
+
+        if (time - cache[v] > cacheSize)
+        {
+          cache[v] = time++;
+        }
+      }
+
+      emitted[triangle] = true;
+    }
+
+    // next fanning vertex: the candidate which stays longest in the cache
+    int64_t next = -1;
+    uint32_t best = 0;
+    for (auto&& v : candidates)
+    {
+      if (live[v] == 0)
+      {
+        continue;
+      }
+
+      uint32_t priority = 0;
+      if (time - cache[v] + 2 * live[v] <= cacheSize)
+      {
+        priority = time - cache[v];
+      }
+
+      if (next < 0 || priority > best)
+      {
+        best = priority;
+        next = v;
+      }
+    }
+
+    while (next < 0 && !deadEnds.empty())
+    {
+      uint32_t v = deadEnds.back();
+      deadEnds.pop_back();
+
+      if (live[v] > 0)
+      {
+        next = v;
+      }
+    }
+
+    while (next < 0 && cursor < vertexCount)
+    {
+      if (live[cursor] > 0)
+      {
+        next = cursor;
+      }
+
+      cursor++;
+    }
+
+    fanning = next;
+  }
+
+  // vertices in order of first use
+  const uint32_t unused = std::numeric_limits<uint32_t>::max();
+  std::vector<uint32_t> remap(vertexCount, unused);
+  std::vector<Vertex> ordered;
+  ordered.reserve(vertexCount);
+
+  for (auto&& index : output)
+  {
+    if (remap[index] == unused)
+    {
+      remap[index] = static_cast<uint32_t>(ordered.size());
+      ordered.push_back(vertices[index]);
+    }
+
+    index = remap[index];
+  }
+
+  for (uint32_t v = 0; v < vertexCount; ++v)
+  {
+    if (remap[v] == unused)
+    {
+      ordered.push_back(vertices[v]);
+    }
+  }
+
+  vertices = std::move(ordered);
+  indices = std::move(output);
+}
+
+lpe::rendering::Mesh lpe::rendering::Mesh::Simplify(uint32_t resolution) const
+{
+  assert(resolution > 0 && resolution < (1u << 20u));
+
+  Mesh result;
+  if (vertices.empty() || bounds.IsEmpty())
+  {
+    return result;
+  }
+
+  glm::vec3 size = bounds.Max - bounds.Min;
+  float cellSize = std::max(size.x, std::max(size.y, size.z)) / static_cast<float>(resolution);
+  if (cellSize <= 0.0f)
+  {
+    return *this;
+  }
+
+  struct Cluster
+  {
+    glm::vec3 Position;
+    glm::vec3 Normal;
+    glm::vec3 Color;
+    float Count;
+  };
+
+  std::unordered_map<uint64_t, uint32_t> lookup;
+  std::vector<Cluster> clusters;
+  std::vector<uint32_t> remap(vertices.size());
+
+  for (size_t i = 0; i < vertices.size(); ++i)
+  {
+    const Vertex& vertex = vertices[i];
+    glm::vec3 cell = glm::min(glm::floor((vertex.Position - bounds.Min) / cellSize),
+                              glm::vec3(static_cast<float>(resolution - 1)));
+
+    uint64_t key = (GetMajorDirection(vertex.Normal) << 60) |
+                   (static_cast<uint64_t>(cell.x) << 40) |
+                   (static_cast<uint64_t>(cell.y) << 20) |
+                   static_cast<uint64_t>(cell.z);
+
+    auto found = lookup.emplace(key, static_cast<uint32_t>(clusters.size()));
+    if (found.second)
+    {
+      clusters.push_back({ glm::vec3(0.0f), glm::vec3(0.0f), glm::vec3(0.0f), 0.0f });
+    }
+
+    Cluster& cluster = clusters[found.first->second];
+    cluster.Position += vertex.Position;
+    cluster.Normal += vertex.Normal;
+    cluster.Color += vertex.Color;
+    cluster.Count += 1.0f;
+
+    remap[i] = found.first->second;
+  }
+
+  std::vector<Vertex> clustered;
+  clustered.reserve(clusters.size());
+
+  for (auto&& cluster : clusters)
+  {
+    float length = glm::length(cluster.Normal);
+
+    clustered.emplace_back(cluster.Position / cluster.Count,
+                           length > 0.0f ? cluster.Normal / length : cluster.Normal,
+                           cluster.Color / cluster.Count);
+  }
+
+  std::vector<uint32_t> clusteredIndices;
+  std::set<std::tuple<uint32_t, uint32_t, uint32_t>> unique;
+
+  for (size_t i = 0; i + 2 < indices.size(); i += 3)
+  {
+    uint32_t a = remap[indices[i]];
+    uint32_t b = remap[indices[i + 1]];
+    uint32_t c = remap[indices[i + 2]];
+
+    if (a == b || b == c || a == c)
+    {
+      continue;
+    }
+
+    // rotate smallest index first (keeps the winding) to find duplicated triangles
+    while (a > b || a > c)
+    {
+      uint32_t t = a;
+      a = b;
+      b = c;
+      c = t;
+    }
+
+    if (unique.emplace(a, b, c).second)
+    {
+      clusteredIndices.push_back(a);
+      clusteredIndices.push_back(b);
+      clusteredIndices.push_back(c);
+    }
+  }
+
+  result.SetVertices(std::move(clustered));
+  result.SetIndices(std::move(clusteredIndices));
+  result.ComputeBounds();
+
+  return result;
+}
+
+void lpe::rendering::Mesh::Clear()
+{
+  vertices.clear();
+  indices.clear();
+  bounds = {};
+}
+
+const lpe::rendering::Bounds& lpe::rendering::Mesh::ComputeBounds()
+{
+  bounds = {};
+
+  for (auto&& vertex : vertices)
+  {
+    bounds.Extend(vertex.Position);
+  }
+
+  return bounds;
+}
+
+const lpe::rendering::Bounds& lpe::rendering::Mesh::GetBounds() const
+{
+  return bounds;
+}
+
+size_t std::hash<lpe::rendering::Vertex>::operator()(const lpe::rendering::Vertex& vertex) const
+{
+  size_t seed = 0;
+
+  HashCombine(seed, vertex.Position.x);
+  HashCombine(seed, vertex.Position.y);
+  HashCombine(seed, vertex.Position.z);
+  HashCombine(seed, vertex.Normal.x);
+  HashCombine(seed, vertex.Normal.y);
+  HashCombine(seed, vertex.Normal.z);
+  HashCombine(seed, vertex.Color.x);
+  HashCombine(seed, vertex.Color.y);
+  HashCombine(seed, vertex.Color.z);
+
+  return seed;
+}
@@ -0,0 +1,129 @@
+#pragma once
+
+#include "Resource.h"
+#include <glm/glm.hpp>
+#include <functional>
+#include <vector>
+
+namespace lpe
+{
+  namespace rendering
+  {
+    /**
+     * \brief Vertex layout used by assets/shaders/base.vert (location 0 - 2)
+     */
+    struct Vertex
+    {
+      glm::vec3 Position;
+      glm::vec3 Normal;
+      glm::vec3 Color;
+
+      Vertex() = default;
+      Vertex(glm::vec3 position,
+             glm::vec3 normal,
+             glm::vec3 color);
+
+      bool operator==(const Vertex& other) const;
+      bool operator!=(const Vertex& other) const;
+    };
+
+    struct Bounds
+    {
+      glm::vec3 Min;
+      glm::vec3 Max;
+
+      /**
+       * \brief Creates empty (inverted) bounds. Extend them to make them valid.
+       */
+      Bounds();
+      Bounds(glm::vec3 min,
+             glm::vec3 max);
+
+      void Extend(glm::vec3 point);
+      void Extend(const Bounds& other);
+
+      glm::vec3 GetCenter() const;
+      glm::vec3 GetExtent() const;
+      bool IsEmpty() const;
+    };
+
+    class Mesh
+    {
+    private:
+      std::vector<Vertex> vertices;
+      std::vector<uint32_t> indices;
+      Bounds bounds;
+    public:
+      Mesh() = default;
+      Mesh(const Mesh& other) = default;
+      Mesh(Mesh&& other) noexcept = default;
+      Mesh& operator=(const Mesh& other) = default;
+      Mesh& operator=(Mesh&& other) noexcept = default;
+      ~Mesh() = default;
+
+      /**
+       * \brief Parses an ascii PLY file (as exported by Blender) into triangles.
+       * Polygons with more than 3 vertices get fanned, identical vertices get welded.
+       * \return false if the resource is gone or the data is no valid PLY
+       */
+      bool Load(const std::weak_ptr<lpe::utils::Resource>& resource);
+      bool Load(const uint8_t* data,
+                uint64_t size);
+
+      void SetVertices(std::vector<Vertex>&& vertices);
+      void SetVertices(const std::vector<Vertex>& vertices);
+      void SetIndices(std::vector<uint32_t>&& indices);
+      void SetIndices(const std::vector<uint32_t>& indices);
+
+      const std::vector<Vertex>& GetVertices() const;
+      const std::vector<uint32_t>& GetIndices() const;
+
+      /**
+       * \brief Appends the geometry of other transformed by transform. Indices get rebased.
+       */
+      void Append(const Mesh& other,
+                  const glm::mat4& transform);
+
+      /**
+       * \brief Appends a planar polygon (outer ring followed by its holes, see Triangulator) and triangulates it
+       * \return number of added triangles
+       */
+      uint32_t AddPolygon(const std::vector<Vertex>& polygon,
+                          const std::vector<uint32_t>& holes = {});
+
+      /**
+       * \brief Merges vertices whose attributes differ by at most epsilon (exact match for 0) and
+       * rebuilds the index buffer. Meshes without indices are treated as triangle soup.
+       * \return number of removed vertices
+       */
+      uint32_t Weld(float epsilon = 0.0f);
+
+      /**
+       * \brief Reorders triangles for the post-transform vertex cache (Tipsify, Sander et al. 2007)
+       * and renumbers vertices in first-use order afterwards so vertex fetches stay linear.
+       */
+      void Optimize(uint32_t cacheSize = 16);
+
+      /**
+       * \brief Creates a coarser version by vertex clustering on a uniform grid with resolution cells along
+       * the longest axis. Vertices only merge if their normals point into the same major direction so hard
+       * edges of low poly models survive.
+       */
+      Mesh Simplify(uint32_t resolution) const;
+
+      void Clear();
+
+      const Bounds& ComputeBounds();
+      const Bounds& GetBounds() const;
+    };
+  }
+}
+
+namespace std
+{
+  template<>
+  struct hash<lpe::rendering::Vertex>
+  {
+    size_t operator()(const lpe::rendering::Vertex& vertex) const;
+  };
+}
@@ -0,0 +1,146 @@
+#include "MeshImporter.h"
+#include "Resource.h"
+
+lpe::rendering::MeshImporter::MeshImporter()
+{
+  this->pending = 0;
+  this->weldEpsilon = 0.0f;
+  this->optimize = true;
+}
+
+lpe::rendering::MeshImporter::~MeshImporter()
+{
+  // workers use the members below, join them before those get destroyed
+  pool.Stop();
+}
+
+lpe::rendering::MeshImporter& lpe::rendering::MeshImporter::SetWeldEpsilon(float epsilon)
+{
+  this->weldEpsilon = epsilon;
+  return *this;
+}
+
+lpe::rendering::MeshImporter& lpe::rendering::MeshImporter::SetOptimize(bool optimize)
+{
+  this->optimize = optimize;
+  return *this;
+}
+
+void lpe::rendering::MeshImporter::Start(uint32_t threadCount)
+{
+  pool.Start(threadCount);
+}
+
+void lpe::rendering::MeshImporter::Stop()
+{
+  pool.Stop();
+}
+
+void lpe::rendering::MeshImporter::ImportFile(const std::string& path)
+{
+  MeshImport result = {};
+  result.Path = path;
+
+  // own Resource per job: the ResourceManager is not thread safe
+  lpe::utils::Resource resource;
+  resource.Load(path.c_str());
+
+  const uint8_t* data;
+  uint64_t size = resource.GetData(&data);
+
+  result.Loaded = size > 0 && result.Geometry.Load(data, size);
+
+  if (result.Loaded)
+  {
+    if (weldEpsilon > 0.0f)
+    {
+      result.Geometry.Weld(weldEpsilon);
+    }
+
+    if (optimize)
+    {
+      result.Geometry.Optimize();
+    }
+
+    result.Geometry.ComputeBounds();
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    results.push_back(std::move(result));
+  }
+
+  completed.notify_all();
+}
+
+void lpe::rendering::MeshImporter::Import(const std::vector<std::string>& paths)
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    pending += static_cast<uint32_t>(paths.size());
+  }
+
+  for (auto&& path : paths)
+  {
+    pool.Submit([this, path]()
+                {
+                  ImportFile(path);
+                });
+  }
+}
+
+bool lpe::rendering::MeshImporter::Poll(MeshImport& result)
+{
+  std::lock_guard<std::mutex> lock(mutex);
+
+  if (results.empty())
+  {
+    return false;
+  }
+
+  result = std::move(results.front());
+  results.pop_front();
+  pending--;
+
+  return true;
+}
+
+bool lpe::rendering::MeshImporter::WaitNext(MeshImport& result)
+{
+  std::unique_lock<std::mutex> lock(mutex);
+
+  if (pending == 0)
+  {
+    return false;
+  }
+
+  completed.wait(lock,
+                 [this]()
+                 {
+                   return !results.empty();
+                 });
+
+  result = std::move(results.front());
+  results.pop_front();
+  pending--;
+
+  return true;
+}
+
+void lpe::rendering::MeshImporter::ImportAll(const std::vector<std::string>& paths,
+                                             const std::function<void(MeshImport&&)>& uploader)
+{
+  Import(paths);
+
+  MeshImport result;
+  while (WaitNext(result))
+  {
+    uploader(std::move(result));
+  }
+}
+
+uint32_t lpe::rendering::MeshImporter::GetPending()
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  return pending;
+}
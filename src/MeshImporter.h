@@ -0,0 +1,75 @@
+#pragma once
+
+#include "Mesh.h"
+#include "ThreadPool.h"
+
+#include <string>
+
+namespace lpe
+{
+  namespace rendering
+  {
+    struct MeshImport
+    {
+      std::string Path;
+      Mesh Geometry;
+      bool Loaded;
+    };
+
+    /**
+     * \brief Imports many mesh files at once. Reading, parsing, welding, optimizing and bounds
+     * computation run on a worker pool, finished meshes are handed out in completion order.
+     */
+    class MeshImporter
+    {
+    private:
+      lpe::utils::ThreadPool pool;
+      std::mutex mutex;
+      std::condition_variable completed;
+      std::deque<MeshImport> results;
+      uint32_t pending;
+      float weldEpsilon;
+      bool optimize;
+
+      void ImportFile(const std::string& path);
+    public:
+      MeshImporter();
+      MeshImporter(const MeshImporter& other) = delete;
+      MeshImporter(MeshImporter&& other) noexcept = delete;
+      MeshImporter& operator=(const MeshImporter& other) = delete;
+      MeshImporter& operator=(MeshImporter&& other) noexcept = delete;
+      ~MeshImporter();
+
+      /**
+       * \brief Weld tolerance applied after the lossless weld of the loader. 0 disables it.
+       */
+      MeshImporter& SetWeldEpsilon(float epsilon);
+      MeshImporter& SetOptimize(bool optimize);
+
+      void Start(uint32_t threadCount = 0);
+      void Stop();
+
+      void Import(const std::vector<std::string>& paths);
+
+      /**
+       * \brief Takes the next finished mesh without blocking
+       * \return false if no mesh is finished yet
+       */
+      bool Poll(MeshImport& result);
+
+      /**
+       * \brief Blocks until the next mesh is finished
+       * \return false if nothing is pending anymore
+       */
+      bool WaitNext(MeshImport& result);
+
+      /**
+       * \brief Imports all paths and calls uploader on the calling thread as soon as each mesh is finished
+       */
+      void ImportAll(const std::vector<std::string>& paths,
+                     const std::function<void(MeshImport&&)>& uploader);
+
+      uint32_t GetPending();
+    };
+  }
+}
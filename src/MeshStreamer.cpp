@@ -0,0 +1,220 @@
+#include "MeshStreamer.h"
+#include "ServiceLocator.h"
+
+#include <cstring>
+#include <fstream>
+
+lpe::rendering::MeshStreamer::MeshStreamer()
+{
+  this->bandwidth = 4 * 1024 * 1024;
+  this->nextHandle = 1;
+}
+
+lpe::rendering::MeshStreamer::~MeshStreamer()
+{
+  pool.Stop();
+}
+
+void lpe::rendering::MeshStreamer::Start(uint32_t threadCount)
+{
+  pool.Start(threadCount);
+}
+
+void lpe::rendering::MeshStreamer::Stop()
+{
+  pool.Stop();
+}
+
+lpe::rendering::MeshStreamer& lpe::rendering::MeshStreamer::SetBandwidth(uint64_t bytesPerUpdate)
+{
+  this->bandwidth = bytesPerUpdate;
+  return *this;
+}
+
+uint32_t lpe::rendering::MeshStreamer::Open(const std::string& path,
+                                            Bounds* bounds)
+{
+  std::ifstream ifs(path,
+                    std::ios::binary | std::ios::ate);
+
+  uint64_t fileSize = ifs ? static_cast<uint64_t>(ifs.tellg()) : 0;
+  ifs.seekg(0);
+
+  CookedMeshHeader header = {};
+  ifs.read(reinterpret_cast<char*>(&header), sizeof(header));
+
+  // the counts and offsets come from the file, a truncated or corrupt one mustn't make us allocate gigabytes
+  bool valid = ifs &&
+               header.Magic == CookedMeshMagic &&
+               header.Version == CookedMeshVersion &&
+               header.LodCount <= (fileSize - sizeof(header)) / sizeof(CookedMeshLod);
+
+  Stream stream = {};
+  stream.Path = path;
+
+  if (valid)
+  {
+    std::vector<uint8_t> data(sizeof(header) + header.LodCount * sizeof(CookedMeshLod));
+    memcpy(data.data(), &header, sizeof(header));
+    ifs.read(reinterpret_cast<char*>(data.data() + sizeof(header)), data.size() - sizeof(header));
+
+    valid = ifs && ReadCookedMeshHeader(data.data(), data.size(), header, stream.Lods) && !stream.Lods.empty();
+  }
+
+  for (auto&& lod : stream.Lods)
+  {
+    valid = valid && lod.Offset <= fileSize && lod.GetSize() <= fileSize - lod.Offset;
+  }
+
+  if (!valid)
+  {
+    auto manager = ServiceLocator::LogManager.Get()
+                                             .lock();
+    if (manager)
+    {
+      manager->Log("Could not open cooked mesh " + path);
+    }
+
+    return 0;
+  }
+
+  if (bounds)
+  {
+    *bounds = {
+      { header.BoundsMin[0], header.BoundsMin[1], header.BoundsMin[2] },
+      { header.BoundsMax[0], header.BoundsMax[1], header.BoundsMax[2] }
+    };
+  }
+
+  std::lock_guard<std::mutex> lock(mutex);
+
+  uint32_t handle = nextHandle++;
+  auto& inserted = streams.emplace(handle, std::move(stream)).first->second;
+
+  // coverage first: the coarsest LOD does not count against the bandwidth
+  Request(handle, inserted);
+
+  return handle;
+}
+
+void lpe::rendering::MeshStreamer::Close(uint32_t handle)
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  streams.erase(handle);
+}
+
+void lpe::rendering::MeshStreamer::Request(uint32_t handle,
+                                           Stream& stream)
+{
+  uint32_t index = stream.Requested++;
+  stream.Loading = true;
+
+  pool.Submit([this, handle, path = stream.Path, lod = stream.Lods[index], index, final = stream.Requested == stream.Lods.size()]()
+              {
+                LoadLod(handle, path, lod, index, final);
+              });
+}
+
+void lpe::rendering::MeshStreamer::LoadLod(uint32_t handle,
+                                           std::string path,
+                                           CookedMeshLod lod,
+                                           uint32_t index,
+                                           bool final)
+{
+  StreamedMesh result = {};
+  result.Handle = handle;
+  result.Lod = index;
+  result.Final = final;
+
+  std::vector<uint8_t> data(lod.GetSize());
+
+  std::ifstream ifs(path,
+                    std::ios::binary);
+  ifs.seekg(lod.Offset);
+  ifs.read(reinterpret_cast<char*>(data.data()), data.size());
+
+  bool loaded = ifs && ReadCookedMeshLod(data.data(), data.size(), lod, result.Geometry);
+
+  std::lock_guard<std::mutex> lock(mutex);
+
+  auto stream = streams.find(handle);
+  if (stream == std::end(streams))
+  {
+    return; // closed in the meantime
+  }
+
+  stream->second.Loading = false;
+
+  if (loaded)
+  {
+    completed.push_back(std::move(result));
+  }
+  else
+  {
+    // don't retry a broken file forever
+    stream->second.Requested = static_cast<uint32_t>(stream->second.Lods.size());
+  }
+}
+
+void lpe::rendering::MeshStreamer::Update()
+{
+  std::lock_guard<std::mutex> lock(mutex);
+
+  uint64_t budget = bandwidth;
+  bool scheduled = false;
+
+  while (true)
+  {
+    Stream* next = nullptr;
+    uint32_t handle = 0;
+
+    for (auto&& stream : streams)
+    {
+      Stream& candidate = stream.second;
+
+      if (candidate.Loading || candidate.Requested >= candidate.Lods.size())
+      {
+        continue;
+      }
+
+      if (!next || candidate.Requested < next->Requested)
+      {
+        next = &candidate;
+        handle = stream.first;
+      }
+    }
+
+    if (!next)
+    {
+      break;
+    }
+
+    uint64_t size = next->Lods[next->Requested].GetSize();
+
+    // a LOD larger than the whole budget still gets through if it is the only one this update
+    if (size > budget && scheduled)
+    {
+      break;
+    }
+
+    budget -= std::min(size, budget);
+    scheduled = true;
+
+    Request(handle, *next);
+  }
+}
+
+bool lpe::rendering::MeshStreamer::Poll(StreamedMesh& result)
+{
+  std::lock_guard<std::mutex> lock(mutex);
+
+  if (completed.empty())
+  {
+    return false;
+  }
+
+  result = std::move(completed.front());
+  completed.pop_front();
+
+  return true;
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "CookedMesh.h"
+#include "ThreadPool.h"
+
+#include <map>
+#include <string>
+
+namespace lpe
+{
+  namespace rendering
+  {
+    struct StreamedMesh
+    {
+      uint32_t Handle;
+      uint32_t Lod;     // 0 is the coarsest LOD
+      bool Final;       // true for the full detail LOD
+      Mesh Geometry;
+    };
+
+    /**
+     * \brief Streams cooked meshes coarsest LOD first.
+     * Open() schedules the coarsest LOD right away, Update() refines the meshes in the background
+     * within a byte budget per call. Refinements are spread breadth first, so every open mesh gets
+     * its next LOD before any mesh gets two.
+     */
+    class MeshStreamer
+    {
+    private:
+      struct Stream
+      {
+        std::string Path;
+        std::vector<CookedMeshLod> Lods;
+        uint32_t Requested;
+        bool Loading;
+      };
+
+      lpe::utils::ThreadPool pool;
+      std::mutex mutex;
+      std::map<uint32_t, Stream> streams;
+      std::deque<StreamedMesh> completed;
+      uint64_t bandwidth;
+      uint32_t nextHandle;
+
+      void Request(uint32_t handle,
+                   Stream& stream);
+      void LoadLod(uint32_t handle,
+                   std::string path,
+                   CookedMeshLod lod,
+                   uint32_t index,
+                   bool final);
+    public:
+      MeshStreamer();
+      MeshStreamer(const MeshStreamer& other) = delete;
+      MeshStreamer(MeshStreamer&& other) noexcept = delete;
+      MeshStreamer& operator=(const MeshStreamer& other) = delete;
+      MeshStreamer& operator=(MeshStreamer&& other) noexcept = delete;
+      ~MeshStreamer();
+
+      void Start(uint32_t threadCount = 1);
+      void Stop();
+
+      /**
+       * \brief Bytes which may be scheduled per Update() call
+       */
+      MeshStreamer& SetBandwidth(uint64_t bytesPerUpdate);
+
+      /**
+       * \brief Reads the LOD table of a cooked mesh and schedules its coarsest LOD
+       * \return handle of the stream, 0 if the file is no cooked mesh of this version or its LOD table
+       * points past the end of the file
+       */
+      uint32_t Open(const std::string& path,
+                    Bounds* bounds = nullptr);
+      void Close(uint32_t handle);
+
+      void Update();
+
+      /**
+       * \brief Takes the next loaded LOD (in completion order) which should be uploaded now
+       */
+      bool Poll(StreamedMesh& result);
+    };
+  }
+}
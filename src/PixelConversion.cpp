@@ -0,0 +1,624 @@
+#include "PixelConversion.h"
+
+#include <atomic>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define LPE_X86
+#include <immintrin.h>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define LPE_TARGET(x)
+#else
+#define LPE_TARGET(x) __attribute__((target(x)))
+#endif
+#endif
+
+namespace
+{
+  using lpe::rendering::SimdLevel;
+
+  std::atomic<SimdLevel>& GetLevel()
+  {
+    static std::atomic<SimdLevel> level(lpe::rendering::GetSupportedSimdLevel());
+
+    return level;
+  }
+
+  bool Uses(SimdLevel level)
+  {
+    return static_cast<uint32_t>(GetLevel().load(std::memory_order_relaxed)) >= static_cast<uint32_t>(level);
+  }
+
+  uint8_t GetLuma(const uint8_t* rgb)
+  {
+    return static_cast<uint8_t>((rgb[0] * 77 + rgb[1] * 150 + rgb[2] * 29) >> 8);
+  }
+
+  uint8_t Premultiply(uint32_t value,
+                      uint32_t alpha)
+  {
+    // exact round(value * alpha / 255) without a division
+    uint32_t t = value * alpha + 128;
+
+    return static_cast<uint8_t>((t + (t >> 8)) >> 8);
+  }
+
+  float DecodeSrgb(float value)
+  {
+    return value <= 0.04045f ?
+           value / 12.92f :
+           std::pow((value + 0.055f) / 1.055f, 2.4f);
+  }
+
+  float EncodeSrgb(float value)
+  {
+    return value <= 0.0031308f ?
+           value * 12.92f :
+           1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+  }
+
+  float Saturate(float value)
+  {
+    // NaN ends up as 0
+    return value > 0.0f ?
+           (value < 1.0f ? value : 1.0f) :
+           0.0f;
+  }
+
+  constexpr uint32_t EncodeTableSize = 4096;
+
+  struct SrgbTables
+  {
+    // 256 sRGB entries followed by 256 linear entries for alpha
+    alignas(32) float Decode[512];
+    uint8_t Encode[EncodeTableSize];
+
+    SrgbTables()
+    {
+      for (uint32_t i = 0; i < 256; ++i)
+      {
+        Decode[i] = DecodeSrgb(i / 255.0f);
+        Decode[256 + i] = i / 255.0f;
+      }
+
+      for (uint32_t i = 0; i < EncodeTableSize; ++i)
+      {
+        float value = EncodeSrgb(i / static_cast<float>(EncodeTableSize - 1));
+        Encode[i] = static_cast<uint8_t>(value * 255.0f + 0.5f);
+      }
+    }
+  };
+
+  const SrgbTables& GetSrgbTables()
+  {
+    static const SrgbTables tables;
+
+    return tables;
+  }
+
+#if defined(LPE_X86)
+  LPE_TARGET("ssse3")
+  size_t ExpandSSSE3(const uint8_t* src,
+                     uint8_t* dst,
+                     size_t count)
+  {
+    const __m128i shuffle = _mm_setr_epi8(0, 1, 2, -128, 3, 4, 5, -128, 6, 7, 8, -128, 9, 10, 11, -128);
+    const __m128i alpha = _mm_set1_epi32(static_cast<int>(0xFF000000));
+    size_t i = 0;
+
+    // every load reads 16 bytes but only uses 12, keep 2 pixels of slack
+    for (; i + 6 <= count; i += 4)
+    {
+      __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 3));
+
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4),
+                       _mm_or_si128(_mm_shuffle_epi8(pixels, shuffle), alpha));
+    }
+
+    return i;
+  }
+
+  LPE_TARGET("avx2")
+  size_t ExpandAVX2(const uint8_t* src,
+                    uint8_t* dst,
+                    size_t count)
+  {
+    const __m256i shuffle = _mm256_setr_epi8(0, 1, 2, -128, 3, 4, 5, -128, 6, 7, 8, -128, 9, 10, 11, -128,
+                                             0, 1, 2, -128, 3, 4, 5, -128, 6, 7, 8, -128, 9, 10, 11, -128);
+    const __m256i alpha = _mm256_set1_epi32(static_cast<int>(0xFF000000));
+    size_t i = 0;
+
+    for (; i + 10 <= count; i += 8)
+    {
+      __m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 3));
+      __m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 3 + 12));
+      __m256i pixels = _mm256_inserti128_si256(_mm256_castsi128_si256(low), high, 1);
+
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i * 4),
+                          _mm256_or_si256(_mm256_shuffle_epi8(pixels, shuffle), alpha));
+    }
+
+    return i;
+  }
+
+  LPE_TARGET("ssse3")
+  size_t SwizzleSSSE3(const uint8_t* src,
+                      uint8_t* dst,
+                      size_t count,
+                      const uint8_t order[4])
+  {
+    alignas(16) uint8_t mask[16];
+    for (uint32_t j = 0; j < 16; ++j)
+    {
+      mask[j] = static_cast<uint8_t>(j / 4 * 4 + order[j % 4]);
+    }
+
+    const __m128i shuffle = _mm_load_si128(reinterpret_cast<const __m128i*>(mask));
+    size_t i = 0;
+
+    for (; i + 4 <= count; i += 4)
+    {
+      __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4));
+
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4), _mm_shuffle_epi8(pixels, shuffle));
+    }
+
+    return i;
+  }
+
+  LPE_TARGET("avx2")
+  size_t SwizzleAVX2(const uint8_t* src,
+                     uint8_t* dst,
+                     size_t count,
+                     const uint8_t order[4])
+  {
+    alignas(32) uint8_t mask[32];
+    for (uint32_t j = 0; j < 32; ++j)
+    {
+      mask[j] = static_cast<uint8_t>(j % 16 / 4 * 4 + order[j % 4]);
+    }
+
+    const __m256i shuffle = _mm256_load_si256(reinterpret_cast<const __m256i*>(mask));
+    size_t i = 0;
+
+    for (; i + 8 <= count; i += 8)
+    {
+      __m256i pixels = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * 4));
+
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i * 4), _mm256_shuffle_epi8(pixels, shuffle));
+    }
+
+    return i;
+  }
+
+  LPE_TARGET("sse2")
+  size_t PremultiplySSE2(const uint8_t* src,
+                         uint8_t* dst,
+                         size_t count)
+  {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i round = _mm_set1_epi16(128);
+    const __m128i alphaMask = _mm_set1_epi32(static_cast<int>(0xFF000000));
+    size_t i = 0;
+
+    for (; i + 4 <= count; i += 4)
+    {
+      __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4));
+      __m128i low = _mm_unpacklo_epi8(pixels, zero);
+      __m128i high = _mm_unpackhi_epi8(pixels, zero);
+      __m128i lowAlpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(low, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+      __m128i highAlpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(high, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+
+      // same rounding as the scalar path, the sums stay below 2^16
+      low = _mm_add_epi16(_mm_mullo_epi16(low, lowAlpha), round);
+      high = _mm_add_epi16(_mm_mullo_epi16(high, highAlpha), round);
+      low = _mm_srli_epi16(_mm_add_epi16(low, _mm_srli_epi16(low, 8)), 8);
+      high = _mm_srli_epi16(_mm_add_epi16(high, _mm_srli_epi16(high, 8)), 8);
+
+      __m128i result = _mm_packus_epi16(low, high);
+      result = _mm_or_si128(_mm_andnot_si128(alphaMask, result), _mm_and_si128(alphaMask, pixels));
+
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4), result);
+    }
+
+    return i;
+  }
+
+  LPE_TARGET("avx2")
+  size_t PremultiplyAVX2(const uint8_t* src,
+                         uint8_t* dst,
+                         size_t count)
+  {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i round = _mm256_set1_epi16(128);
+    const __m256i alphaMask = _mm256_set1_epi32(static_cast<int>(0xFF000000));
+    size_t i = 0;
+
+    // unpack and pack both work per 128 bit lane, so the pixel order is kept
+    for (; i + 8 <= count; i += 8)
+    {
+      __m256i pixels = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * 4));
+      __m256i low = _mm256_unpacklo_epi8(pixels, zero);
+      __m256i high = _mm256_unpackhi_epi8(pixels, zero);
+      __m256i lowAlpha = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(low, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+      __m256i highAlpha = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(high, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+
+      low = _mm256_add_epi16(_mm256_mullo_epi16(low, lowAlpha), round);
+      high = _mm256_add_epi16(_mm256_mullo_epi16(high, highAlpha), round);
+      low = _mm256_srli_epi16(_mm256_add_epi16(low, _mm256_srli_epi16(low, 8)), 8);
+      high = _mm256_srli_epi16(_mm256_add_epi16(high, _mm256_srli_epi16(high, 8)), 8);
+
+      __m256i result = _mm256_packus_epi16(low, high);
+      result = _mm256_or_si256(_mm256_andnot_si256(alphaMask, result), _mm256_and_si256(alphaMask, pixels));
+
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i * 4), result);
+    }
+
+    return i;
+  }
+
+  LPE_TARGET("ssse3")
+  size_t PackNormalMapSSSE3(const uint8_t* src,
+                            uint8_t* dst,
+                            size_t count)
+  {
+    const __m128i shuffle = _mm_setr_epi8(0, 1, 4, 5, 8, 9, 12, 13, -128, -128, -128, -128, -128, -128, -128, -128);
+    size_t i = 0;
+
+    for (; i + 4 <= count; i += 4)
+    {
+      __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4));
+
+      _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + i * 2), _mm_shuffle_epi8(pixels, shuffle));
+    }
+
+    return i;
+  }
+
+  LPE_TARGET("avx2")
+  size_t PackNormalMapAVX2(const uint8_t* src,
+                           uint8_t* dst,
+                           size_t count)
+  {
+    const __m256i shuffle = _mm256_setr_epi8(0, 1, 4, 5, 8, 9, 12, 13, -128, -128, -128, -128, -128, -128, -128, -128,
+                                             0, 1, 4, 5, 8, 9, 12, 13, -128, -128, -128, -128, -128, -128, -128, -128);
+    size_t i = 0;
+
+    for (; i + 8 <= count; i += 8)
+    {
+      __m256i pixels = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * 4));
+      __m256i packed = _mm256_permute4x64_epi64(_mm256_shuffle_epi8(pixels, shuffle), _MM_SHUFFLE(3, 1, 2, 0));
+
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 2), _mm256_castsi256_si128(packed));
+    }
+
+    return i;
+  }
+
+  LPE_TARGET("avx2")
+  size_t SrgbToLinearAVX2(const uint8_t* src,
+                          float* dst,
+                          size_t count)
+  {
+    const float* table = GetSrgbTables().Decode;
+    const __m256i alphaOffset = _mm256_setr_epi32(0, 0, 0, 256, 0, 0, 0, 256);
+    size_t i = 0;
+
+    for (; i + 2 <= count; i += 2)
+    {
+      __m128i pixels = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + i * 4));
+      __m256i indices = _mm256_add_epi32(_mm256_cvtepu8_epi32(pixels), alphaOffset);
+
+      _mm256_storeu_ps(dst + i * 4, _mm256_i32gather_ps(table, indices, 4));
+    }
+
+    return i;
+  }
+
+  LPE_TARGET("sse2")
+  size_t LinearToSrgbSSE2(const float* src,
+                          uint8_t* dst,
+                          size_t count)
+  {
+    const uint8_t* table = GetSrgbTables().Encode;
+    const __m128 scale = _mm_setr_ps(EncodeTableSize - 1, EncodeTableSize - 1, EncodeTableSize - 1, 255.0f);
+    const __m128 half = _mm_set1_ps(0.5f);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    alignas(16) int32_t indices[4];
+    size_t i = 0;
+
+    // max returns its second operand for NaN, so NaN ends up as 0 like in Saturate
+    for (; i < count; ++i)
+    {
+      __m128 pixel = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + i * 4), zero), one);
+
+      _mm_store_si128(reinterpret_cast<__m128i*>(indices),
+                      _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(pixel, scale), half)));
+
+      dst[i * 4] = table[indices[0]];
+      dst[i * 4 + 1] = table[indices[1]];
+      dst[i * 4 + 2] = table[indices[2]];
+      dst[i * 4 + 3] = static_cast<uint8_t>(indices[3]);
+    }
+
+    return i;
+  }
+#endif
+}
+
+lpe::rendering::SimdLevel lpe::rendering::GetSupportedSimdLevel()
+{
+  static const SimdLevel supported = []()
+  {
+#if defined(LPE_X86)
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    int leafCount = info[0];
+
+    __cpuid(info, 1);
+    bool sse2 = (info[3] & (1 << 26)) != 0;
+    bool ssse3 = (info[2] & (1 << 9)) != 0;
+    bool avx = (info[2] & (1 << 27)) != 0 && // OSXSAVE
+               (info[2] & (1 << 28)) != 0 &&
+               (_xgetbv(0) & 6) == 6;         // OS saves the ymm registers
+
+    bool avx2 = false;
+    if (avx && leafCount >= 7)
+    {
+      __cpuidex(info, 7, 0);
+      avx2 = (info[1] & (1 << 5)) != 0;
+    }
+#else
+    __builtin_cpu_init();
+    bool sse2 = __builtin_cpu_supports("sse2");
+    bool ssse3 = __builtin_cpu_supports("ssse3");
+    bool avx2 = __builtin_cpu_supports("avx2");
+#endif
+
+    return avx2 ? SimdLevel::AVX2 :
+           ssse3 ? SimdLevel::SSSE3 :
+           sse2 ? SimdLevel::SSE2 :
+           SimdLevel::Scalar;
+#else
+    return SimdLevel::Scalar;
+#endif
+  }();
+
+  return supported;
+}
+
+void lpe::rendering::SetSimdLevel(SimdLevel level)
+{
+  auto supported = GetSupportedSimdLevel();
+
+  GetLevel().store(static_cast<uint32_t>(level) < static_cast<uint32_t>(supported) ? level : supported);
+}
+
+lpe::rendering::SimdLevel lpe::rendering::GetSimdLevel()
+{
+  return GetLevel().load();
+}
+
+void lpe::rendering::ConvertChannels(const uint8_t* src,
+                                     uint32_t srcChannels,
+                                     uint8_t* dst,
+                                     uint32_t dstChannels,
+                                     size_t count)
+{
+  assert(srcChannels >= 1 && srcChannels <= 4);
+  assert(dstChannels >= 1 && dstChannels <= 4);
+
+  if (srcChannels == dstChannels)
+  {
+    if (src != dst)
+    {
+      memcpy(dst, src, count * srcChannels);
+    }
+
+    return;
+  }
+
+  if (srcChannels == 3 && dstChannels == 4)
+  {
+    ExpandRGBToRGBA(src, dst, count);
+
+    return;
+  }
+
+  for (size_t i = 0; i < count; ++i)
+  {
+    const uint8_t* in = src + i * srcChannels;
+    uint8_t* out = dst + i * dstChannels;
+
+    uint8_t grey = srcChannels >= 3 ? GetLuma(in) : in[0];
+    uint8_t alpha = srcChannels == 2 ? in[1] :
+                    srcChannels == 4 ? in[3] :
+                    255;
+
+    if (dstChannels <= 2)
+    {
+      out[0] = grey;
+    }
+    else if (srcChannels >= 3)
+    {
+      out[0] = in[0];
+      out[1] = in[1];
+      out[2] = in[2];
+    }
+    else
+    {
+      out[0] = out[1] = out[2] = in[0];
+    }
+
+    if (dstChannels == 2 || dstChannels == 4)
+    {
+      out[dstChannels - 1] = alpha;
+    }
+  }
+}
+
+void lpe::rendering::ExpandRGBToRGBA(const uint8_t* src,
+                                     uint8_t* dst,
+                                     size_t count)
+{
+  size_t i = 0;
+
+#if defined(LPE_X86)
+  if (Uses(SimdLevel::AVX2))
+  {
+    i = ExpandAVX2(src, dst, count);
+  }
+  else if (Uses(SimdLevel::SSSE3))
+  {
+    i = ExpandSSSE3(src, dst, count);
+  }
+#endif
+
+  for (; i < count; ++i)
+  {
+    dst[i * 4] = src[i * 3];
+    dst[i * 4 + 1] = src[i * 3 + 1];
+    dst[i * 4 + 2] = src[i * 3 + 2];
+    dst[i * 4 + 3] = 255;
+  }
+}
+
+void lpe::rendering::SwizzleRGBA(const uint8_t* src,
+                                 uint8_t* dst,
+                                 size_t count,
+                                 const uint8_t order[4])
+{
+  assert(order[0] < 4 && order[1] < 4 && order[2] < 4 && order[3] < 4);
+
+  size_t i = 0;
+
+#if defined(LPE_X86)
+  if (Uses(SimdLevel::AVX2))
+  {
+    i = SwizzleAVX2(src, dst, count, order);
+  }
+  else if (Uses(SimdLevel::SSSE3))
+  {
+    i = SwizzleSSSE3(src, dst, count, order);
+  }
+#endif
+
+  for (; i < count; ++i)
+  {
+    uint8_t pixel[4];
+    memcpy(pixel, src + i * 4, 4);
+
+    dst[i * 4] = pixel[order[0]];
+    dst[i * 4 + 1] = pixel[order[1]];
+    dst[i * 4 + 2] = pixel[order[2]];
+    dst[i * 4 + 3] = pixel[order[3]];
+  }
+}
+
+void lpe::rendering::PremultiplyAlpha(const uint8_t* src,
+                                      uint8_t* dst,
+                                      size_t count)
+{
+  size_t i = 0;
+
+#if defined(LPE_X86)
+  if (Uses(SimdLevel::AVX2))
+  {
+    i = PremultiplyAVX2(src, dst, count);
+  }
+  else if (Uses(SimdLevel::SSE2))
+  {
+    i = PremultiplySSE2(src, dst, count);
+  }
+#endif
+
+  for (; i < count; ++i)
+  {
+    uint8_t alpha = src[i * 4 + 3];
+
+    dst[i * 4] = Premultiply(src[i * 4], alpha);
+    dst[i * 4 + 1] = Premultiply(src[i * 4 + 1], alpha);
+    dst[i * 4 + 2] = Premultiply(src[i * 4 + 2], alpha);
+    dst[i * 4 + 3] = alpha;
+  }
+}
+
+void lpe::rendering::PackNormalMap(const uint8_t* src,
+                                   uint8_t* dst,
+                                   size_t count)
+{
+  size_t i = 0;
+
+#if defined(LPE_X86)
+  if (Uses(SimdLevel::AVX2))
+  {
+    i = PackNormalMapAVX2(src, dst, count);
+  }
+  else if (Uses(SimdLevel::SSSE3))
+  {
+    i = PackNormalMapSSSE3(src, dst, count);
+  }
+#endif
+
+  for (; i < count; ++i)
+  {
+    dst[i * 2] = src[i * 4];
+    dst[i * 2 + 1] = src[i * 4 + 1];
+  }
+}
+
+void lpe::rendering::SrgbToLinear(const uint8_t* src,
+                                  float* dst,
+                                  size_t count)
+{
+  size_t i = 0;
+
+#if defined(LPE_X86)
+  if (Uses(SimdLevel::AVX2))
+  {
+    i = SrgbToLinearAVX2(src, dst, count);
+  }
+#endif
+
+  const float* table = GetSrgbTables().Decode;
+
+  for (; i < count; ++i)
+  {
+    dst[i * 4] = table[src[i * 4]];
+    dst[i * 4 + 1] = table[src[i * 4 + 1]];
+    dst[i * 4 + 2] = table[src[i * 4 + 2]];
+    dst[i * 4 + 3] = table[256 + src[i * 4 + 3]];
+  }
+}
+
+void lpe::rendering::LinearToSrgb(const float* src,
+                                  uint8_t* dst,
+                                  size_t count)
+{
+  size_t i = 0;
+
+#if defined(LPE_X86)
+  if (Uses(SimdLevel::SSE2))
+  {
+    i = LinearToSrgbSSE2(src, dst, count);
+  }
+#endif
+
+  const uint8_t* table = GetSrgbTables().Encode;
+
+  for (; i < count; ++i)
+  {
+    for (uint32_t c = 0; c < 3; ++c)
+    {
+      dst[i * 4 + c] = table[static_cast<uint32_t>(Saturate(src[i * 4 + c]) * (EncodeTableSize - 1) + 0.5f)];
+    }
+
+    dst[i * 4 + 3] = static_cast<uint8_t>(Saturate(src[i * 4 + 3]) * 255.0f + 0.5f);
+  }
+}
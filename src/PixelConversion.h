@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace lpe
+{
+  namespace rendering
+  {
+    /**
+     * \brief Instruction sets used by the pixel conversion kernels, ordered by width
+     */
+    enum class SimdLevel : uint32_t
+    {
+      Scalar,
+      SSE2,
+      SSSE3,
+      AVX2
+    };
+
+    /**
+     * \brief Best level supported by the CPU (and OS for AVX2)
+     */
+    SimdLevel GetSupportedSimdLevel();
+
+    /**
+     * \brief Level used by the kernels, defaults to the supported level. Mostly for benchmarks and tests,
+     * requests above the supported level get clamped.
+     */
+    void SetSimdLevel(SimdLevel level);
+    SimdLevel GetSimdLevel();
+
+    /**
+     * \brief Converts 8 bit pixels between 1 (grey), 2 (grey alpha), 3 (RGB) and 4 (RGBA) channels
+     * with the same rules as stb_image (luma = (77r + 150g + 29b) >> 8, missing alpha = 255).
+     * Lets textures be decoded with their own channel count instead of STBI_rgb_alpha.
+     */
+    void ConvertChannels(const uint8_t* src,
+                         uint32_t srcChannels,
+                         uint8_t* dst,
+                         uint32_t dstChannels,
+                         size_t count);
+
+    /**
+     * \brief RGB to RGBA with an opaque alpha channel
+     */
+    void ExpandRGBToRGBA(const uint8_t* src,
+                         uint8_t* dst,
+                         size_t count);
+
+    /**
+     * \brief Reorders the channels of RGBA pixels, dst[c] = src[order[c]] (e.g. { 2, 1, 0, 3 } for RGBA <-> BGRA).
+     * src and dst may be the same.
+     */
+    void SwizzleRGBA(const uint8_t* src,
+                     uint8_t* dst,
+                     size_t count,
+                     const uint8_t order[4]);
+
+    /**
+     * \brief rgb = round(rgb * a / 255), src and dst may be the same
+     */
+    void PremultiplyAlpha(const uint8_t* src,
+                          uint8_t* dst,
+                          size_t count);
+
+    /**
+     * \brief Keeps x and y of a RGBA normal map as RG (z gets reconstructed in the shader)
+     */
+    void PackNormalMap(const uint8_t* src,
+                       uint8_t* dst,
+                       size_t count);
+
+    /**
+     * \brief Decodes RGBA pixels from sRGB to linear floats through a lookup table, alpha is already linear
+     */
+    void SrgbToLinear(const uint8_t* src,
+                      float* dst,
+                      size_t count);
+
+    /**
+     * \brief Encodes linear RGBA floats (clamped to [0, 1]) to sRGB through a 4096 entry lookup table
+     */
+    void LinearToSrgb(const float* src,
+                      uint8_t* dst,
+                      size_t count);
+  }
+}
@@ -4,18 +4,21 @@
 lpe::rendering::Texture::Texture(const Texture& other)
 {
   this->color = other.color;
+  this->uvTransform = other.uvTransform;
   this->image = other.image;
 }
 
 lpe::rendering::Texture::Texture(Texture&& other) noexcept
 {
   this->color = other.color;
+  this->uvTransform = other.uvTransform;
   this->image = std::move(other.image);
 }
 
 lpe::rendering::Texture& lpe::rendering::Texture::operator=(Texture&& other) noexcept
 {
   this->color = other.color;
+  this->uvTransform = other.uvTransform;
   this->image = std::move(other.image);
   return *this;
 }
@@ -68,6 +71,17 @@ glm::vec4 lpe::rendering::Texture::GetColor() const
   return color;
 }
 
+void lpe::rendering::Texture::SetUvTransform(glm::vec2 scale,
+                                             glm::vec2 offset)
+{
+  this->uvTransform = { scale.x, scale.y, offset.x, offset.y };
+}
+
+glm::vec4 lpe::rendering::Texture::GetUvTransform() const
+{
+  return uvTransform;
+}
+
 lpe::rendering::Material::Material(const Material& other)
 {
   this->albedo = other.albedo;
@@ -124,6 +138,11 @@ lpe::rendering::Material& lpe::rendering::Material::SetAlbedo(const std::weak_pt
   return *this;
 }
 
+std::weak_ptr<lpe::rendering::Texture> lpe::rendering::Material::GetAlbedo() const
+{
+  return albedo;
+}
+
 lpe::rendering::Material& lpe::rendering::Material::SetNormal(std::weak_ptr<Texture>&& normal)
 {
   this->normal = normal;
@@ -180,6 +199,13 @@ lpe::rendering::Material& lpe::rendering::Material::SetEnvironmentZN(const std::
   return *this;
 }
 
+lpe::rendering::RenderTarget::RenderTarget()
+{
+  this->position = { 0, 0, 0 };
+  this->matrix = glm::mat4(1);
+  this->isStatic = false;
+}
+
 lpe::rendering::RenderTarget::RenderTarget(const RenderTarget& other)
 {
   this->mesh = other.mesh;
@@ -191,6 +217,7 @@ lpe::rendering::RenderTarget::RenderTarget(const RenderTarget& other)
   this->fragmentShader = other.fragmentShader;
   this->position = other.position;
   this->matrix = other.matrix;
+  this->isStatic = other.isStatic;
 }
 
 lpe::rendering::RenderTarget::RenderTarget(RenderTarget&& other) noexcept
@@ -204,6 +231,7 @@ lpe::rendering::RenderTarget::RenderTarget(RenderTarget&& other) noexcept
   this->fragmentShader = std::move(other.fragmentShader);
   this->position = other.position;
   this->matrix = other.matrix;
+  this->isStatic = other.isStatic;
 }
 
 lpe::rendering::RenderTarget& lpe::rendering::RenderTarget::operator=(RenderTarget&& other) noexcept
@@ -217,6 +245,7 @@ lpe::rendering::RenderTarget& lpe::rendering::RenderTarget::operator=(RenderTarg
   this->fragmentShader = std::move(other.fragmentShader);
   this->position = other.position;
   this->matrix = other.matrix;
+  this->isStatic = other.isStatic;
 
   return *this;
 }
@@ -302,6 +331,51 @@ void lpe::rendering::RenderTarget::SetFragmentShader(const RenderResource& fragm
   this->fragmentShader = fragmentShader;
 }
 
+lpe::rendering::RenderTarget::RenderResource lpe::rendering::RenderTarget::GetMesh() const
+{
+  return mesh;
+}
+
+std::weak_ptr<lpe::rendering::Material> lpe::rendering::RenderTarget::GetMaterial() const
+{
+  return material;
+}
+
+lpe::rendering::RenderTarget::RenderResource lpe::rendering::RenderTarget::GetVertexShader() const
+{
+  return vertexShader;
+}
+
+lpe::rendering::RenderTarget::RenderResource lpe::rendering::RenderTarget::GetGeometryShader() const
+{
+  return geometryShader;
+}
+
+lpe::rendering::RenderTarget::RenderResource lpe::rendering::RenderTarget::GetTessEvalShader() const
+{
+  return tessEvalShader;
+}
+
+lpe::rendering::RenderTarget::RenderResource lpe::rendering::RenderTarget::GetTessControlShader() const
+{
+  return tessControlShader;
+}
+
+lpe::rendering::RenderTarget::RenderResource lpe::rendering::RenderTarget::GetFragmentShader() const
+{
+  return fragmentShader;
+}
+
+void lpe::rendering::RenderTarget::SetStatic(bool isStatic)
+{
+  this->isStatic = isStatic;
+}
+
+bool lpe::rendering::RenderTarget::IsStatic() const
+{
+  return isStatic;
+}
+
 void lpe::rendering::RenderTarget::SetTransform(glm::mat4 transform)
 {
   this->matrix = transform;
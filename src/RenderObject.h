@@ -15,6 +15,7 @@ namespace lpe
     {
     private:
       glm::vec4 color;
+      glm::vec4 uvTransform = { 1, 1, 0, 0 };
       std::weak_ptr<lpe::utils::Resource> image;
     public:
       Texture() = default;
@@ -32,6 +33,16 @@ namespace lpe
 
       void SetColor(glm::vec4 color);
       glm::vec4 GetColor() const;
+
+      /**
+       * \brief Maps the texture coordinates into a region of the image (uv * scale + offset), used by the TextureAtlas
+       */
+      void SetUvTransform(glm::vec2 scale,
+                          glm::vec2 offset);
+      /**
+       * \return scale in xy, offset in zw
+       */
+      glm::vec4 GetUvTransform() const;
     };
 
 
@@ -56,6 +67,7 @@ namespace lpe
 
       Material& SetAlbedo(std::weak_ptr<Texture>&& albedo);
       Material& SetAlbedo(const std::weak_ptr<Texture>& albedo);
+      std::weak_ptr<Texture> GetAlbedo() const;
       Material& SetNormal(std::weak_ptr<Texture>&& normal);
       Material& SetNormal(const std::weak_ptr<Texture>& normal);
       Material& SetEnvironmentXP(std::weak_ptr<Texture>&& xp);
@@ -84,8 +96,9 @@ namespace lpe
 
       glm::vec3 position;
       glm::mat4 matrix;
+      bool isStatic;
     public:
-      RenderTarget() = default;
+      RenderTarget();
       RenderTarget(const RenderTarget& other);
       RenderTarget(RenderTarget&& other) noexcept;
       RenderTarget& operator=(const RenderTarget& other) = default;
@@ -107,6 +120,20 @@ namespace lpe
       void SetFragmentShader(RenderResource&& fragmentShader);
       void SetFragmentShader(const RenderResource& fragmentShader);
 
+      RenderResource GetMesh() const;
+      std::weak_ptr<Material> GetMaterial() const;
+      RenderResource GetVertexShader() const;
+      RenderResource GetGeometryShader() const;
+      RenderResource GetTessEvalShader() const;
+      RenderResource GetTessControlShader() const;
+      RenderResource GetFragmentShader() const;
+
+      /**
+       * \brief Static targets never move after the scene got built and can be merged by the StaticBatcher
+       */
+      void SetStatic(bool isStatic);
+      bool IsStatic() const;
+
       void SetTransform(glm::mat4 transform);
       glm::mat4 Transform(glm::mat4 transform);
 
@@ -85,6 +85,11 @@ void lpe::utils::Resource::Load(const char* fileName,
   }
 }
 
+void lpe::utils::Resource::SetData(std::vector<uint8_t>&& data)
+{
+  this->data = std::move(data);
+}
+
 lpe::utils::Uuid lpe::utils::Resource::GetUuid() const
 {
   return uuid;
@@ -30,6 +30,10 @@ namespace lpe
       void Load(const char* fileName,
                 const std::function<void(const uint8_t*,
                                          uint64_t)>& loaded = nullptr);
+      /**
+       * \brief Replaces the content with generated data (e.g. atlas pages or cooked assets)
+       */
+      void SetData(std::vector<uint8_t>&& data);
 
       Uuid GetUuid() const;
       uint64_t GetData(const uint8_t** data) const;
@@ -0,0 +1,121 @@
+#include "RingAllocator.h"
+
+#include <algorithm>
+#include <cassert>
+
+lpe::rendering::RingAllocator::RingAllocator()
+{
+  Create(0);
+}
+
+void lpe::rendering::RingAllocator::Create(uint64_t size)
+{
+  this->size = size;
+  this->head = 0;
+  this->tail = 0;
+  this->usage = 0;
+  this->frameUsage = 0;
+  this->peakUsage = 0;
+  this->peakFrameUsage = 0;
+
+  frames.clear();
+}
+
+uint64_t lpe::rendering::RingAllocator::Allocate(uint64_t size,
+                                                 uint64_t alignment)
+{
+  assert(size > 0);
+  assert(alignment > 0 && (alignment & (alignment - 1)) == 0);
+
+  // closed frames without allocations still carry an end, RetireFrame moves the tail there later
+  if (usage == 0 && frames.empty())
+  {
+    head = 0;
+    tail = 0;
+  }
+
+  uint64_t begin = (head + alignment - 1) / alignment * alignment;
+  uint64_t taken;
+
+  if (usage > 0 && head <= tail)
+  {
+    // head is behind the tail (or the ring is full), only the gap in between is free
+    if (head == tail || begin > tail || size > tail - begin)
+    {
+      return InvalidOffset;
+    }
+
+    taken = begin + size - head;
+  }
+  else if (begin <= this->size && size <= this->size - begin)
+  {
+    taken = begin + size - head;
+  }
+  else if (size <= tail)
+  {
+    // skip the end of the ring and continue at 0
+    begin = 0;
+    taken = this->size - head + size;
+  }
+  else
+  {
+    return InvalidOffset;
+  }
+
+  head = begin + size;
+  usage += taken;
+  frameUsage += taken;
+
+  peakUsage = std::max(peakUsage, usage);
+  peakFrameUsage = std::max(peakFrameUsage, frameUsage);
+
+  return begin;
+}
+
+void lpe::rendering::RingAllocator::EndFrame()
+{
+  frames.push_back({ head, frameUsage });
+  frameUsage = 0;
+}
+
+void lpe::rendering::RingAllocator::RetireFrame()
+{
+  assert(!frames.empty());
+
+  auto& frame = frames.front();
+  tail = frame.End;
+  usage -= frame.Usage;
+
+  frames.pop_front();
+}
+
+size_t lpe::rendering::RingAllocator::GetPendingFrameCount() const
+{
+  return frames.size();
+}
+
+uint64_t lpe::rendering::RingAllocator::GetSize() const
+{
+  return size;
+}
+
+uint64_t lpe::rendering::RingAllocator::GetUsage() const
+{
+  return usage;
+}
+
+uint64_t lpe::rendering::RingAllocator::GetPeakUsage() const
+{
+  return peakUsage;
+}
+
+uint64_t lpe::rendering::RingAllocator::GetPeakFrameUsage() const
+{
+  return peakFrameUsage;
+}
+
+void lpe::rendering::RingAllocator::ResetPeaks()
+{
+  peakUsage = usage;
+  peakFrameUsage = frameUsage;
+}
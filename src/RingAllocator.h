@@ -0,0 +1,76 @@
+#pragma once
+
+#include "SubAllocator.h"
+
+#include <deque>
+
+namespace lpe
+{
+  namespace rendering
+  {
+    /**
+     * \brief Ring of per frame ranges inside one memory block, e.g. for uniforms and instance data.
+     * Allocations of the current frame are appended at the head (wrapping around to the start if the end
+     * is too small), closed frames are freed in order from the tail once the GPU is done with them.
+     * Only offsets are managed, fences are up to the owner (see vulkan::RingBufferAllocator).
+     */
+    class RingAllocator
+    {
+    private:
+      struct Frame
+      {
+        uint64_t End;
+        uint64_t Usage;
+      };
+
+      uint64_t size;
+      uint64_t head;
+      uint64_t tail;
+      uint64_t usage;
+      uint64_t frameUsage;
+      uint64_t peakUsage;
+      uint64_t peakFrameUsage;
+
+      std::deque<Frame> frames;
+    public:
+      static constexpr uint64_t InvalidOffset = ISubAllocator::InvalidOffset;
+
+      RingAllocator();
+      RingAllocator(const RingAllocator& other) = default;
+      RingAllocator(RingAllocator&& other) noexcept = default;
+      RingAllocator& operator=(const RingAllocator& other) = default;
+      RingAllocator& operator=(RingAllocator&& other) noexcept = default;
+      ~RingAllocator() = default;
+
+      void Create(uint64_t size);
+
+      /**
+       * \param alignment power of two
+       * \return offset or InvalidOffset if the frames in flight still use too much of the ring
+       */
+      uint64_t Allocate(uint64_t size,
+                        uint64_t alignment = 1);
+
+      /**
+       * \brief Closes the current frame, its allocations stay in use until RetireFrame
+       */
+      void EndFrame();
+
+      /**
+       * \brief Frees the oldest closed frame
+       */
+      void RetireFrame();
+
+      size_t GetPendingFrameCount() const;
+
+      uint64_t GetSize() const;
+      /**
+       * \brief Bytes between tail and head including alignment padding and the skipped end on wrap around
+       */
+      uint64_t GetUsage() const;
+      uint64_t GetPeakUsage() const;
+      uint64_t GetPeakFrameUsage() const;
+      void ResetPeaks();
+    };
+  }
+}
@@ -0,0 +1,139 @@
+#include "StaticBatch.h"
+
+#include <cassert>
+#include <cmath>
+#include <tuple>
+
+bool lpe::rendering::StaticBatcher::BatchKey::operator<(const BatchKey& other) const
+{
+  return std::tie(Material, VertexShader, GeometryShader, TessEvalShader, TessControlShader, FragmentShader, CellX, CellY, CellZ) <
+         std::tie(other.Material, other.VertexShader, other.GeometryShader, other.TessEvalShader, other.TessControlShader, other.FragmentShader, other.CellX, other.CellY, other.CellZ);
+}
+
+lpe::rendering::StaticBatcher::StaticBatcher()
+{
+  this->cellSize = 64.0f;
+  this->maxVertices = 1u << 20u;
+}
+
+lpe::rendering::StaticBatcher& lpe::rendering::StaticBatcher::SetCellSize(float cellSize)
+{
+  assert(cellSize > 0.0f);
+
+  this->cellSize = cellSize;
+  return *this;
+}
+
+lpe::rendering::StaticBatcher& lpe::rendering::StaticBatcher::SetMaxVertices(uint32_t maxVertices)
+{
+  assert(maxVertices > 0);
+
+  this->maxVertices = maxVertices;
+  return *this;
+}
+
+bool lpe::rendering::StaticBatcher::Add(const std::weak_ptr<RenderTarget>& target)
+{
+  auto ptr = target.lock();
+  if (!ptr || !ptr->IsStatic() || ptr->GetMesh().expired())
+  {
+    return false;
+  }
+
+  targets.push_back(target);
+
+  return true;
+}
+
+void lpe::rendering::StaticBatcher::Clear()
+{
+  targets.clear();
+  meshes.clear();
+}
+
+const lpe::rendering::Mesh* lpe::rendering::StaticBatcher::GetMesh(const std::weak_ptr<lpe::utils::Resource>& resource)
+{
+  auto ptr = resource.lock();
+  if (!ptr)
+  {
+    return nullptr;
+  }
+
+  // many targets share the same resource (rocks, fences...), parse each of them only once
+  auto iter = meshes.find(ptr->GetUuid());
+  if (iter == std::end(meshes))
+  {
+    Mesh mesh;
+    if (!mesh.Load(resource))
+    {
+      return nullptr;
+    }
+
+    iter = meshes.emplace(ptr->GetUuid(), std::move(mesh)).first;
+  }
+
+  return &iter->second;
+}
+
+std::vector<lpe::rendering::StaticBatch> lpe::rendering::StaticBatcher::Build()
+{
+  std::map<BatchKey, std::vector<size_t>> groups;
+  std::vector<StaticBatch> batches;
+
+  for (auto&& weak : targets)
+  {
+    auto target = weak.lock();
+    if (!target)
+    {
+      continue;
+    }
+
+    const Mesh* mesh = GetMesh(target->GetMesh());
+    if (!mesh || mesh->GetIndices().empty())
+    {
+      continue;
+    }
+
+    glm::mat4 transform = target->GetTransform();
+    transform[3] = transform[3] + glm::vec4(target->GetPosition(), 0.0f);
+
+    glm::vec3 center = mesh->GetBounds().GetCenter();
+    glm::vec4 world = transform * glm::vec4(center, 1.0f);
+
+    BatchKey key = {
+      target->GetMaterial().lock().get(),
+      target->GetVertexShader().lock().get(),
+      target->GetGeometryShader().lock().get(),
+      target->GetTessEvalShader().lock().get(),
+      target->GetTessControlShader().lock().get(),
+      target->GetFragmentShader().lock().get(),
+      static_cast<int32_t>(std::floor(world.x / cellSize)),
+      static_cast<int32_t>(std::floor(world.y / cellSize)),
+      static_cast<int32_t>(std::floor(world.z / cellSize))
+    };
+
+    auto& group = groups[key];
+
+    if (group.empty() ||
+        batches[group.back()].Geometry.GetVertices().size() + mesh->GetVertices().size() > maxVertices)
+    {
+      StaticBatch batch = {};
+      batch.Material = target->GetMaterial();
+      batch.VertexShader = target->GetVertexShader();
+      batch.GeometryShader = target->GetGeometryShader();
+      batch.TessEvalShader = target->GetTessEvalShader();
+      batch.TessControlShader = target->GetTessControlShader();
+      batch.FragmentShader = target->GetFragmentShader();
+      batch.TargetCount = 0;
+
+      group.push_back(batches.size());
+      batches.push_back(std::move(batch));
+    }
+
+    auto& batch = batches[group.back()];
+    batch.Geometry.Append(*mesh, transform);
+    batch.TargetCount++;
+  }
+
+  return batches;
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "Mesh.h"
+#include "RenderObject.h"
+
+#include <map>
+
+namespace lpe
+{
+  namespace rendering
+  {
+    /**
+     * \brief Merged geometry of several static RenderTargets which share material and shaders.
+     * Vertices are already in world space, so the batch gets drawn with an identity transform.
+     */
+    struct StaticBatch
+    {
+      std::weak_ptr<rendering::Material> Material;
+      std::weak_ptr<lpe::utils::Resource> VertexShader;
+      std::weak_ptr<lpe::utils::Resource> GeometryShader;
+      std::weak_ptr<lpe::utils::Resource> TessEvalShader;
+      std::weak_ptr<lpe::utils::Resource> TessControlShader;
+      std::weak_ptr<lpe::utils::Resource> FragmentShader;
+
+      Mesh Geometry;
+      uint32_t TargetCount;
+    };
+
+    /**
+     * \brief Collects static RenderTargets and merges them at scene build time.
+     * Targets are grouped by material and shaders and split into a uniform grid (cell size)
+     * so every batch keeps tight bounds and can still be culled on its own.
+     */
+    class StaticBatcher
+    {
+    private:
+      struct BatchKey
+      {
+        const void* Material;
+        const void* VertexShader;
+        const void* GeometryShader;
+        const void* TessEvalShader;
+        const void* TessControlShader;
+        const void* FragmentShader;
+        int32_t CellX;
+        int32_t CellY;
+        int32_t CellZ;
+
+        bool operator<(const BatchKey& other) const;
+      };
+
+      std::vector<std::weak_ptr<RenderTarget>> targets;
+      std::map<lpe::utils::Uuid, Mesh> meshes;
+      float cellSize;
+      uint32_t maxVertices;
+
+      const Mesh* GetMesh(const std::weak_ptr<lpe::utils::Resource>& resource);
+    public:
+      StaticBatcher();
+      StaticBatcher(const StaticBatcher& other) = default;
+      StaticBatcher(StaticBatcher&& other) noexcept = default;
+      StaticBatcher& operator=(const StaticBatcher& other) = default;
+      StaticBatcher& operator=(StaticBatcher&& other) noexcept = default;
+      ~StaticBatcher() = default;
+
+      StaticBatcher& SetCellSize(float cellSize);
+      StaticBatcher& SetMaxVertices(uint32_t maxVertices);
+
+      /**
+       * \brief Adds a target to the next build. Targets which are not flagged static are ignored.
+       * \return true if the target will be batched
+       */
+      bool Add(const std::weak_ptr<RenderTarget>& target);
+      void Clear();
+
+      /**
+       * \brief Merges all added targets. Batches exceeding the vertex limit get split.
+       */
+      std::vector<StaticBatch> Build();
+    };
+  }
+}
@@ -0,0 +1,21 @@
+#include "SubAllocator.h"
+#include "BestFitAllocator.h"
+#include "BuddyAllocator.h"
+#include "LinearAllocator.h"
+#include "TlsfAllocator.h"
+
+std::unique_ptr<lpe::rendering::ISubAllocator> lpe::rendering::CreateSubAllocator(AllocationPolicy policy)
+{
+  switch (policy)
+  {
+  case AllocationPolicy::BestFit:
+    return std::make_unique<BestFitAllocator>();
+  case AllocationPolicy::Buddy:
+    return std::make_unique<BuddyAllocator>();
+  case AllocationPolicy::Linear:
+    return std::make_unique<LinearAllocator>();
+  case AllocationPolicy::Tlsf:
+  default:
+    return std::make_unique<TlsfAllocator>();
+  }
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace lpe
+{
+  namespace rendering
+  {
+    /**
+     * \brief Placement strategy of a memory pool
+     * BestFit: smallest fitting range, O(log n), lowest waste for mixed sizes
+     * Tlsf: good fit in O(1), the default
+     * Buddy: power of two blocks, O(log n), for render targets, texture pages and other pow2 friendly resources
+     * Linear: bump pointer, memory returns when the last allocation is freed, for per frame or load time data
+     */
+    enum class AllocationPolicy : uint32_t
+    {
+      BestFit,
+      Tlsf,
+      Buddy,
+      Linear
+    };
+
+    /**
+     * \brief Manages offsets inside one memory block, the memory itself is never touched
+     */
+    class ISubAllocator
+    {
+    public:
+      static constexpr uint64_t InvalidOffset = UINT64_MAX;
+
+      ISubAllocator() = default;
+      virtual ~ISubAllocator() = default;
+
+      /**
+       * \brief Starts over with size free bytes
+       */
+      virtual void Create(uint64_t size) = 0;
+
+      /**
+       * \param alignment power of two
+       * \return offset or InvalidOffset if nothing fits
+       */
+      virtual uint64_t Allocate(uint64_t size,
+                                uint64_t alignment = 1) = 0;
+      virtual void Free(uint64_t offset) = 0;
+      virtual bool CanAllocate(uint64_t size,
+                               uint64_t alignment = 1) const = 0;
+
+      /**
+       * \brief Smallest size for Create so that this Allocate succeeds in the empty allocator,
+       * includes the rounding of the policy (e.g. for a chunk of one oversized resource)
+       */
+      virtual uint64_t GetRequiredSize(uint64_t size,
+                                       uint64_t alignment = 1) const = 0;
+
+      virtual uint64_t GetSize() const = 0;
+      /**
+       * \brief Bytes taken by allocations including the rounding of the policy
+       */
+      virtual uint64_t GetUsage() const = 0;
+      virtual size_t GetAllocationCount() const = 0;
+      /**
+       * \brief Largest range an Allocate without alignment could get, 0 if full
+       */
+      virtual uint64_t GetLargestFreeBlock() const = 0;
+
+      virtual std::unique_ptr<ISubAllocator> Clone() const = 0;
+    };
+
+    std::unique_ptr<ISubAllocator> CreateSubAllocator(AllocationPolicy policy);
+  }
+}
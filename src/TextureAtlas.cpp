@@ -0,0 +1,355 @@
+#include "TextureAtlas.h"
+#include "CookedTexture.h"
+#include "PixelConversion.h"
+
+#include <stb_image.h>
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <numeric>
+
+lpe::rendering::TextureAtlas::TextureAtlas(uint32_t pageSize,
+                                           uint32_t padding,
+                                           uint32_t maxTextureSize)
+{
+  assert(pageSize > 0 && pageSize % 4 == 0);
+
+  // power of two padding keeps every region aligned for the mip levels it protects
+  uint32_t alignedPadding = padding > 0 ? 1 : 0;
+  while (alignedPadding < padding)
+  {
+    alignedPadding *= 2;
+  }
+
+  this->pageSize = pageSize;
+  this->padding = alignedPadding;
+  this->maxTextureSize = std::min(maxTextureSize, pageSize - 2 * alignedPadding);
+}
+
+uint32_t lpe::rendering::TextureAtlas::GetCellSize(uint32_t size) const
+{
+  size += 2 * padding;
+
+  return padding > 0 ?
+         (size + padding - 1) / padding * padding :
+         size;
+}
+
+bool lpe::rendering::TextureAtlas::Fit(const std::vector<Segment>& skyline,
+                                       size_t index,
+                                       uint32_t width,
+                                       uint32_t height,
+                                       uint32_t& y) const
+{
+  uint32_t x = skyline[index].X;
+  if (x + width > pageSize)
+  {
+    return false;
+  }
+
+  // the rect rests on the highest segment below it
+  y = 0;
+  uint32_t remaining = width;
+  for (size_t i = index; remaining > 0; ++i)
+  {
+    assert(i < skyline.size());
+
+    y = std::max(y, skyline[i].Y);
+    if (y + height > pageSize)
+    {
+      return false;
+    }
+
+    remaining -= std::min(remaining, skyline[i].Width);
+  }
+
+  return true;
+}
+
+bool lpe::rendering::TextureAtlas::Insert(std::vector<Segment>& skyline,
+                                          uint32_t width,
+                                          uint32_t height,
+                                          uint32_t& x,
+                                          uint32_t& y) const
+{
+  size_t best = skyline.size();
+  uint32_t bestY = std::numeric_limits<uint32_t>::max();
+  uint32_t bestWidth = std::numeric_limits<uint32_t>::max();
+
+  // bottom left: lowest position first, narrowest segment on ties
+  for (size_t i = 0; i < skyline.size(); ++i)
+  {
+    uint32_t fitY;
+    if (Fit(skyline, i, width, height, fitY) &&
+        (fitY < bestY || (fitY == bestY && skyline[i].Width < bestWidth)))
+    {
+      best = i;
+      bestY = fitY;
+      bestWidth = skyline[i].Width;
+    }
+  }
+
+  if (best == skyline.size())
+  {
+    return false;
+  }
+
+  x = skyline[best].X;
+  y = bestY;
+
+  skyline.insert(std::begin(skyline) + best, { x, y + height, width });
+
+  // shrink or remove the segments covered by the new one
+  for (size_t i = best + 1; i < skyline.size();)
+  {
+    uint32_t end = skyline[i - 1].X + skyline[i - 1].Width;
+    if (skyline[i].X >= end)
+    {
+      break;
+    }
+
+    uint32_t shrink = end - skyline[i].X;
+    if (skyline[i].Width <= shrink)
+    {
+      skyline.erase(std::begin(skyline) + i);
+      continue;
+    }
+
+    skyline[i].X += shrink;
+    skyline[i].Width -= shrink;
+    break;
+  }
+
+  for (size_t i = 0; i + 1 < skyline.size();)
+  {
+    if (skyline[i].Y == skyline[i + 1].Y)
+    {
+      skyline[i].Width += skyline[i + 1].Width;
+      skyline.erase(std::begin(skyline) + i + 1);
+    }
+    else
+    {
+      ++i;
+    }
+  }
+
+  return true;
+}
+
+void lpe::rendering::TextureAtlas::Blit(const Entry& entry,
+                                        std::vector<uint8_t>& page) const
+{
+  int32_t pad = static_cast<int32_t>(padding);
+  int32_t width = static_cast<int32_t>(entry.Width);
+  int32_t height = static_cast<int32_t>(entry.Height);
+
+  // the padding repeats the border pixels (clamp to edge inside the atlas)
+  for (int32_t y = -pad; y < height + pad; ++y)
+  {
+    int32_t sy = std::min(std::max(y, 0), height - 1);
+    uint8_t* dst = page.data() + ((entry.Y + pad + y) * static_cast<uint64_t>(pageSize) + entry.X) * 4;
+    const uint8_t* src = entry.Pixels.data() + static_cast<uint64_t>(sy) * width * 4;
+
+    for (int32_t x = 0; x < pad; ++x)
+    {
+      memcpy(dst + x * 4, src, 4);
+      memcpy(dst + (pad + width + x) * 4, src + (width - 1) * 4, 4);
+    }
+
+    memcpy(dst + pad * 4, src, width * 4);
+  }
+}
+
+bool lpe::rendering::TextureAtlas::Add(const std::shared_ptr<Texture>& texture)
+{
+  if (!texture)
+  {
+    return false;
+  }
+
+  auto image = texture->GetImage()
+                      .lock();
+  if (!image)
+  {
+    return false;
+  }
+
+  const uint8_t* data;
+  uint64_t size = image->GetData(&data);
+
+  int width, height, channels;
+  if (size == 0 ||
+      !stbi_info_from_memory(data, static_cast<int>(size), &width, &height, &channels) ||
+      static_cast<uint32_t>(std::max(width, height)) > maxTextureSize)
+  {
+    return false;
+  }
+
+  auto stbImage = stbi_load_from_memory(data,
+                                        static_cast<int>(size),
+                                        &width,
+                                        &height,
+                                        &channels,
+                                        0);
+  if (!stbImage)
+  {
+    return false;
+  }
+
+  size_t pixelCount = static_cast<size_t>(width) * height;
+  std::vector<uint8_t> rgba;
+  const uint8_t* pixels = stbImage;
+
+  if (channels != STBI_rgb_alpha)
+  {
+    rgba.resize(pixelCount * 4);
+    ConvertChannels(stbImage, static_cast<uint32_t>(channels), rgba.data(), 4, pixelCount);
+    pixels = rgba.data();
+  }
+
+  bool result = Add(texture, pixels, static_cast<uint32_t>(width), static_cast<uint32_t>(height));
+
+  stbi_image_free(stbImage);
+
+  return result;
+}
+
+bool lpe::rendering::TextureAtlas::Add(const std::shared_ptr<Texture>& texture,
+                                       const uint8_t* rgba,
+                                       uint32_t width,
+                                       uint32_t height)
+{
+  if (!texture || !rgba ||
+      width == 0 || height == 0 ||
+      std::max(width, height) > maxTextureSize)
+  {
+    return false;
+  }
+
+  // textures shared by several materials only need one region
+  for (auto&& entry : entries)
+  {
+    if (entry.Target.lock() == texture)
+    {
+      return true;
+    }
+  }
+
+  Entry entry = {};
+  entry.Target = texture;
+  entry.Pixels.assign(rgba, rgba + static_cast<uint64_t>(width) * height * 4);
+  entry.Width = width;
+  entry.Height = height;
+
+  entries.push_back(std::move(entry));
+
+  return true;
+}
+
+bool lpe::rendering::TextureAtlas::Add(const Material& material)
+{
+  return Add(material.GetAlbedo()
+                     .lock());
+}
+
+uint32_t lpe::rendering::TextureAtlas::Build(BlockFormat format)
+{
+  // drop textures that are not used anymore
+  entries.erase(std::remove_if(std::begin(entries),
+                               std::end(entries),
+                               [](const Entry& entry)
+                               {
+                                 return entry.Target.expired();
+                               }),
+                std::end(entries));
+
+  std::vector<size_t> order(entries.size());
+  std::iota(std::begin(order), std::end(order), 0);
+
+  // tallest first leaves the flattest skyline
+  std::stable_sort(std::begin(order),
+                   std::end(order),
+                   [this](size_t a, size_t b)
+                   {
+                     return std::make_pair(entries[a].Height, entries[a].Width) >
+                            std::make_pair(entries[b].Height, entries[b].Width);
+                   });
+
+  std::vector<std::vector<Segment>> skylines;
+
+  for (auto index : order)
+  {
+    auto& entry = entries[index];
+    uint32_t width = GetCellSize(entry.Width);
+    uint32_t height = GetCellSize(entry.Height);
+
+    bool inserted = false;
+    for (uint32_t page = 0; page < skylines.size() && !inserted; ++page)
+    {
+      inserted = Insert(skylines[page], width, height, entry.X, entry.Y);
+      entry.Page = page;
+    }
+
+    if (!inserted)
+    {
+      skylines.push_back({ { 0, 0, pageSize } });
+      entry.Page = static_cast<uint32_t>(skylines.size() - 1);
+
+      inserted = Insert(skylines.back(), width, height, entry.X, entry.Y);
+      assert(inserted);
+    }
+  }
+
+  uint32_t levels = 1;
+  for (uint32_t step = padding; step > 1; step /= 2)
+  {
+    ++levels;
+  }
+
+  pages.clear();
+  std::vector<uint8_t> pixels;
+
+  for (uint32_t page = 0; page < skylines.size(); ++page)
+  {
+    pixels.assign(static_cast<uint64_t>(pageSize) * pageSize * 4, 0);
+
+    for (auto&& entry : entries)
+    {
+      if (entry.Page == page)
+      {
+        Blit(entry, pixels);
+      }
+    }
+
+    auto resource = std::make_shared<lpe::utils::Resource>();
+    resource->SetData(CookTexture(pixels.data(), pageSize, pageSize, format, levels));
+
+    pages.push_back(std::move(resource));
+  }
+
+  float scale = 1.0f / pageSize;
+
+  for (auto&& entry : entries)
+  {
+    auto texture = entry.Target.lock();
+
+    texture->SetImage(pages[entry.Page]);
+    texture->SetUvTransform({ entry.Width * scale, entry.Height * scale },
+                            { (entry.X + padding) * scale, (entry.Y + padding) * scale });
+  }
+
+  return static_cast<uint32_t>(pages.size());
+}
+
+uint32_t lpe::rendering::TextureAtlas::GetPageCount() const
+{
+  return static_cast<uint32_t>(pages.size());
+}
+
+std::weak_ptr<lpe::utils::Resource> lpe::rendering::TextureAtlas::GetPage(uint32_t index) const
+{
+  assert(index < pages.size());
+
+  return pages[index];
+}
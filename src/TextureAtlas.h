@@ -0,0 +1,102 @@
+#pragma once
+
+#include "BlockCompression.h"
+#include "RenderObject.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace lpe
+{
+  namespace rendering
+  {
+    /**
+     * \brief Packs many small textures (palettes, gradients) into shared atlas pages with a skyline packer.
+     * After Build every added Texture points to its page and carries the uv scale/offset of its region,
+     * so all materials referencing it sample the atlas and can share one image and descriptor.
+     *
+     * Every region is surrounded by padding pixels that repeat its border and starts on a multiple of
+     * the padding, so the first log2(padding) + 1 mip levels do not bleed into neighbours.
+     */
+    class TextureAtlas
+    {
+    private:
+      struct Entry
+      {
+        std::weak_ptr<Texture> Target;
+        std::vector<uint8_t> Pixels;
+        uint32_t Width;
+        uint32_t Height;
+        uint32_t Page;
+        uint32_t X;
+        uint32_t Y;
+      };
+
+      struct Segment
+      {
+        uint32_t X;
+        uint32_t Y;
+        uint32_t Width;
+      };
+
+      uint32_t pageSize;
+      uint32_t padding;
+      uint32_t maxTextureSize;
+
+      std::vector<Entry> entries;
+      std::vector<std::shared_ptr<lpe::utils::Resource>> pages;
+
+      uint32_t GetCellSize(uint32_t size) const;
+      bool Fit(const std::vector<Segment>& skyline,
+               size_t index,
+               uint32_t width,
+               uint32_t height,
+               uint32_t& y) const;
+      bool Insert(std::vector<Segment>& skyline,
+                  uint32_t width,
+                  uint32_t height,
+                  uint32_t& x,
+                  uint32_t& y) const;
+      void Blit(const Entry& entry,
+                std::vector<uint8_t>& page) const;
+    public:
+      /**
+       * \param pageSize width and height of every page
+       * \param padding border in pixels around each texture, rounded up to a power of two
+       * \param maxTextureSize larger textures are rejected and keep their own image
+       */
+      TextureAtlas(uint32_t pageSize = 1024,
+                   uint32_t padding = 2,
+                   uint32_t maxTextureSize = 256);
+      TextureAtlas(const TextureAtlas& other) = delete;
+      TextureAtlas(TextureAtlas&& other) noexcept = default;
+      TextureAtlas& operator=(const TextureAtlas& other) = delete;
+      TextureAtlas& operator=(TextureAtlas&& other) noexcept = default;
+      ~TextureAtlas() = default;
+
+      /**
+       * \brief Decodes the image of the texture, fails if it is missing or too large
+       */
+      bool Add(const std::shared_ptr<Texture>& texture);
+      bool Add(const std::shared_ptr<Texture>& texture,
+               const uint8_t* rgba,
+               uint32_t width,
+               uint32_t height);
+      /**
+       * \brief Adds the albedo texture of the material
+       */
+      bool Add(const Material& material);
+
+      /**
+       * \brief Packs all added textures (tallest first), writes the pages as cooked textures and
+       * redirects the textures to them. Pages are owned by the atlas, keep it alive while they are in use.
+       * \return number of pages
+       */
+      uint32_t Build(BlockFormat format = BlockFormat::RGBA8);
+
+      uint32_t GetPageCount() const;
+      std::weak_ptr<lpe::utils::Resource> GetPage(uint32_t index) const;
+    };
+  }
+}
@@ -0,0 +1,111 @@
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cassert>
+
+lpe::utils::ThreadPool::ThreadPool()
+{
+  this->running = 0;
+  this->stopping = false;
+}
+
+lpe::utils::ThreadPool::~ThreadPool()
+{
+  Stop();
+}
+
+void lpe::utils::ThreadPool::Start(uint32_t threadCount)
+{
+  assert(workers.empty());
+
+  if (threadCount == 0)
+  {
+    threadCount = std::max(1u, std::thread::hardware_concurrency());
+  }
+
+  stopping = false;
+  workers.reserve(threadCount);
+
+  for (uint32_t i = 0; i < threadCount; ++i)
+  {
+    workers.emplace_back(&ThreadPool::Work, this);
+  }
+}
+
+void lpe::utils::ThreadPool::Stop()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+
+  available.notify_all();
+
+  for (auto&& worker : workers)
+  {
+    worker.join();
+  }
+
+  workers.clear();
+}
+
+void lpe::utils::ThreadPool::Submit(Task&& task)
+{
+  assert(!workers.empty());
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    tasks.push_back(std::move(task));
+  }
+
+  available.notify_one();
+}
+
+void lpe::utils::ThreadPool::Wait()
+{
+  std::unique_lock<std::mutex> lock(mutex);
+  idle.wait(lock,
+            [this]()
+            {
+              return tasks.empty() && running == 0;
+            });
+}
+
+uint32_t lpe::utils::ThreadPool::GetThreadCount() const
+{
+  return static_cast<uint32_t>(workers.size());
+}
+
+void lpe::utils::ThreadPool::Work()
+{
+  while (true)
+  {
+    Task task;
+
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      available.wait(lock,
+                     [this]()
+                     {
+                       return stopping || !tasks.empty();
+                     });
+
+      if (tasks.empty())
+      {
+        return;
+      }
+
+      task = std::move(tasks.front());
+      tasks.pop_front();
+      running++;
+    }
+
+    task();
+
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      running--;
+    }
+
+    idle.notify_all();
+  }
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace lpe
+{
+  namespace utils
+  {
+    /**
+     * \brief Fixed number of worker threads processing a shared FIFO task queue
+     */
+    class ThreadPool
+    {
+    public:
+      using Task = std::function<void()>;
+    private:
+      std::vector<std::thread> workers;
+      std::deque<Task> tasks;
+      std::mutex mutex;
+      std::condition_variable available;
+      std::condition_variable idle;
+      uint32_t running;
+      bool stopping;
+
+      void Work();
+    public:
+      ThreadPool();
+      ThreadPool(const ThreadPool& other) = delete;
+      ThreadPool(ThreadPool&& other) noexcept = delete;
+      ThreadPool& operator=(const ThreadPool& other) = delete;
+      ThreadPool& operator=(ThreadPool&& other) noexcept = delete;
+      ~ThreadPool();
+
+      /**
+       * \brief Spawns the workers. 0 uses one thread per hardware thread.
+       */
+      void Start(uint32_t threadCount = 0);
+
+      /**
+       * \brief Finishes all queued tasks and joins the workers
+       */
+      void Stop();
+
+      void Submit(Task&& task);
+
+      /**
+       * \brief Blocks until the queue is empty and no task is running anymore
+       */
+      void Wait();
+
+      uint32_t GetThreadCount() const;
+    };
+  }
+}
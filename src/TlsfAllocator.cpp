@@ -0,0 +1,359 @@
+#include "TlsfAllocator.h"
+
+#include <algorithm>
+#include <cassert>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace
+{
+  uint32_t GetLowestBit(uint64_t value)
+  {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward64(&index, value);
+    return static_cast<uint32_t>(index);
+#else
+    return static_cast<uint32_t>(__builtin_ctzll(value));
+#endif
+  }
+
+  uint32_t GetHighestBit(uint64_t value)
+  {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanReverse64(&index, value);
+    return static_cast<uint32_t>(index);
+#else
+    return static_cast<uint32_t>(63 - __builtin_clzll(value));
+#endif
+  }
+}
+
+lpe::rendering::TlsfAllocator::TlsfAllocator()
+{
+  Create(0);
+}
+
+void lpe::rendering::TlsfAllocator::Create(uint64_t size)
+{
+  this->size = size;
+  this->usage = 0;
+  this->firstLevelMap = 0;
+  this->secondLevelMaps.fill(0);
+  this->heads.assign(FirstLevelCount * SecondLevelCount, Null);
+  this->blocks.clear();
+  this->unusedBlocks.clear();
+  this->allocations.clear();
+
+  if (size > 0)
+  {
+    InsertFree(CreateBlock(0, size));
+  }
+}
+
+void lpe::rendering::TlsfAllocator::GetMapping(uint64_t size,
+                                               uint32_t& firstLevel,
+                                               uint32_t& secondLevel)
+{
+  // sizes below 32 share the first list linearly, above each power of two gets 32 steps
+  if (size < SecondLevelCount)
+  {
+    firstLevel = 0;
+    secondLevel = static_cast<uint32_t>(size);
+  }
+  else
+  {
+    uint32_t bit = GetHighestBit(size);
+
+    firstLevel = bit - SecondLevelLog2 + 1;
+    secondLevel = static_cast<uint32_t>(size >> (bit - SecondLevelLog2)) - SecondLevelCount;
+  }
+}
+
+uint32_t lpe::rendering::TlsfAllocator::FindFree(uint64_t size) const
+{
+  // round up to the next size class, so every block of the found list is large enough
+  if (size >= SecondLevelCount)
+  {
+    uint64_t step = 1ull << (GetHighestBit(size) - SecondLevelLog2);
+    if (size > UINT64_MAX - step)
+    {
+      return Null;
+    }
+
+    size += step - 1;
+  }
+
+  uint32_t firstLevel, secondLevel;
+  GetMapping(size, firstLevel, secondLevel);
+
+  uint32_t secondLevelMap = secondLevelMaps[firstLevel] & (~0u << secondLevel);
+
+  if (!secondLevelMap)
+  {
+    uint64_t firstLevelMap = firstLevel + 1 < 64 ?
+                             this->firstLevelMap & (~0ull << (firstLevel + 1)) :
+                             0;
+    if (!firstLevelMap)
+    {
+      return Null;
+    }
+
+    firstLevel = GetLowestBit(firstLevelMap);
+    secondLevelMap = secondLevelMaps[firstLevel];
+  }
+
+  return heads[firstLevel * SecondLevelCount + GetLowestBit(secondLevelMap)];
+}
+
+uint32_t lpe::rendering::TlsfAllocator::CreateBlock(uint64_t offset,
+                                                    uint64_t size)
+{
+  uint32_t index;
+
+  if (unusedBlocks.empty())
+  {
+    index = static_cast<uint32_t>(blocks.size());
+    blocks.emplace_back();
+  }
+  else
+  {
+    index = unusedBlocks.back();
+    unusedBlocks.pop_back();
+  }
+
+  blocks[index] = { offset, size, Null, Null, Null, Null, false };
+
+  return index;
+}
+
+uint32_t lpe::rendering::TlsfAllocator::Split(uint32_t index,
+                                              uint64_t size)
+{
+  assert(size < blocks[index].Size);
+
+  uint32_t rest = CreateBlock(blocks[index].Offset + size, blocks[index].Size - size);
+  uint32_t next = blocks[index].NextPhysical;
+
+  blocks[rest].PrevPhysical = index;
+  blocks[rest].NextPhysical = next;
+  if (next != Null)
+  {
+    blocks[next].PrevPhysical = rest;
+  }
+
+  blocks[index].NextPhysical = rest;
+  blocks[index].Size = size;
+
+  return rest;
+}
+
+void lpe::rendering::TlsfAllocator::Merge(uint32_t first,
+                                          uint32_t second)
+{
+  assert(blocks[first].NextPhysical == second);
+
+  uint32_t next = blocks[second].NextPhysical;
+
+  blocks[first].Size += blocks[second].Size;
+  blocks[first].NextPhysical = next;
+  if (next != Null)
+  {
+    blocks[next].PrevPhysical = first;
+  }
+
+  unusedBlocks.push_back(second);
+}
+
+void lpe::rendering::TlsfAllocator::InsertFree(uint32_t index)
+{
+  uint32_t firstLevel, secondLevel;
+  GetMapping(blocks[index].Size, firstLevel, secondLevel);
+
+  uint32_t& head = heads[firstLevel * SecondLevelCount + secondLevel];
+
+  blocks[index].Free = true;
+  blocks[index].PrevFree = Null;
+  blocks[index].NextFree = head;
+  if (head != Null)
+  {
+    blocks[head].PrevFree = index;
+  }
+
+  head = index;
+  secondLevelMaps[firstLevel] |= 1u << secondLevel;
+  firstLevelMap |= 1ull << firstLevel;
+}
+
+void lpe::rendering::TlsfAllocator::RemoveFree(uint32_t index)
+{
+  uint32_t firstLevel, secondLevel;
+  GetMapping(blocks[index].Size, firstLevel, secondLevel);
+
+  uint32_t& head = heads[firstLevel * SecondLevelCount + secondLevel];
+  auto& block = blocks[index];
+
+  if (block.PrevFree != Null)
+  {
+    blocks[block.PrevFree].NextFree = block.NextFree;
+  }
+
+  if (block.NextFree != Null)
+  {
+    blocks[block.NextFree].PrevFree = block.PrevFree;
+  }
+
+  if (head == index)
+  {
+    head = block.NextFree;
+
+    if (head == Null)
+    {
+      secondLevelMaps[firstLevel] &= ~(1u << secondLevel);
+
+      if (!secondLevelMaps[firstLevel])
+      {
+        firstLevelMap &= ~(1ull << firstLevel);
+      }
+    }
+  }
+
+  block.Free = false;
+  block.PrevFree = Null;
+  block.NextFree = Null;
+}
+
+uint64_t lpe::rendering::TlsfAllocator::Allocate(uint64_t size,
+                                                 uint64_t alignment)
+{
+  assert(size > 0);
+  assert(alignment > 0 && (alignment & (alignment - 1)) == 0);
+
+  // worst case padding is part of the search, so the found block always fits
+  uint32_t index = FindFree(size + alignment - 1);
+  if (index == Null)
+  {
+    return InvalidOffset;
+  }
+
+  RemoveFree(index);
+
+  uint64_t offset = blocks[index].Offset;
+  uint64_t padding = (offset + alignment - 1) / alignment * alignment - offset;
+
+  // neighbours of a free block are never free, so the padding and the rest don't need merging
+  if (padding > 0)
+  {
+    uint32_t aligned = Split(index, padding);
+    InsertFree(index);
+    index = aligned;
+  }
+
+  if (blocks[index].Size > size)
+  {
+    InsertFree(Split(index, size));
+  }
+
+  usage += blocks[index].Size;
+  allocations.emplace(blocks[index].Offset, index);
+
+  return blocks[index].Offset;
+}
+
+void lpe::rendering::TlsfAllocator::Free(uint64_t offset)
+{
+  auto iter = allocations.find(offset);
+  assert(iter != std::end(allocations));
+
+  uint32_t index = iter->second;
+  allocations.erase(iter);
+
+  usage -= blocks[index].Size;
+
+  uint32_t next = blocks[index].NextPhysical;
+  if (next != Null && blocks[next].Free)
+  {
+    RemoveFree(next);
+    Merge(index, next);
+  }
+
+  uint32_t prev = blocks[index].PrevPhysical;
+  if (prev != Null && blocks[prev].Free)
+  {
+    RemoveFree(prev);
+    Merge(prev, index);
+    index = prev;
+  }
+
+  InsertFree(index);
+}
+
+bool lpe::rendering::TlsfAllocator::CanAllocate(uint64_t size,
+                                                uint64_t alignment) const
+{
+  return size > 0 && FindFree(size + alignment - 1) != Null;
+}
+
+uint64_t lpe::rendering::TlsfAllocator::GetRequiredSize(uint64_t size,
+                                                        uint64_t alignment) const
+{
+  // Allocate searches for size + alignment - 1 rounded up to the next size class, a block of at least
+  // that size lands in a list the search accepts
+  uint64_t required = size + alignment - 1;
+
+  if (required >= SecondLevelCount)
+  {
+    uint64_t step = 1ull << (GetHighestBit(required) - SecondLevelLog2);
+    if (required > UINT64_MAX - step)
+    {
+      return UINT64_MAX;
+    }
+
+    required += step - 1;
+  }
+
+  return required;
+}
+
+uint64_t lpe::rendering::TlsfAllocator::GetSize() const
+{
+  return size;
+}
+
+uint64_t lpe::rendering::TlsfAllocator::GetUsage() const
+{
+  return usage;
+}
+
+size_t lpe::rendering::TlsfAllocator::GetAllocationCount() const
+{
+  return allocations.size();
+}
+
+uint64_t lpe::rendering::TlsfAllocator::GetLargestFreeBlock() const
+{
+  if (!firstLevelMap)
+  {
+    return 0;
+  }
+
+  // FindFree rounds up to the next size class, so only the lower bound of the highest non empty list
+  // is guaranteed to find one of its blocks, larger requests look at the (empty) lists above it
+  uint32_t firstLevel = GetHighestBit(firstLevelMap);
+  uint32_t secondLevel = GetHighestBit(secondLevelMaps[firstLevel]);
+
+  if (firstLevel == 0)
+  {
+    return secondLevel;
+  }
+
+  return static_cast<uint64_t>(SecondLevelCount + secondLevel) << (firstLevel - 1);
+}
+
+std::unique_ptr<lpe::rendering::ISubAllocator> lpe::rendering::TlsfAllocator::Clone() const
+{
+  return std::make_unique<TlsfAllocator>(*this);
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "SubAllocator.h"
+
+#include <array>
+#include <unordered_map>
+#include <vector>
+
+namespace lpe
+{
+  namespace rendering
+  {
+    /**
+     * \brief Two level segregated fit allocator (TLSF) for ranges of one memory block, e.g. a vk::DeviceMemory.
+     * Free ranges are kept in lists per size class (powers of two split into 32 linear steps) and two bitmaps
+     * find the first list which is large enough, so Allocate and Free are O(1) and free neighbours get merged.
+     * Only offsets are managed, the bookkeeping doesn't touch the (maybe not host visible) memory itself.
+     */
+    class TlsfAllocator : public ISubAllocator
+    {
+    private:
+      static constexpr uint32_t SecondLevelLog2 = 5;
+      static constexpr uint32_t SecondLevelCount = 1 << SecondLevelLog2;
+      static constexpr uint32_t FirstLevelCount = 64 - SecondLevelLog2 + 1;
+      static constexpr uint32_t Null = UINT32_MAX;
+
+      struct Block
+      {
+        uint64_t Offset;
+        uint64_t Size;
+        uint32_t PrevPhysical;
+        uint32_t NextPhysical;
+        uint32_t PrevFree;
+        uint32_t NextFree;
+        bool Free;
+      };
+
+      uint64_t size;
+      uint64_t usage;
+
+      uint64_t firstLevelMap;
+      std::array<uint32_t, FirstLevelCount> secondLevelMaps;
+      std::vector<uint32_t> heads;
+
+      std::vector<Block> blocks;
+      std::vector<uint32_t> unusedBlocks;
+      std::unordered_map<uint64_t, uint32_t> allocations;
+
+      static void GetMapping(uint64_t size,
+                             uint32_t& firstLevel,
+                             uint32_t& secondLevel);
+
+      uint32_t FindFree(uint64_t size) const;
+      uint32_t CreateBlock(uint64_t offset,
+                           uint64_t size);
+      uint32_t Split(uint32_t index,
+                     uint64_t size);
+      void Merge(uint32_t first,
+                 uint32_t second);
+      void InsertFree(uint32_t index);
+      void RemoveFree(uint32_t index);
+    public:
+      TlsfAllocator();
+      TlsfAllocator(const TlsfAllocator& other) = default;
+      TlsfAllocator(TlsfAllocator&& other) noexcept = default;
+      TlsfAllocator& operator=(const TlsfAllocator& other) = default;
+      TlsfAllocator& operator=(TlsfAllocator&& other) noexcept = default;
+      ~TlsfAllocator() override = default;
+
+      /**
+       * \brief Starts over with one free range of size bytes
+       */
+      void Create(uint64_t size) override;
+
+      /**
+       * \param alignment power of two
+       * \return offset of the range or InvalidOffset if no free range is large enough
+       */
+      uint64_t Allocate(uint64_t size,
+                        uint64_t alignment = 1) override;
+      void Free(uint64_t offset) override;
+
+      /**
+       * \brief Same search as Allocate without allocating
+       */
+      bool CanAllocate(uint64_t size,
+                       uint64_t alignment = 1) const override;
+      uint64_t GetRequiredSize(uint64_t size,
+                               uint64_t alignment = 1) const override;
+
+      uint64_t GetSize() const override;
+      uint64_t GetUsage() const override;
+      size_t GetAllocationCount() const override;
+      uint64_t GetLargestFreeBlock() const override;
+
+      std::unique_ptr<ISubAllocator> Clone() const override;
+    };
+  }
+}
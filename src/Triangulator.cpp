@@ -0,0 +1,935 @@
+#include "Triangulator.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+
+lpe::rendering::Triangulator::Triangulator()
+{
+  this->output = nullptr;
+  this->capacity = 0;
+  this->written = 0;
+  this->baseVertex = 0;
+  this->minX = 0.0f;
+  this->minY = 0.0f;
+  this->invSize = 0.0f;
+}
+
+uint32_t lpe::rendering::Triangulator::GetMaxIndexCount(uint32_t pointCount,
+                                                        uint32_t holeCount)
+{
+  // every hole bridge adds two vertices to the outer ring
+  uint32_t ring = pointCount + 2 * holeCount;
+
+  return ring < 3 ? 0 : (ring - 2) * 3;
+}
+
+uint32_t lpe::rendering::Triangulator::Triangulate(const glm::vec2* points,
+                                                   uint32_t count,
+                                                   const std::vector<uint32_t>& holes,
+                                                   uint32_t* indices,
+                                                   uint32_t capacity,
+                                                   uint32_t baseVertex)
+{
+  nodes.clear();
+
+  this->output = indices;
+  this->capacity = capacity;
+  this->written = 0;
+  this->baseVertex = baseVertex;
+  this->invSize = 0.0f;
+
+  uint32_t outerCount = holes.empty() ? count : holes[0];
+  Node* outerNode = LinkedList(points, 0, outerCount, true);
+
+  if (!outerNode || outerNode->Next == outerNode->Prev)
+  {
+    return 0;
+  }
+
+  if (!holes.empty())
+  {
+    outerNode = EliminateHoles(points, count, holes, outerNode);
+  }
+
+  // small polygons are faster without the z-order hash
+  if (count > 80)
+  {
+    float maxX = minX = points[0].x;
+    float maxY = minY = points[0].y;
+
+    for (uint32_t i = 1; i < outerCount; ++i)
+    {
+      minX = std::min(minX, points[i].x);
+      minY = std::min(minY, points[i].y);
+      maxX = std::max(maxX, points[i].x);
+      maxY = std::max(maxY, points[i].y);
+    }
+
+    invSize = std::max(maxX - minX, maxY - minY);
+    invSize = invSize != 0.0f ? 32767.0f / invSize : 0.0f;
+  }
+
+  EarcutLinked(outerNode, 0);
+
+  if (written >= 3)
+  {
+    // match the winding of the outer ring
+    float ring = 0.0f;
+    for (uint32_t i = 0, j = outerCount - 1; i < outerCount; j = i++)
+    {
+      ring += (points[j].x - points[i].x) * (points[i].y + points[j].y);
+    }
+
+    const glm::vec2& a = points[output[0] - baseVertex];
+    const glm::vec2& b = points[output[1] - baseVertex];
+    const glm::vec2& c = points[output[2] - baseVertex];
+    float triangle = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+
+    // both are positive for counter clockwise order
+    if ((ring > 0.0f) != (triangle > 0.0f))
+    {
+      for (uint32_t i = 0; i < written; i += 3)
+      {
+        std::swap(output[i + 1], output[i + 2]);
+      }
+    }
+  }
+
+  return written;
+}
+
+uint32_t lpe::rendering::Triangulator::Triangulate(const glm::vec3* points,
+                                                   uint32_t count,
+                                                   const std::vector<uint32_t>& holes,
+                                                   uint32_t* indices,
+                                                   uint32_t capacity,
+                                                   uint32_t baseVertex)
+{
+  uint32_t outerCount = holes.empty() ? count : holes[0];
+  glm::vec3 normal(0.0f);
+
+  for (uint32_t i = 0, j = outerCount - 1; i < outerCount; j = i++)
+  {
+    const glm::vec3& current = points[j];
+    const glm::vec3& next = points[i];
+
+    normal.x += (current.y - next.y) * (current.z + next.z);
+    normal.y += (current.z - next.z) * (current.x + next.x);
+    normal.z += (current.x - next.x) * (current.y + next.y);
+  }
+
+  // drop the dominant axis, the remaining two keep a right handed order
+  glm::vec3 a = glm::abs(normal);
+  uint32_t u = 0, v = 1;
+  if (a.x >= a.y && a.x >= a.z)
+  {
+    u = 1;
+    v = 2;
+  }
+  else if (a.y >= a.z)
+  {
+    u = 2;
+    v = 0;
+  }
+
+  projected.resize(count);
+  for (uint32_t i = 0; i < count; ++i)
+  {
+    projected[i] = { points[i][u], points[i][v] };
+  }
+
+  return Triangulate(projected.data(), count, holes, indices, capacity, baseVertex);
+}
+
+uint32_t lpe::rendering::Triangulator::Triangulate(const std::vector<glm::vec2>& points,
+                                                   const std::vector<uint32_t>& holes,
+                                                   std::vector<uint32_t>& indices,
+                                                   uint32_t baseVertex)
+{
+  auto offset = indices.size();
+  auto count = static_cast<uint32_t>(points.size());
+  uint32_t maxCount = GetMaxIndexCount(count, static_cast<uint32_t>(holes.size()));
+
+  indices.resize(offset + maxCount);
+  uint32_t result = Triangulate(points.data(), count, holes, indices.data() + offset, maxCount, baseVertex);
+  indices.resize(offset + result);
+
+  return result;
+}
+
+uint32_t lpe::rendering::Triangulator::Triangulate(const std::vector<glm::vec3>& points,
+                                                   const std::vector<uint32_t>& holes,
+                                                   std::vector<uint32_t>& indices,
+                                                   uint32_t baseVertex)
+{
+  auto offset = indices.size();
+  auto count = static_cast<uint32_t>(points.size());
+  uint32_t maxCount = GetMaxIndexCount(count, static_cast<uint32_t>(holes.size()));
+
+  indices.resize(offset + maxCount);
+  uint32_t result = Triangulate(points.data(), count, holes, indices.data() + offset, maxCount, baseVertex);
+  indices.resize(offset + result);
+
+  return result;
+}
+
+lpe::rendering::Triangulator::Node* lpe::rendering::Triangulator::CreateNode(uint32_t i,
+                                                                             float x,
+                                                                             float y)
+{
+  // std::deque never moves its elements on emplace_back, so the raw links stay valid
+  nodes.push_back({ i, x, y, 0, false, nullptr, nullptr, nullptr, nullptr });
+
+  return &nodes.back();
+}
+
+lpe::rendering::Triangulator::Node* lpe::rendering::Triangulator::InsertNode(uint32_t i,
+                                                                             float x,
+                                                                             float y,
+                                                                             Node* last)
+{
+  Node* p = CreateNode(i, x, y);
+
+  if (!last)
+  {
+    p->Prev = p;
+    p->Next = p;
+  }
+  else
+  {
+    p->Next = last->Next;
+    p->Prev = last;
+    last->Next->Prev = p;
+    last->Next = p;
+  }
+
+  return p;
+}
+
+void lpe::rendering::Triangulator::RemoveNode(Node* p)
+{
+  p->Next->Prev = p->Prev;
+  p->Prev->Next = p->Next;
+
+  if (p->PrevZ)
+  {
+    p->PrevZ->NextZ = p->NextZ;
+  }
+
+  if (p->NextZ)
+  {
+    p->NextZ->PrevZ = p->PrevZ;
+  }
+}
+
+lpe::rendering::Triangulator::Node* lpe::rendering::Triangulator::LinkedList(const glm::vec2* points,
+                                                                             uint32_t start,
+                                                                             uint32_t end,
+                                                                             bool clockwise)
+{
+  if (end <= start)
+  {
+    return nullptr;
+  }
+
+  float sum = 0.0f;
+  for (uint32_t i = start, j = end - 1; i < end; j = i++)
+  {
+    sum += (points[j].x - points[i].x) * (points[i].y + points[j].y);
+  }
+
+  Node* last = nullptr;
+
+  if (clockwise == (sum > 0.0f))
+  {
+    for (uint32_t i = start; i < end; ++i)
+    {
+      last = InsertNode(i, points[i].x, points[i].y, last);
+    }
+  }
+  else
+  {
+    for (uint32_t i = end; i-- > start;)
+    {
+      last = InsertNode(i, points[i].x, points[i].y, last);
+    }
+  }
+
+  if (last && Equals(last, last->Next))
+  {
+    RemoveNode(last);
+    last = last->Next;
+  }
+
+  return last;
+}
+
+lpe::rendering::Triangulator::Node* lpe::rendering::Triangulator::FilterPoints(Node* start,
+                                                                               Node* end)
+{
+  if (!start)
+  {
+    return start;
+  }
+
+  if (!end)
+  {
+    end = start;
+  }
+
+  Node* p = start;
+  bool again;
+
+  do
+  {
+    again = false;
+
+    if (!p->Steiner && (Equals(p, p->Next) || Area(p->Prev, p, p->Next) == 0.0f))
+    {
+      RemoveNode(p);
+      p = end = p->Prev;
+
+      if (p == p->Next)
+      {
+        break;
+      }
+
+      again = true;
+    }
+    else
+    {
+      p = p->Next;
+    }
+  } while (again || p != end);
+
+  return end;
+}
+
+void lpe::rendering::Triangulator::EarcutLinked(Node* ear,
+                                                int pass)
+{
+  if (!ear)
+  {
+    return;
+  }
+
+  if (pass == 0 && invSize != 0.0f)
+  {
+    IndexCurve(ear);
+  }
+
+  Node* stop = ear;
+
+  while (ear->Prev != ear->Next)
+  {
+    Node* prev = ear->Prev;
+    Node* next = ear->Next;
+
+    if (invSize != 0.0f ? IsEarHashed(ear) : IsEar(ear))
+    {
+      Emit(prev, ear, next);
+      RemoveNode(ear);
+
+      ear = next->Next;
+      stop = next->Next;
+
+      continue;
+    }
+
+    ear = next;
+
+    if (ear == stop)
+    {
+      // no ear found: filter, then cure self intersections, then split the polygon
+      if (pass == 0)
+      {
+        EarcutLinked(FilterPoints(ear), 1);
+      }
+      else if (pass == 1)
+      {
+        ear = CureLocalIntersections(FilterPoints(ear));
+        EarcutLinked(ear, 2);
+      }
+      else if (pass == 2)
+      {
+        SplitEarcut(ear);
+      }
+
+      break;
+    }
+  }
+}
+
+bool lpe::rendering::Triangulator::IsEar(Node* ear) const
+{
+  const Node* a = ear->Prev;
+  const Node* b = ear;
+  const Node* c = ear->Next;
+
+  if (Area(a, b, c) >= 0.0f)
+  {
+    return false; // reflex
+  }
+
+  float x0 = std::min(a->X, std::min(b->X, c->X));
+  float y0 = std::min(a->Y, std::min(b->Y, c->Y));
+  float x1 = std::max(a->X, std::max(b->X, c->X));
+  float y1 = std::max(a->Y, std::max(b->Y, c->Y));
+
+  const Node* p = c->Next;
+  while (p != a)
+  {
+    if (p->X >= x0 && p->X <= x1 && p->Y >= y0 && p->Y <= y1 &&
+        PointInTriangle(a->X, a->Y, b->X, b->Y, c->X, c->Y, p->X, p->Y) &&
+        Area(p->Prev, p, p->Next) >= 0.0f)
+    {
+      return false;
+    }
+
+    p = p->Next;
+  }
+
+  return true;
+}
+
+bool lpe::rendering::Triangulator::IsEarHashed(Node* ear) const
+{
+  const Node* a = ear->Prev;
+  const Node* b = ear;
+  const Node* c = ear->Next;
+
+  if (Area(a, b, c) >= 0.0f)
+  {
+    return false;
+  }
+
+  float x0 = std::min(a->X, std::min(b->X, c->X));
+  float y0 = std::min(a->Y, std::min(b->Y, c->Y));
+  float x1 = std::max(a->X, std::max(b->X, c->X));
+  float y1 = std::max(a->Y, std::max(b->Y, c->Y));
+
+  int32_t minZ = ZOrder(x0, y0);
+  int32_t maxZ = ZOrder(x1, y1);
+
+  auto blocks = [&](const Node* p)
+  {
+    return p->X >= x0 && p->X <= x1 && p->Y >= y0 && p->Y <= y1 &&
+           p != a && p != c &&
+           PointInTriangle(a->X, a->Y, b->X, b->Y, c->X, c->Y, p->X, p->Y) &&
+           Area(p->Prev, p, p->Next) >= 0.0f;
+  };
+
+  // walk the z-order curve in both directions, only nodes inside the ear bbox can block it
+  const Node* p = ear->PrevZ;
+  const Node* n = ear->NextZ;
+
+  while (p && p->Z >= minZ && n && n->Z <= maxZ)
+  {
+    if (blocks(p))
+    {
+      return false;
+    }
+    p = p->PrevZ;
+
+    if (blocks(n))
+    {
+      return false;
+    }
+    n = n->NextZ;
+  }
+
+  while (p && p->Z >= minZ)
+  {
+    if (blocks(p))
+    {
+      return false;
+    }
+    p = p->PrevZ;
+  }
+
+  while (n && n->Z <= maxZ)
+  {
+    if (blocks(n))
+    {
+      return false;
+    }
+    n = n->NextZ;
+  }
+
+  return true;
+}
+
+lpe::rendering::Triangulator::Node* lpe::rendering::Triangulator::CureLocalIntersections(Node* start)
+{
+  Node* p = start;
+
+  do
+  {
+    Node* a = p->Prev;
+    Node* b = p->Next->Next;
+
+    if (!Equals(a, b) && Intersects(a, p, p->Next, b) && LocallyInside(a, b) && LocallyInside(b, a))
+    {
+      Emit(a, p, b);
+
+      RemoveNode(p);
+      RemoveNode(p->Next);
+
+      p = start = b;
+    }
+
+    p = p->Next;
+  } while (p != start);
+
+  return FilterPoints(p);
+}
+
+void lpe::rendering::Triangulator::SplitEarcut(Node* start)
+{
+  Node* a = start;
+
+  do
+  {
+    Node* b = a->Next->Next;
+
+    while (b != a->Prev)
+    {
+      if (a->I != b->I && IsValidDiagonal(a, b))
+      {
+        Node* c = SplitPolygon(a, b);
+
+        a = FilterPoints(a, a->Next);
+        c = FilterPoints(c, c->Next);
+
+        EarcutLinked(a, 0);
+        EarcutLinked(c, 0);
+
+        return;
+      }
+
+      b = b->Next;
+    }
+
+    a = a->Next;
+  } while (a != start);
+}
+
+lpe::rendering::Triangulator::Node* lpe::rendering::Triangulator::EliminateHoles(const glm::vec2* points,
+                                                                                 uint32_t count,
+                                                                                 const std::vector<uint32_t>& holes,
+                                                                                 Node* outerNode)
+{
+  queue.clear();
+
+  for (size_t i = 0; i < holes.size(); ++i)
+  {
+    uint32_t start = holes[i];
+    uint32_t end = i < holes.size() - 1 ? holes[i + 1] : count;
+
+    Node* list = LinkedList(points, start, end, false);
+    if (!list)
+    {
+      continue;
+    }
+
+    if (list == list->Next)
+    {
+      list->Steiner = true;
+    }
+
+    queue.push_back(GetLeftmost(list));
+  }
+
+  std::sort(std::begin(queue),
+            std::end(queue),
+            [](const Node* a, const Node* b)
+            {
+              return a->X < b->X;
+            });
+
+  for (auto&& hole : queue)
+  {
+    outerNode = EliminateHole(hole, outerNode);
+  }
+
+  return outerNode;
+}
+
+lpe::rendering::Triangulator::Node* lpe::rendering::Triangulator::EliminateHole(Node* hole,
+                                                                                Node* outerNode)
+{
+  Node* bridge = FindHoleBridge(hole, outerNode);
+  if (!bridge)
+  {
+    return outerNode;
+  }
+
+  Node* bridgeReverse = SplitPolygon(bridge, hole);
+
+  FilterPoints(bridgeReverse, bridgeReverse->Next);
+
+  return FilterPoints(bridge, bridge->Next);
+}
+
+lpe::rendering::Triangulator::Node* lpe::rendering::Triangulator::FindHoleBridge(Node* hole,
+                                                                                 Node* outerNode) const
+{
+  Node* p = outerNode;
+  Node* m = nullptr;
+  float hx = hole->X;
+  float hy = hole->Y;
+  float qx = std::numeric_limits<float>::lowest();
+
+  // find a segment intersected by a ray from the hole's leftmost point to the left
+  do
+  {
+    if (hy <= p->Y && hy >= p->Next->Y && p->Next->Y != p->Y)
+    {
+      float x = p->X + (hy - p->Y) * (p->Next->X - p->X) / (p->Next->Y - p->Y);
+      if (x <= hx && x > qx)
+      {
+        qx = x;
+        m = p->X < p->Next->X ? p : p->Next;
+
+        if (x == hx)
+        {
+          return m; // hole touches the outer segment
+        }
+      }
+    }
+
+    p = p->Next;
+  } while (p != outerNode);
+
+  if (!m)
+  {
+    return nullptr;
+  }
+
+  // look for points inside the triangle of hole point, segment intersection and endpoint;
+  // the one with the smallest angle to the ray gets the bridge
+  Node* stop = m;
+  float mx = m->X;
+  float my = m->Y;
+  float tanMin = std::numeric_limits<float>::infinity();
+
+  p = m;
+
+  do
+  {
+    if (hx >= p->X && p->X >= mx && hx != p->X &&
+        PointInTriangle(hy < my ? hx : qx, hy, mx, my, hy < my ? qx : hx, hy, p->X, p->Y))
+    {
+      float tan = std::abs(hy - p->Y) / (hx - p->X);
+
+      if (LocallyInside(p, hole) &&
+          (tan < tanMin || (tan == tanMin && (p->X > m->X || (p->X == m->X && SectorContainsSector(m, p))))))
+      {
+        m = p;
+        tanMin = tan;
+      }
+    }
+
+    p = p->Next;
+  } while (p != stop);
+
+  return m;
+}
+
+void lpe::rendering::Triangulator::IndexCurve(Node* start)
+{
+  Node* p = start;
+
+  do
+  {
+    if (p->Z == 0)
+    {
+      p->Z = ZOrder(p->X, p->Y);
+    }
+
+    p->PrevZ = p->Prev;
+    p->NextZ = p->Next;
+    p = p->Next;
+  } while (p != start);
+
+  p->PrevZ->NextZ = nullptr;
+  p->PrevZ = nullptr;
+
+  SortLinked(p);
+}
+
+lpe::rendering::Triangulator::Node* lpe::rendering::Triangulator::SortLinked(Node* list) const
+{
+  // Simon Tatham's linked list merge sort on the z links
+  uint32_t inSize = 1;
+  uint32_t numMerges;
+
+  do
+  {
+    Node* p = list;
+    Node* tail = nullptr;
+    list = nullptr;
+    numMerges = 0;
+
+    while (p)
+    {
+      numMerges++;
+
+      Node* q = p;
+      uint32_t pSize = 0;
+      for (uint32_t i = 0; i < inSize; ++i)
+      {
+        pSize++;
+        q = q->NextZ;
+        if (!q)
+        {
+          break;
+        }
+      }
+
+      uint32_t qSize = inSize;
+
+      while (pSize > 0 || (qSize > 0 && q))
+      {
+        Node* e;
+
+        if (pSize != 0 && (qSize == 0 || !q || p->Z <= q->Z))
+        {
+          e = p;
+          p = p->NextZ;
+          pSize--;
+        }
+        else
+        {
+          e = q;
+          q = q->NextZ;
+          qSize--;
+        }
+
+        if (tail)
+        {
+          tail->NextZ = e;
+        }
+        else
+        {
+          list = e;
+        }
+
+        e->PrevZ = tail;
+        tail = e;
+      }
+
+      p = q;
+    }
+
+    tail->NextZ = nullptr;
+    inSize *= 2;
+  } while (numMerges > 1);
+
+  return list;
+}
+
+int32_t lpe::rendering::Triangulator::ZOrder(float x,
+                                             float y) const
+{
+  // coordinates as 15 bit integers, interleaved to a 30 bit morton code
+  auto ix = static_cast<uint32_t>((x - minX) * invSize);
+  auto iy = static_cast<uint32_t>((y - minY) * invSize);
+
+  ix = (ix | (ix << 8)) & 0x00FF00FF;
+  ix = (ix | (ix << 4)) & 0x0F0F0F0F;
+  ix = (ix | (ix << 2)) & 0x33333333;
+  ix = (ix | (ix << 1)) & 0x55555555;
+
+  iy = (iy | (iy << 8)) & 0x00FF00FF;
+  iy = (iy | (iy << 4)) & 0x0F0F0F0F;
+  iy = (iy | (iy << 2)) & 0x33333333;
+  iy = (iy | (iy << 1)) & 0x55555555;
+
+  return static_cast<int32_t>(ix | (iy << 1));
+}
+
+lpe::rendering::Triangulator::Node* lpe::rendering::Triangulator::SplitPolygon(Node* a,
+                                                                               Node* b)
+{
+  Node* a2 = CreateNode(a->I, a->X, a->Y);
+  Node* b2 = CreateNode(b->I, b->X, b->Y);
+  Node* an = a->Next;
+  Node* bp = b->Prev;
+
+  a->Next = b;
+  b->Prev = a;
+
+  a2->Next = an;
+  an->Prev = a2;
+
+  b2->Next = a2;
+  a2->Prev = b2;
+
+  bp->Next = b2;
+  b2->Prev = bp;
+
+  return b2;
+}
+
+void lpe::rendering::Triangulator::Emit(const Node* a,
+                                        const Node* b,
+                                        const Node* c)
+{
+  assert(written + 3 <= capacity);
+
+  if (written + 3 > capacity)
+  {
+    return;
+  }
+
+  output[written++] = baseVertex + a->I;
+  output[written++] = baseVertex + b->I;
+  output[written++] = baseVertex + c->I;
+}
+
+lpe::rendering::Triangulator::Node* lpe::rendering::Triangulator::GetLeftmost(Node* start)
+{
+  Node* p = start;
+  Node* leftmost = start;
+
+  do
+  {
+    if (p->X < leftmost->X || (p->X == leftmost->X && p->Y < leftmost->Y))
+    {
+      leftmost = p;
+    }
+
+    p = p->Next;
+  } while (p != start);
+
+  return leftmost;
+}
+
+bool lpe::rendering::Triangulator::IsValidDiagonal(const Node* a,
+                                                   const Node* b)
+{
+  return a->Next->I != b->I && a->Prev->I != b->I && !IntersectsPolygon(a, b) &&
+         ((LocallyInside(a, b) && LocallyInside(b, a) && MiddleInside(a, b) &&
+           (Area(a->Prev, a, b->Prev) != 0.0f || Area(a, b->Prev, b) != 0.0f)) ||
+          (Equals(a, b) && Area(a->Prev, a, a->Next) > 0.0f && Area(b->Prev, b, b->Next) > 0.0f));
+}
+
+bool lpe::rendering::Triangulator::IntersectsPolygon(const Node* a,
+                                                     const Node* b)
+{
+  const Node* p = a;
+
+  do
+  {
+    if (p->I != a->I && p->Next->I != a->I && p->I != b->I && p->Next->I != b->I &&
+        Intersects(p, p->Next, a, b))
+    {
+      return true;
+    }
+
+    p = p->Next;
+  } while (p != a);
+
+  return false;
+}
+
+bool lpe::rendering::Triangulator::LocallyInside(const Node* a,
+                                                 const Node* b)
+{
+  return Area(a->Prev, a, a->Next) < 0.0f ?
+         Area(a, b, a->Next) >= 0.0f && Area(a, a->Prev, b) >= 0.0f :
+         Area(a, b, a->Prev) < 0.0f || Area(a, a->Next, b) < 0.0f;
+}
+
+bool lpe::rendering::Triangulator::MiddleInside(const Node* a,
+                                                const Node* b)
+{
+  const Node* p = a;
+  bool inside = false;
+  float px = (a->X + b->X) / 2.0f;
+  float py = (a->Y + b->Y) / 2.0f;
+
+  do
+  {
+    if (((p->Y > py) != (p->Next->Y > py)) && p->Next->Y != p->Y &&
+        (px < (p->Next->X - p->X) * (py - p->Y) / (p->Next->Y - p->Y) + p->X))
+    {
+      inside = !inside;
+    }
+
+    p = p->Next;
+  } while (p != a);
+
+  return inside;
+}
+
+bool lpe::rendering::Triangulator::SectorContainsSector(const Node* m,
+                                                        const Node* p)
+{
+  return Area(m->Prev, m, p->Prev) < 0.0f && Area(p->Next, m, m->Next) < 0.0f;
+}
+
+bool lpe::rendering::Triangulator::Intersects(const Node* p1,
+                                              const Node* q1,
+                                              const Node* p2,
+                                              const Node* q2)
+{
+  auto sign = [](float value)
+  {
+    return value > 0.0f ? 1 : value < 0.0f ? -1 : 0;
+  };
+
+  int o1 = sign(Area(p1, q1, p2));
+  int o2 = sign(Area(p1, q1, q2));
+  int o3 = sign(Area(p2, q2, p1));
+  int o4 = sign(Area(p2, q2, q1));
+
+  if (o1 != o2 && o3 != o4)
+  {
+    return true;
+  }
+
+  // collinear cases
+  return (o1 == 0 && OnSegment(p1, p2, q1)) ||
+         (o2 == 0 && OnSegment(p1, q2, q1)) ||
+         (o3 == 0 && OnSegment(p2, p1, q2)) ||
+         (o4 == 0 && OnSegment(p2, q1, q2));
+}
+
+bool lpe::rendering::Triangulator::OnSegment(const Node* p,
+                                             const Node* q,
+                                             const Node* r)
+{
+  return q->X <= std::max(p->X, r->X) && q->X >= std::min(p->X, r->X) &&
+         q->Y <= std::max(p->Y, r->Y) && q->Y >= std::min(p->Y, r->Y);
+}
+
+bool lpe::rendering::Triangulator::Equals(const Node* a,
+                                          const Node* b)
+{
+  return a->X == b->X && a->Y == b->Y;
+}
+
+float lpe::rendering::Triangulator::Area(const Node* p,
+                                         const Node* q,
+                                         const Node* r)
+{
+  return (q->Y - p->Y) * (r->X - q->X) - (q->X - p->X) * (r->Y - q->Y);
+}
+
+bool lpe::rendering::Triangulator::PointInTriangle(float ax,
+                                                   float ay,
+                                                   float bx,
+                                                   float by,
+                                                   float cx,
+                                                   float cy,
+                                                   float px,
+                                                   float py)
+{
+  return (cx - px) * (ay - py) >= (ax - px) * (cy - py) &&
+         (ax - px) * (by - py) >= (bx - px) * (ay - py) &&
+         (bx - px) * (cy - py) >= (cx - px) * (by - py);
+}
@@ -0,0 +1,167 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+namespace lpe
+{
+  namespace rendering
+  {
+    /**
+     * \brief Ear clipping triangulator for simple polygons with holes (same approach as mapbox/earcut).
+     * Larger polygons hash their vertices along a z-order curve, so ear tests only visit vertices
+     * near the ear instead of the whole ring.
+     *
+     * Points contain the outer ring followed by all holes, holes contains the index of the first
+     * point of each hole. Emitted triangles have the winding of the outer ring.
+     * The instance keeps its node memory between calls, reuse it for many polygons.
+     */
+    class Triangulator
+    {
+    private:
+      struct Node
+      {
+        uint32_t I;
+        float X;
+        float Y;
+        int32_t Z;
+        bool Steiner;
+        Node* Prev;
+        Node* Next;
+        Node* PrevZ;
+        Node* NextZ;
+      };
+
+      std::deque<Node> nodes;
+      std::vector<glm::vec2> projected;
+      std::vector<Node*> queue;
+
+      uint32_t* output;
+      uint32_t capacity;
+      uint32_t written;
+      uint32_t baseVertex;
+
+      float minX;
+      float minY;
+      float invSize;
+
+      Node* CreateNode(uint32_t i,
+                       float x,
+                       float y);
+      Node* InsertNode(uint32_t i,
+                       float x,
+                       float y,
+                       Node* last);
+      void RemoveNode(Node* p);
+      Node* LinkedList(const glm::vec2* points,
+                       uint32_t start,
+                       uint32_t end,
+                       bool clockwise);
+      Node* FilterPoints(Node* start,
+                         Node* end = nullptr);
+      void EarcutLinked(Node* ear,
+                        int pass);
+      bool IsEar(Node* ear) const;
+      bool IsEarHashed(Node* ear) const;
+      Node* CureLocalIntersections(Node* start);
+      void SplitEarcut(Node* start);
+      Node* EliminateHoles(const glm::vec2* points,
+                           uint32_t count,
+                           const std::vector<uint32_t>& holes,
+                           Node* outerNode);
+      Node* EliminateHole(Node* hole,
+                          Node* outerNode);
+      Node* FindHoleBridge(Node* hole,
+                           Node* outerNode) const;
+      void IndexCurve(Node* start);
+      Node* SortLinked(Node* list) const;
+      int32_t ZOrder(float x,
+                     float y) const;
+      Node* SplitPolygon(Node* a,
+                         Node* b);
+      void Emit(const Node* a,
+                const Node* b,
+                const Node* c);
+
+      static Node* GetLeftmost(Node* start);
+      static bool IsValidDiagonal(const Node* a,
+                                  const Node* b);
+      static bool IntersectsPolygon(const Node* a,
+                                    const Node* b);
+      static bool LocallyInside(const Node* a,
+                                const Node* b);
+      static bool MiddleInside(const Node* a,
+                               const Node* b);
+      static bool SectorContainsSector(const Node* m,
+                                       const Node* p);
+      static bool Intersects(const Node* p1,
+                             const Node* q1,
+                             const Node* p2,
+                             const Node* q2);
+      static bool OnSegment(const Node* p,
+                            const Node* q,
+                            const Node* r);
+      static bool Equals(const Node* a,
+                         const Node* b);
+      static float Area(const Node* p,
+                        const Node* q,
+                        const Node* r);
+      static bool PointInTriangle(float ax,
+                                  float ay,
+                                  float bx,
+                                  float by,
+                                  float cx,
+                                  float cy,
+                                  float px,
+                                  float py);
+    public:
+      Triangulator();
+      Triangulator(const Triangulator& other) = delete;
+      Triangulator(Triangulator&& other) noexcept = default;
+      Triangulator& operator=(const Triangulator& other) = delete;
+      Triangulator& operator=(Triangulator&& other) noexcept = default;
+      ~Triangulator() = default;
+
+      /**
+       * \brief Upper bound of indices written for a polygon, use it to size index buffers
+       */
+      static uint32_t GetMaxIndexCount(uint32_t pointCount,
+                                       uint32_t holeCount);
+
+      /**
+       * \brief Writes triangles into indices (e.g. mapped staging memory), each index offset by baseVertex
+       * \return number of written indices
+       */
+      uint32_t Triangulate(const glm::vec2* points,
+                           uint32_t count,
+                           const std::vector<uint32_t>& holes,
+                           uint32_t* indices,
+                           uint32_t capacity,
+                           uint32_t baseVertex = 0);
+
+      /**
+       * \brief Triangulates a planar 3D polygon in the plane of its Newell normal
+       */
+      uint32_t Triangulate(const glm::vec3* points,
+                           uint32_t count,
+                           const std::vector<uint32_t>& holes,
+                           uint32_t* indices,
+                           uint32_t capacity,
+                           uint32_t baseVertex = 0);
+
+      /**
+       * \brief Appends the triangles to indices
+       */
+      uint32_t Triangulate(const std::vector<glm::vec2>& points,
+                           const std::vector<uint32_t>& holes,
+                           std::vector<uint32_t>& indices,
+                           uint32_t baseVertex = 0);
+      uint32_t Triangulate(const std::vector<glm::vec3>& points,
+                           const std::vector<uint32_t>& holes,
+                           std::vector<uint32_t>& indices,
+                           uint32_t baseVertex = 0);
+    };
+  }
+}
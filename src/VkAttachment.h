@@ -45,6 +45,12 @@ namespace lpe
       vk::AttachmentReference GetAttachmentReference() const;
       vk::AttachmentDescription GetAttachmentDescription() const;
 
+      /**
+       * \brief Contents never leave the render pass, nothing gets loaded or stored (e.g. depth, or MSAA color
+       * which gets resolved). The image can be a transient attachment in lazily allocated memory then.
+       */
+      bool IsTransient() const;
+
       operator bool() const;
       bool operator!() const;
     };
@@ -27,25 +27,43 @@ void lpe::rendering::utils::AllocateDeviceMemory(vk::Device device,
                                               vk::DeviceMemory *memory,
                                               uint32_t *type)
 {
-  *type = 0;
-  vk::Result result = vk::Result::eSuccess;
-  do
+  auto deviceProperties = physicalDevice.getMemoryProperties();
+  int32_t found = -1;
+  uint32_t typeOffset = 0;
+  vk::Result result = vk::Result::eErrorOutOfDeviceMemory;
+
+  // try the next matching type (e.g. another heap) if one is full, but don't spin on a full heap
+  while (result != vk::Result::eSuccess &&
+         (found = GetMemoryType(deviceProperties,
+                                requirements,
+                                properties,
+                                typeOffset)) >= 0)
   {
-    *type = GetMemoryType(physicalDevice.getMemoryProperties(),
-                          requirements,
-                          properties,
-                          *type);
-
     vk::MemoryAllocateInfo allocateInfo =
       {
         requirements.size,
-        *type
+        static_cast<uint32_t>(found)
       };
 
     result = device.allocateMemory(&allocateInfo,
                                    nullptr,
                                    memory);
-  } while (result != vk::Result::eSuccess);
+    typeOffset = static_cast<uint32_t>(found) + 1;
+  }
+
+  if (result != vk::Result::eSuccess)
+  {
+    *memory = nullptr;
+
+    auto manager = ServiceLocator::LogManager.Get()
+                                             .lock();
+    if (manager)
+    {
+      manager->Log("Could not allocate device memory, all matching heaps are full");
+    }
+  }
+
+  *type = found >= 0 ? static_cast<uint32_t>(found) : 0;
 }
 
 lpe::rendering::Chunk::Chunk()
@@ -54,10 +72,33 @@ lpe::rendering::Chunk::Chunk()
     alignment(VK_WHOLE_SIZE),
     properties(),
     device(nullptr),
-    usage(0)
+    allocator(CreateSubAllocator(AllocationPolicy::Tlsf))
 {
 }
 
+lpe::rendering::Chunk::Chunk(const Chunk& other)
+  : memory(other.memory),
+    size(other.size),
+    alignment(other.alignment),
+    properties(other.properties),
+    device(other.device),
+    allocator(other.allocator ? other.allocator->Clone() : nullptr)
+{
+}
+
+lpe::rendering::Chunk& lpe::rendering::Chunk::operator=(const Chunk& other)
+{
+  if (this == &other)
+  { return *this; }
+  memory = other.memory;
+  size = other.size;
+  alignment = other.alignment;
+  properties = other.properties;
+  device = other.device;
+  allocator = other.allocator ? other.allocator->Clone() : nullptr;
+  return *this;
+}
+
 lpe::rendering::Chunk::~Chunk()
 {
   assert(!memory);
@@ -66,7 +107,8 @@ lpe::rendering::Chunk::~Chunk()
 const vk::DeviceMemory &lpe::rendering::Chunk::Create(vk::Device device,
                                                    vk::PhysicalDevice physicalDevice,
                                                    vk::MemoryRequirements requirements,
-                                                   vk::MemoryPropertyFlagBits properties)
+                                                   vk::MemoryPropertyFlagBits properties,
+                                                   AllocationPolicy policy)
 {
   this->device = device;
   this->memory = nullptr;
@@ -86,7 +128,14 @@ const vk::DeviceMemory &lpe::rendering::Chunk::Create(vk::Device device,
                               &this->memory,
                               &type);
 
-  assert(this->memory);
+  // an empty allocator lets every MoveMarker fail instead of binding to a null handle
+  if (!this->memory)
+  {
+    this->size = 0;
+  }
+
+  allocator = CreateSubAllocator(policy);
+  allocator->Create(this->size);
 
   return this->memory;
 }
@@ -98,33 +147,20 @@ void lpe::rendering::Chunk::Destroy()
   device.freeMemory(memory,
                     nullptr);
   memory = nullptr;
+
+  allocator->Create(0);
 }
 
 vk::DeviceSize lpe::rendering::Chunk::GetUsage() const
 {
-  vk::DeviceSize usage = 0;
-  for (auto iter = std::begin(allocations); iter != std::end(allocations); ++iter)
-  {
-    usage += iter->End - iter->Begin;
-  }
-
-  return usage;
+  return allocator->GetUsage();
 }
 
-bool lpe::rendering::Chunk::HasSpaceLeft(vk::DeviceSize delta) const
+bool lpe::rendering::Chunk::HasSpaceLeft(vk::DeviceSize delta,
+                                         vk::DeviceSize alignment) const
 {
-  bool result = false;
-
-  for (auto &&range : freed)
-  {
-    if ((range.End - range.Begin) >= delta)
-    {
-      result = true;
-      break;
-    }
-  }
-
-  return (usage + delta <= size) || result;
+  return allocator->CanAllocate(delta,
+                               alignment ? alignment : this->alignment);
 }
 
 lpe::rendering::Chunk::operator bool() const
@@ -142,114 +178,16 @@ lpe::rendering::Chunk::operator vk::DeviceMemory() const
   return memory;
 }
 
-vk::DeviceSize lpe::rendering::Chunk::MoveMarker(vk::DeviceSize size)
+vk::DeviceSize lpe::rendering::Chunk::MoveMarker(vk::DeviceSize size,
+                                                 vk::DeviceSize alignment)
 {
-  std::vector<Range>::iterator min;
-  vk::DeviceSize minDelta = VK_WHOLE_SIZE;
-
-  std::vector<Range> items;
-  items.emplace_back(usage,
-                     this->size);
-  items.insert(std::end(items),
-               std::begin(freed),
-               std::end(freed));
-
-  for (auto iter = std::begin(items); iter != std::end(items); ++iter)
-  {
-    vk::DeviceSize delta = iter->End - iter->Begin;
-    if (delta >= size && delta < minDelta)
-    {
-      minDelta = delta;
-      min = iter;
-    }
-  }
-
-  assert(minDelta != VK_WHOLE_SIZE);
-
-  allocations.emplace_back(min->Begin,
-                           (min->Begin + size));
-
-  if (min->Begin == usage)
-  {
-    usage += size;
-  }
-
-  auto find = std::find_if(std::begin(freed),
-                           std::end(freed),
-                           [begin = min->Begin](const Range &range)
-                           {
-                             return range.Begin == begin;
-                           });
-
-  if (find != std::end(freed))
-  {
-    if ((find->End - find->Begin) == size)
-    {
-      freed.erase(find);
-    }
-    else
-    {
-      find->Begin = find->Begin + size;
-    }
-  }
-
-  return min->Begin;
+  return allocator->Allocate(size,
+                             alignment ? alignment : this->alignment);
 }
 
 void lpe::rendering::Chunk::FreeMarker(vk::DeviceSize offset)
 {
-  auto iter = std::find_if(std::begin(allocations),
-                           std::end(allocations),
-                           [offset = offset](const Range &r)
-                           {
-                             return r.Begin == offset;
-                           });
-
-  assert(iter != std::end(allocations));
-
-  auto begin = std::find_if(std::begin(freed),
-                            std::end(freed),
-                            [begin = iter->Begin](const Range &r)
-                            {
-                              return begin == r.End;
-                            });
-
-  auto end = std::find_if(std::begin(freed),
-                          std::end(freed),
-                          [end = iter->End](const Range &r)
-                          {
-                            return end == r.Begin;
-                          });
-
-  if (begin != std::end(freed))
-  {
-    begin->End = iter->End;
-  }
-
-  if (end != std::end(freed))
-  {
-    end->Begin = iter->Begin;
-  }
-
-  bool erase = begin != std::end(freed) && begin->End == usage;
-  if (erase)
-  {
-    usage = begin->Begin;
-  }
-
-  if ((begin == std::end(freed)) &&
-      (end == std::end(freed)))
-  {
-    freed.emplace_back(iter->Begin,
-                       iter->End);
-  }
-
-  if (erase)
-  {
-    freed.erase(begin);
-  }
-
-  allocations.erase(iter);
+  allocator->Free(offset);
 }
 
 bool lpe::rendering::VkMemoryManagement::Mapping::operator<(const Mapping &other) const
@@ -288,6 +226,9 @@ lpe::rendering::Chunk &lpe::rendering::VkMemoryManagement::GetCurrentChunk(vk::P
       {
         manager->Log("Required size of image is larger than default size.");
       }
+
+      // the chunk's allocator has to be able to place the image at all
+      requirements.size = CreateSubAllocator(policy)->GetRequiredSize(requirements.size, requirements.alignment);
     }
     else
     {
@@ -297,7 +238,8 @@ lpe::rendering::Chunk &lpe::rendering::VkMemoryManagement::GetCurrentChunk(vk::P
     chunk.Create(device,
                  physicalDevice,
                  requirements,
-                 properties);
+                 properties,
+                 policy);
   }
 
   return chunk;
@@ -306,6 +248,7 @@ lpe::rendering::Chunk &lpe::rendering::VkMemoryManagement::GetCurrentChunk(vk::P
 lpe::rendering::VkMemoryManagement::VkMemoryManagement(const VkMemoryManagement &other)
   : defaultSize(other.defaultSize),
     device(other.device),
+    policy(other.policy),
     chunks(other.chunks),
     mappings(other.mappings)
 {
@@ -314,6 +257,7 @@ lpe::rendering::VkMemoryManagement::VkMemoryManagement(const VkMemoryManagement
 lpe::rendering::VkMemoryManagement::VkMemoryManagement(VkMemoryManagement &&other) noexcept
   : defaultSize(other.defaultSize),
     device(std::move(other.device)),
+    policy(other.policy),
     chunks(std::move(other.chunks)),
     mappings(std::move(other.mappings))
 {
@@ -325,6 +269,7 @@ lpe::rendering::VkMemoryManagement &lpe::rendering::VkMemoryManagement::operator
   { return *this; }
   defaultSize = other.defaultSize;
   device = other.device;
+  policy = other.policy;
   chunks = other.chunks;
   mappings = other.mappings;
   return *this;
@@ -336,16 +281,19 @@ lpe::rendering::VkMemoryManagement &lpe::rendering::VkMemoryManagement::operator
   { return *this; }
   defaultSize = other.defaultSize;
   device = std::move(other.device);
+  policy = other.policy;
   chunks = std::move(other.chunks);
   mappings = std::move(other.mappings);
   return *this;
 }
 
 void lpe::rendering::VkMemoryManagement::Create(vk::Device device,
-                                             vk::DeviceSize defaultSize)
+                                             vk::DeviceSize defaultSize,
+                                             AllocationPolicy policy)
 {
   this->device = device;
   this->defaultSize = defaultSize;
+  this->policy = policy;
 
   chunks.emplace_back();
 }
@@ -357,11 +305,17 @@ vk::DeviceSize lpe::rendering::VkMemoryManagement::Bind(vk::PhysicalDevice physi
   assert(device);
 
   auto requirements = device.getImageMemoryRequirements(image);
-  auto chunk = GetCurrentChunk(physicalDevice,
+  auto& chunk = GetCurrentChunk(physicalDevice,
                                requirements,
                                properties);
 
-  auto offset = chunk.MoveMarker(requirements.size);
+  auto offset = chunk.MoveMarker(requirements.size,
+                                 requirements.alignment);
+  if (offset == ISubAllocator::InvalidOffset)
+  {
+    return VK_WHOLE_SIZE;
+  }
+
   device.bindImageMemory(image,
                          chunk,
                          offset);
@@ -382,11 +336,17 @@ vk::DeviceSize lpe::rendering::VkMemoryManagement::Bind(vk::PhysicalDevice physi
   assert(device);
 
   auto requirements = device.getBufferMemoryRequirements(buffer);
-  auto chunk = GetCurrentChunk(physicalDevice,
+  auto& chunk = GetCurrentChunk(physicalDevice,
                                requirements,
                                properties);
 
-  auto offset = chunk.MoveMarker(requirements.size);
+  auto offset = chunk.MoveMarker(requirements.size,
+                                 requirements.alignment);
+  if (offset == ISubAllocator::InvalidOffset)
+  {
+    return VK_WHOLE_SIZE;
+  }
+
   device.bindBufferMemory(buffer,
                           chunk,
                           offset);
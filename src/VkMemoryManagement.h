@@ -1,6 +1,7 @@
 #pragma once
 #include <vulkan/vulkan.hpp>
 #include <map>
+#include "SubAllocator.h"
 
 namespace lpe
 {
@@ -25,51 +26,41 @@ namespace lpe
     class Chunk
     {
     private:
-      struct Range
-      {
-        vk::DeviceSize Begin;
-        vk::DeviceSize End;
-
-        Range() = default;
-
-        Range(vk::DeviceSize begin,
-              vk::DeviceSize end)
-          : Begin(begin),
-            End(end)
-        {
-        }
-      };
-
       vk::DeviceMemory memory;
       vk::DeviceSize size;
       vk::DeviceSize alignment;
       vk::MemoryPropertyFlagBits properties;
       vk::Device device;
-      vk::DeviceSize usage;
-      std::vector<Range> allocations;
-      std::vector<Range> freed;
+      std::unique_ptr<ISubAllocator> allocator;
     public:
       Chunk();
-      Chunk(const Chunk& other) = default;
+      Chunk(const Chunk& other);
       Chunk(Chunk&& other) noexcept = default;
-      Chunk& operator=(const Chunk& other) = default;
+      Chunk& operator=(const Chunk& other);
       Chunk& operator=(Chunk&& other) noexcept = default;
       ~Chunk();
 
       const vk::DeviceMemory& Create(vk::Device device,
                                      vk::PhysicalDevice physicalDevice,
                                      vk::MemoryRequirements requirements,
-                                     vk::MemoryPropertyFlagBits properties);
+                                     vk::MemoryPropertyFlagBits properties,
+                                     AllocationPolicy policy = AllocationPolicy::Tlsf);
       void Destroy();
 
       vk::DeviceSize GetUsage() const;
-      bool HasSpaceLeft(vk::DeviceSize delta) const;
+      bool HasSpaceLeft(vk::DeviceSize delta,
+                        vk::DeviceSize alignment = 0) const;
 
       operator bool() const;
       bool operator!() const;
       operator vk::DeviceMemory() const;
 
-      vk::DeviceSize MoveMarker(vk::DeviceSize size);
+      /**
+       * \brief Sub allocation with the policy of the chunk, alignment 0 uses the alignment of the chunk requirements
+       * \return offset or ISubAllocator::InvalidOffset if the chunk is full or has no memory
+       */
+      vk::DeviceSize MoveMarker(vk::DeviceSize size,
+                                vk::DeviceSize alignment = 0);
       void FreeMarker(vk::DeviceSize offset);
     };
 
@@ -99,6 +90,7 @@ namespace lpe
 
       vk::DeviceSize defaultSize;
       vk::Device device;
+      AllocationPolicy policy;
       std::vector<Chunk> chunks;
       std::map<Mapping, ChunkOffset> mappings;
 
@@ -113,9 +105,16 @@ namespace lpe
       VkMemoryManagement& operator=(VkMemoryManagement&& other) noexcept;
       ~VkMemoryManagement() = default;
 
+      /**
+       * \brief policy decides how the chunks of this pool place their sub allocations
+       */
       void Create(vk::Device device,
-                  vk::DeviceSize defaultSize);
+                  vk::DeviceSize defaultSize,
+                  AllocationPolicy policy = AllocationPolicy::Tlsf);
 
+      /**
+       * \return offset inside the chunk or VK_WHOLE_SIZE if no memory could be allocated
+       */
       vk::DeviceSize Bind(vk::PhysicalDevice physicalDevice,
                           vk::Image& image,
                           vk::MemoryPropertyFlagBits properties = vk::MemoryPropertyFlagBits::eDeviceLocal);
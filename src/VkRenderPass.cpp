@@ -37,6 +37,14 @@ vk::AttachmentDescription lpe::rendering::Attachment::GetAttachmentDescription()
   return { Flags, Format, Samples, LoadOp, StoreOp, StencilLoadOp, StencilStoreOp, InitialLayout, FinalLayout };
 }
 
+bool lpe::rendering::Attachment::IsTransient() const
+{
+  return LoadOp != vk::AttachmentLoadOp::eLoad &&
+         StencilLoadOp != vk::AttachmentLoadOp::eLoad &&
+         StoreOp == vk::AttachmentStoreOp::eDontCare &&
+         StencilStoreOp == vk::AttachmentStoreOp::eDontCare;
+}
+
 lpe::rendering::Attachment::operator bool() const
 {
   return ImageView && Flags;
@@ -138,6 +146,7 @@ lpe::rendering::RenderPass::RenderPass()
   attachments = {};
   subpasses = {};
   renderPass = nullptr;
+  allocator = nullptr;
   currentFrameBuffer = nullptr;
   currentCmdBuffer = nullptr;
   state = RenderPassState::Creating;
@@ -160,6 +169,7 @@ lpe::rendering::RenderPass& lpe::rendering::RenderPass::operator=(const RenderPa
   this->subpasses = { other.subpasses };
 
   this->renderPass = other.renderPass;
+  this->allocator = other.allocator;
   this->currentFrameBuffer = other.currentFrameBuffer;
   this->currentCmdBuffer = other.currentCmdBuffer;
   this->state = other.state;
@@ -174,6 +184,7 @@ lpe::rendering::RenderPass& lpe::rendering::RenderPass::operator=(RenderPass&& o
   this->subpasses = std::move(other.subpasses);
 
   this->renderPass = other.renderPass;
+  this->allocator = other.allocator;
   this->currentFrameBuffer = other.currentFrameBuffer;
   this->currentCmdBuffer = other.currentCmdBuffer;
   this->state = other.state;
@@ -260,7 +271,8 @@ void lpe::rendering::RenderPass::AddSubpassDependency(uint32_t srcSubpass,
                                    dependencyFlags);
 }
 
-const vk::RenderPass& lpe::rendering::RenderPass::Create(vk::Device device)
+const vk::RenderPass& lpe::rendering::RenderPass::Create(vk::Device device,
+                                                       const vk::AllocationCallbacks* allocator)
 {
   assert(state == RenderPassState::Creating);
 
@@ -349,8 +361,10 @@ const vk::RenderPass& lpe::rendering::RenderPass::Create(vk::Device device)
     subpassDependencies.data()
   };
 
+  this->allocator = allocator;
+
   auto result = device.createRenderPass(&createInfo,
-                                        nullptr,
+                                        allocator,
                                         &renderPass);
 
   assert(result == vk::Result::eSuccess);
@@ -367,7 +381,7 @@ const vk::Framebuffer& lpe::rendering::RenderPass::CreateFrameBuffer(vk::Device
 {
   assert(state == RenderPassState::Created && renderPass);
 
-  std::vector<vk::ImageView> views;
+  auto& views = frameBufferViews;
   views.resize(attachments.size());
 
   for (uint32_t i = 0; i < attachments.size(); ++i)
@@ -403,7 +417,7 @@ const vk::Framebuffer& lpe::rendering::RenderPass::CreateFrameBuffer(vk::Device
   };
 
   auto result = device.createFramebuffer(&createInfo,
-                                         nullptr,
+                                         allocator,
                                          &currentFrameBuffer);
 
   assert(result == vk::Result::eSuccess);
@@ -413,7 +427,7 @@ const vk::Framebuffer& lpe::rendering::RenderPass::CreateFrameBuffer(vk::Device
 
 void lpe::rendering::RenderPass::Begin(vk::CommandBuffer cmdBuffer,
                                     vk::Rect2D renderArea,
-                                    std::vector<vk::ClearValue> clearValues,
+                                    vk::ArrayProxy<const vk::ClearValue> clearValues,
                                     vk::SubpassContents contents)
 {
   assert((state == RenderPassState::Created || state == RenderPassState::Ended) && currentFrameBuffer && renderPass);
@@ -423,7 +437,7 @@ void lpe::rendering::RenderPass::Begin(vk::CommandBuffer cmdBuffer,
     renderPass,
     currentFrameBuffer,
     renderArea,
-    static_cast<uint32_t>(clearValues.size()),
+    clearValues.size(),
     clearValues.data()
   };
 
@@ -449,7 +463,7 @@ void lpe::rendering::RenderPass::End(vk::Device device)
   currentCmdBuffer.endRenderPass();
 
   device.destroyFramebuffer(currentFrameBuffer,
-                            nullptr);
+                            allocator);
   currentFrameBuffer = nullptr;
   currentCmdBuffer = nullptr;
 
@@ -463,11 +477,12 @@ void lpe::rendering::RenderPass::Destroy(vk::Device device)
   if (currentFrameBuffer)
   {
     device.destroyFramebuffer(currentFrameBuffer,
-                              nullptr);
+                              allocator);
     currentFrameBuffer = nullptr;
   }
 
   device.destroyRenderPass(renderPass,
-                           nullptr);
+                           allocator);
   renderPass = nullptr;
+  allocator = nullptr;
 }
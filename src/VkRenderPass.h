@@ -45,7 +45,11 @@ namespace lpe
       std::vector<Attachment> attachments;
       std::vector<SubpassParameters> subpasses;
 
+      // reused by every CreateFrameBuffer, so recording a frame doesn't allocate
+      std::vector<vk::ImageView> frameBufferViews;
+
       vk::RenderPass renderPass;
+      const vk::AllocationCallbacks* allocator;
       vk::Framebuffer currentFrameBuffer;
       vk::CommandBuffer currentCmdBuffer;
       RenderPassState state;
@@ -92,14 +96,21 @@ namespace lpe
                                 vk::AccessFlags dstAccessMask,
                                 vk::DependencyFlags dependencyFlags);
 
-      const vk::RenderPass& Create(vk::Device device);
+      /**
+       * \param allocator host memory callbacks of the device, used for the frame buffers and Destroy as well
+       */
+      const vk::RenderPass& Create(vk::Device device,
+                                   const vk::AllocationCallbacks* allocator = nullptr);
       const vk::Framebuffer& CreateFrameBuffer(vk::Device device,
                                                uint32_t width,
                                                uint32_t height,
                                                uint32_t layers);
+      /**
+       * \param clearValues vector, array or initializer list, only read during the call
+       */
       void Begin(vk::CommandBuffer cmdBuffer,
                  vk::Rect2D renderArea,
-                 std::vector<vk::ClearValue> clearValues,
+                 vk::ArrayProxy<const vk::ClearValue> clearValues,
                  vk::SubpassContents contents);
       void NextSubpass(vk::SubpassContents contents);
       void End(vk::Device device);
@@ -0,0 +1,281 @@
+#include "AliasedRenderTargets.hpp"
+#include "VulkanManager.hpp"
+#include "../ServiceLocator.h"
+
+#include <algorithm>
+
+namespace
+{
+  const vk::AccessFlags WriteAccess = vk::AccessFlagBits::eColorAttachmentWrite |
+                                      vk::AccessFlagBits::eDepthStencilAttachmentWrite |
+                                      vk::AccessFlagBits::eShaderWrite |
+                                      vk::AccessFlagBits::eTransferWrite;
+
+  void GetStagesAndAccess(vk::ImageAspectFlags aspectFlags,
+                          vk::ImageUsageFlags usage,
+                          vk::PipelineStageFlags& stages,
+                          vk::AccessFlags& access)
+  {
+    if (aspectFlags & vk::ImageAspectFlagBits::eColor)
+    {
+      stages = vk::PipelineStageFlagBits::eColorAttachmentOutput;
+      access = vk::AccessFlagBits::eColorAttachmentRead | vk::AccessFlagBits::eColorAttachmentWrite;
+    }
+    else
+    {
+      stages = vk::PipelineStageFlagBits::eEarlyFragmentTests | vk::PipelineStageFlagBits::eLateFragmentTests;
+      access = vk::AccessFlagBits::eDepthStencilAttachmentRead | vk::AccessFlagBits::eDepthStencilAttachmentWrite;
+    }
+
+    if (usage & (vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eStorage))
+    {
+      stages |= vk::PipelineStageFlagBits::eFragmentShader | vk::PipelineStageFlagBits::eComputeShader;
+      access |= vk::AccessFlagBits::eShaderRead;
+    }
+
+    if (usage & vk::ImageUsageFlagBits::eStorage)
+    {
+      access |= vk::AccessFlagBits::eShaderWrite;
+    }
+
+    if (usage & vk::ImageUsageFlagBits::eInputAttachment)
+    {
+      stages |= vk::PipelineStageFlagBits::eFragmentShader;
+      access |= vk::AccessFlagBits::eInputAttachmentRead;
+    }
+
+    if (usage & (vk::ImageUsageFlagBits::eTransferSrc | vk::ImageUsageFlagBits::eTransferDst))
+    {
+      stages |= vk::PipelineStageFlagBits::eTransfer;
+      access |= vk::AccessFlagBits::eTransferRead | vk::AccessFlagBits::eTransferWrite;
+    }
+  }
+}
+
+lpe::rendering::vulkan::AliasedRenderTargets::AliasedRenderTargets()
+{
+  this->device = nullptr;
+  this->memory = nullptr;
+  this->offset = 0;
+}
+
+uint32_t lpe::rendering::vulkan::AliasedRenderTargets::Add(const Attachment& attachment,
+                                                           uint32_t width,
+                                                           uint32_t height,
+                                                           uint32_t firstPass,
+                                                           uint32_t lastPass,
+                                                           vk::ImageUsageFlags usage)
+{
+  assert(!memory);
+  assert(firstPass <= lastPass);
+
+  Target target = {};
+  target.attachment = attachment;
+  target.width = width;
+  target.height = height;
+  target.firstPass = firstPass;
+  target.lastPass = lastPass;
+  target.usage = usage;
+
+  targets.push_back(target);
+
+  return static_cast<uint32_t>(targets.size() - 1);
+}
+
+bool lpe::rendering::vulkan::AliasedRenderTargets::Create(std::shared_ptr<VulkanManager>&& manager)
+{
+  assert(!memory);
+
+  this->logger = lpe::ServiceLocator::LogManager.Get();
+  this->manager = manager;
+  this->device = manager->GetDevice();
+
+  planner.Clear();
+  aliases.clear();
+
+  uint32_t memoryTypeBits = UINT32_MAX;
+  vk::DeviceSize alignment = 1;
+  bool result = true;
+
+  for (auto&& target : targets)
+  {
+    target.image.SetUsage(target.usage)
+                .SetAttachment(target.attachment, target.width, target.height);
+
+    if (!target.image.CreateImage(manager))
+    {
+      result = false;
+      break;
+    }
+
+    auto requirements = device.getImageMemoryRequirements(target.image.GetImage());
+    memoryTypeBits &= requirements.memoryTypeBits;
+    alignment = std::max(alignment, requirements.alignment);
+
+    planner.Add(requirements.size, requirements.alignment, target.firstPass, target.lastPass);
+
+    GetStagesAndAccess(common::GetAspectFlags(target.attachment.Format),
+                       target.usage,
+                       target.stages,
+                       target.access);
+  }
+
+  if (result && !targets.empty())
+  {
+    vk::MemoryRequirements requirements = { planner.Plan(), alignment, memoryTypeBits };
+
+    // all targets live in one range, so they need a memory type every one of them accepts
+    offset = memoryTypeBits != 0 ?
+             manager->GetDeviceMemory().AllocateRange(requirements,
+                                                      vk::MemoryPropertyFlagBits::eDeviceLocal,
+                                                      memory,
+                                                      LPE_MEMORY_TAG("aliased render targets"),
+                                                      true) :
+             VK_WHOLE_SIZE;
+
+    result = offset != VK_WHOLE_SIZE;
+  }
+
+  for (uint32_t i = 0; i < targets.size() && result; ++i)
+  {
+    auto& target = targets[i];
+
+    device.bindImageMemory(target.image.GetImage(), memory, offset + planner.GetOffset(i));
+
+    result = target.image.CreateView();
+    target.attachment.ImageView = target.image.GetImageView();
+
+    aliases.push_back(planner.GetAliases(i));
+
+    // the implicit external dependency of a render pass starts at eTopOfPipe and doesn't chain with the
+    // barrier on the aliases, so RecordBarriers does the transition and the render pass starts in the subpass layout
+    if (!aliases[i].empty() && target.attachment.InitialLayout == vk::ImageLayout::eUndefined)
+    {
+      target.attachment.InitialLayout = target.attachment.Layout;
+    }
+  }
+
+  if (!result)
+  {
+    auto logPtr = logger.lock();
+    if (logPtr)
+    {
+      logPtr->Log("Could not create aliased render targets");
+    }
+
+    Destroy();
+
+    return false;
+  }
+
+  return true;
+}
+
+void lpe::rendering::vulkan::AliasedRenderTargets::Destroy()
+{
+  for (auto&& target : targets)
+  {
+    target.image.Destroy();
+  }
+
+  if (memory)
+  {
+    auto vulkan = manager.lock();
+    if (vulkan)
+    {
+      vulkan->GetDeviceMemory().FreeRange(memory, offset);
+    }
+
+    memory = nullptr;
+  }
+
+  targets.clear();
+  aliases.clear();
+  imageBarriers.clear();
+  planner.Clear();
+
+  offset = 0;
+  device = nullptr;
+  manager.reset();
+}
+
+void lpe::rendering::vulkan::AliasedRenderTargets::RecordBarriers(vk::CommandBuffer commandBuffer,
+                                                                  uint32_t pass)
+{
+  assert(aliases.size() == targets.size());
+
+  vk::PipelineStageFlags srcStages = {};
+  vk::PipelineStageFlags dstStages = {};
+
+  imageBarriers.clear();
+
+  for (uint32_t i = 0; i < targets.size(); ++i)
+  {
+    auto& target = targets[i];
+    if (target.firstPass != pass || aliases[i].empty())
+    {
+      continue;
+    }
+
+    vk::PipelineStageFlags waitStages = {};
+    vk::AccessFlags waitAccess = {};
+    for (auto alias : aliases[i])
+    {
+      waitStages |= targets[alias].stages;
+      waitAccess |= targets[alias].access & WriteAccess;
+    }
+
+    srcStages |= waitStages;
+    dstStages |= target.stages;
+
+    imageBarriers.push_back({
+                              waitAccess,
+                              target.access,
+                              vk::ImageLayout::eUndefined,
+                              target.attachment.InitialLayout,
+                              VK_QUEUE_FAMILY_IGNORED,
+                              VK_QUEUE_FAMILY_IGNORED,
+                              target.image.GetImage(),
+                              { common::GetAspectFlags(target.attachment.Format), 0, 1, 0, 1 }
+                            });
+  }
+
+  if (!srcStages)
+  {
+    return;
+  }
+
+  commandBuffer.pipelineBarrier(srcStages,
+                                dstStages,
+                                {},
+                                0,
+                                nullptr,
+                                0,
+                                nullptr,
+                                static_cast<uint32_t>(imageBarriers.size()),
+                                imageBarriers.data());
+}
+
+lpe::rendering::vulkan::VulkanImage& lpe::rendering::vulkan::AliasedRenderTargets::GetImage(uint32_t index)
+{
+  assert(index < targets.size());
+
+  return targets[index].image;
+}
+
+const lpe::rendering::Attachment& lpe::rendering::vulkan::AliasedRenderTargets::GetAttachment(uint32_t index) const
+{
+  assert(index < targets.size());
+
+  return targets[index].attachment;
+}
+
+vk::DeviceSize lpe::rendering::vulkan::AliasedRenderTargets::GetSize() const
+{
+  return planner.GetSize();
+}
+
+vk::DeviceSize lpe::rendering::vulkan::AliasedRenderTargets::GetUnaliasedSize() const
+{
+  return planner.GetUnaliasedSize();
+}
@@ -0,0 +1,129 @@
+#ifndef LOWPOLYENGINE_ALIASEDRENDERTARGETS_HPP
+#define LOWPOLYENGINE_ALIASEDRENDERTARGETS_HPP
+
+#include "VulkanImage.hpp"
+#include "../AliasingPlanner.h"
+
+namespace lpe
+{
+namespace rendering
+{
+namespace vulkan
+{
+
+/*!
+ * Render targets of one frame (shadow maps, post process buffers, temporary attachments) in one shared
+ * memory range. Every target declares the passes it is used in, targets which are never alive at the same
+ * time get the same bytes (see AliasingPlanner).
+ *
+ * Aliased contents don't survive, the first pass of a target sees garbage and has to clear or overwrite it.
+ * RecordBarriers at the start of every pass makes the memory safe to reuse: it waits for the aliases of the
+ * targets which start in the pass, including their use in later passes of the previous frame (a pipeline
+ * barrier covers everything submitted before on the queue).
+ *
+ * Usage: Add every target, Create, then per frame and pass RecordBarriers before the render pass.
+ * On resize Destroy, Add again with the new size and Create.
+ */
+class AliasedRenderTargets
+{
+private:
+  struct Target
+  {
+    Attachment attachment;
+    uint32_t width;
+    uint32_t height;
+    uint32_t firstPass;
+    uint32_t lastPass;
+    vk::ImageUsageFlags usage;
+    vk::PipelineStageFlags stages;  // of all uses, waited on by the aliases
+    vk::AccessFlags access;
+    VulkanImage image;
+  };
+
+  std::weak_ptr<VulkanManager> manager;
+  std::weak_ptr<lpe::utils::log::ILogManager> logger;
+
+  vk::Device device;
+  vk::DeviceMemory memory;
+  vk::DeviceSize offset;
+
+  AliasingPlanner planner;
+  std::vector<Target> targets;
+  std::vector<std::vector<uint32_t>> aliases;
+
+  std::vector<vk::ImageMemoryBarrier> imageBarriers;  // reused by RecordBarriers
+
+public:
+  AliasedRenderTargets();
+  AliasedRenderTargets(const AliasedRenderTargets& other) = delete;
+  AliasedRenderTargets(AliasedRenderTargets&& other) noexcept = delete;
+  AliasedRenderTargets& operator=(const AliasedRenderTargets& other) = delete;
+  AliasedRenderTargets& operator=(AliasedRenderTargets&& other) noexcept = delete;
+  ~AliasedRenderTargets() = default;
+
+  /*!
+   * @param attachment format, samples, ops and layouts of the target (see VulkanImage::SetAttachment)
+   * @param width
+   * @param height
+   * @param firstPass index of the first pass of the frame which writes or reads the target
+   * @param lastPass index of the last pass, inclusive
+   * @param usage besides the attachment usage, e.g. eSampled for a shadow map
+   * @return index of the target
+   */
+  uint32_t Add(const Attachment& attachment,
+               uint32_t width,
+               uint32_t height,
+               uint32_t firstPass,
+               uint32_t lastPass,
+               vk::ImageUsageFlags usage = vk::ImageUsageFlagBits::eSampled);
+
+  /*!
+   * Creates the images, plans the offsets and binds all of them to one range of the GeneralPurposeAllocator
+   *
+   * @param manager
+   * @return false if an image or the memory couldn't be created, everything is destroyed like by Destroy then
+   */
+  bool Create(std::shared_ptr<VulkanManager>&& manager);
+
+  /*!
+   * Destroys the images and frees the memory, the added targets are forgotten.
+   * The GPU must be done with all frames using them.
+   */
+  void Destroy();
+
+  /*!
+   * Records one pipeline barrier for the targets whose first pass is pass and which share memory with other
+   * targets: their aliases' writes are finished and the targets get transitioned from eUndefined to their
+   * initial layout (the contents are discarded anyway). Aliased targets added with an eUndefined initial layout
+   * start in their subpass layout instead, see GetAttachment. Nothing gets recorded if no target needs it.
+   *
+   * @param commandBuffer
+   * @param pass
+   */
+  void RecordBarriers(vk::CommandBuffer commandBuffer,
+                      uint32_t pass);
+
+  VulkanImage& GetImage(uint32_t index);
+
+  /*!
+   * The attachment of Add with the ImageView of the created image, ready for RenderPass::AddAttachment.
+   * The initial layout of aliased targets is their subpass layout if Add got eUndefined.
+   */
+  const Attachment& GetAttachment(uint32_t index) const;
+
+  /*!
+   * Memory of all targets together
+   */
+  vk::DeviceSize GetSize() const;
+
+  /*!
+   * Memory the targets would need with one allocation each
+   */
+  vk::DeviceSize GetUnaliasedSize() const;
+};
+
+} // vulkan
+} // rendering
+} // lpe
+
+#endif //LOWPOLYENGINE_ALIASEDRENDERTARGETS_HPP
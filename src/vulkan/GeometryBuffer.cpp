@@ -0,0 +1,337 @@
+#include "GeometryBuffer.hpp"
+#include "VulkanManager.hpp"
+#include "../ServiceLocator.h"
+
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+
+lpe::rendering::vulkan::GeometryBuffer::GeometryBuffer()
+{
+  this->device = nullptr;
+  this->allocator = nullptr;
+  this->vertexBuffer = nullptr;
+  this->indexBuffer = nullptr;
+  this->vertexCapacity = 0;
+  this->indexCapacity = 0;
+  this->framesInFlight = 2;
+  this->frame = 0;
+}
+
+bool lpe::rendering::vulkan::GeometryBuffer::Create(std::shared_ptr<VulkanManager>&& manager,
+                                                    uint32_t vertexCapacity,
+                                                    uint32_t indexCapacity,
+                                                    AllocationPolicy policy,
+                                                    uint32_t framesInFlight)
+{
+  assert(vertexCapacity > 0 && indexCapacity > 0);
+
+  this->logger = lpe::ServiceLocator::LogManager.Get();
+  this->manager = manager;
+  this->device = manager->GetDevice();
+  this->allocator = manager->GetAllocationCallbacks();
+  this->vertexCapacity = vertexCapacity;
+  this->indexCapacity = indexCapacity;
+  this->framesInFlight = framesInFlight;
+  this->frame = 0;
+
+  this->vertexBuffer = common::CreateBuffer(device,
+                                            vertexCapacity * sizeof(Vertex),
+                                            vk::BufferUsageFlagBits::eVertexBuffer | vk::BufferUsageFlagBits::eStorageBuffer |
+                                            vk::BufferUsageFlagBits::eTransferDst,
+                                            nullptr,
+                                            0,
+                                            allocator);
+  this->indexBuffer = common::CreateBuffer(device,
+                                           indexCapacity * sizeof(uint32_t),
+                                           vk::BufferUsageFlagBits::eIndexBuffer | vk::BufferUsageFlagBits::eStorageBuffer |
+                                           vk::BufferUsageFlagBits::eTransferDst,
+                                           nullptr,
+                                           0,
+                                           allocator);
+
+  auto& memory = manager->GetDeviceMemory();
+
+  bool result = vertexBuffer && indexBuffer &&
+                memory.Bind(vertexBuffer, vk::MemoryPropertyFlagBits::eDeviceLocal, LPE_MEMORY_TAG("GeometryBuffer vertices")) != VK_WHOLE_SIZE &&
+                memory.Bind(indexBuffer, vk::MemoryPropertyFlagBits::eDeviceLocal, LPE_MEMORY_TAG("GeometryBuffer indices")) != VK_WHOLE_SIZE;
+
+  if (!result)
+  {
+    auto logPtr = logger.lock();
+    if (logPtr)
+    {
+      logPtr->Log("Could not initialize GeometryBuffer");
+    }
+
+    Destroy();
+
+    return false;
+  }
+
+  vertices = CreateSubAllocator(policy);
+  vertices->Create(vertexCapacity);
+
+  indices = CreateSubAllocator(policy);
+  indices->Create(indexCapacity);
+
+  return true;
+}
+
+void lpe::rendering::vulkan::GeometryBuffer::Destroy()
+{
+  auto vulkan = manager.lock();
+
+  for (auto buffer : { &vertexBuffer, &indexBuffer })
+  {
+    if (*buffer)
+    {
+      if (vulkan)
+      {
+        vulkan->GetDeviceMemory().Free(*buffer);
+      }
+
+      device.destroyBuffer(*buffer, allocator);
+      *buffer = nullptr;
+    }
+  }
+
+  vertices.reset();
+  indices.reset();
+  pending.clear();
+  retired.clear();
+
+  vertexCapacity = 0;
+  indexCapacity = 0;
+
+  logger.reset();
+  manager.reset();
+}
+
+lpe::rendering::vulkan::GeometryRange lpe::rendering::vulkan::GeometryBuffer::Add(const Mesh& mesh)
+{
+  assert(vertices && indices);
+
+  GeometryRange range = {};
+
+  auto vertexCount = static_cast<uint32_t>(mesh.GetVertices().size());
+  auto indexCount = mesh.GetIndices().empty() ?
+                    vertexCount :
+                    static_cast<uint32_t>(mesh.GetIndices().size());
+
+  if (vertexCount == 0 || indexCount == 0)
+  {
+    return range;
+  }
+
+  auto vertexOffset = vertices->Allocate(vertexCount);
+  auto firstIndex = vertexOffset != ISubAllocator::InvalidOffset ?
+                    indices->Allocate(indexCount) :
+                    ISubAllocator::InvalidOffset;
+
+  if (firstIndex == ISubAllocator::InvalidOffset)
+  {
+    if (vertexOffset != ISubAllocator::InvalidOffset)
+    {
+      vertices->Free(vertexOffset);
+    }
+
+    auto logPtr = logger.lock();
+    if (logPtr)
+    {
+      logPtr->Log("GeometryBuffer is full");
+    }
+
+    return range;
+  }
+
+  range = { static_cast<int32_t>(vertexOffset), vertexCount, static_cast<uint32_t>(firstIndex), indexCount };
+
+  Pending item = { range, mesh.GetVertices(), mesh.GetIndices() };
+  if (item.indices.empty())
+  {
+    item.indices.resize(indexCount);
+    std::iota(std::begin(item.indices), std::end(item.indices), 0u);
+  }
+
+  pending.push_back(std::move(item));
+
+  return range;
+}
+
+void lpe::rendering::vulkan::GeometryBuffer::Remove(const GeometryRange& range)
+{
+  if (range.indexCount == 0)
+  {
+    return;
+  }
+
+  auto item = std::find_if(std::begin(pending),
+                           std::end(pending),
+                           [&range](const Pending& item)
+                           {
+                             return item.range.firstIndex == range.firstIndex;
+                           });
+
+  // never uploaded, so no frame can draw it
+  if (item != std::end(pending))
+  {
+    pending.erase(item);
+    Release(range);
+
+    return;
+  }
+
+  // frames in flight may still draw the mesh, a Flush into the ranges would overwrite it
+  retired.push_back({ range, frame });
+}
+
+void lpe::rendering::vulkan::GeometryBuffer::Release(const GeometryRange& range)
+{
+  vertices->Free(static_cast<uint64_t>(range.vertexOffset));
+  indices->Free(range.firstIndex);
+}
+
+uint32_t lpe::rendering::vulkan::GeometryBuffer::Flush()
+{
+  ++frame;
+
+  for (size_t i = 0; i < retired.size();)
+  {
+    if (frame >= retired[i].frame + framesInFlight)
+    {
+      Release(retired[i].range);
+
+      retired[i] = retired.back();
+      retired.pop_back();
+    }
+    else
+    {
+      ++i;
+    }
+  }
+
+  auto vulkan = manager.lock();
+  if (!vulkan || pending.empty())
+  {
+    return 0;
+  }
+
+  auto& allocator = vulkan->GetDeviceLocalMemory();
+  assert(allocator.GetMappedData());
+
+  std::vector<Pending> uploading;
+  std::vector<Pending> deferred;
+  std::vector<vk::BufferCopy> vertexCopies;
+  std::vector<vk::BufferCopy> indexCopies;
+
+  for (auto&& item : pending)
+  {
+    vk::DeviceSize vertexSize = item.vertices.size() * sizeof(Vertex);
+    vk::DeviceSize indexSize = item.indices.size() * sizeof(uint32_t);
+
+    // + padding of both alignments
+    if (!allocator.Fits(vertexSize + indexSize + 2 * sizeof(uint32_t)))
+    {
+      deferred.push_back(std::move(item));
+      continue;
+    }
+
+    auto vertexStaging = allocator.Allocate(vertexSize,
+                                            sizeof(uint32_t),
+                                            uploading.empty() ? MarkerPosition::Before : MarkerPosition::None);
+    memcpy(vertexStaging.data, item.vertices.data(), vertexSize);
+    allocator.Flush(vertexStaging.offset, vertexSize);
+
+    auto indexStaging = allocator.Allocate(indexSize, sizeof(uint32_t));
+    memcpy(indexStaging.data, item.indices.data(), indexSize);
+    allocator.Flush(indexStaging.offset, indexSize);
+
+    vertexCopies.push_back({ vertexStaging.offset, item.range.vertexOffset * sizeof(Vertex), vertexSize });
+    indexCopies.push_back({ indexStaging.offset, item.range.firstIndex * sizeof(uint32_t), indexSize });
+
+    uploading.push_back(std::move(item));
+  }
+
+  pending = std::move(deferred);
+
+  if (uploading.empty())
+  {
+    auto logPtr = logger.lock();
+    if (logPtr)
+    {
+      logPtr->Log("Mesh does not fit into the staging memory");
+    }
+
+    return 0;
+  }
+
+  bool uploaded = false;
+
+  auto commandBuffer = vulkan->BeginSingleTimeCommands();
+  if (commandBuffer)
+  {
+    commandBuffer.copyBuffer(allocator.GetBuffer(), vertexBuffer, vertexCopies);
+    commandBuffer.copyBuffer(allocator.GetBuffer(), indexBuffer, indexCopies);
+
+    uploaded = vulkan->EndSingleTimeCommands(commandBuffer);
+  }
+
+  allocator.Pop();
+
+  if (!uploaded)
+  {
+    auto logPtr = logger.lock();
+    if (logPtr)
+    {
+      logPtr->Log("Could not upload the meshes of the GeometryBuffer");
+    }
+
+    // the ranges stay reserved, try again with the next Flush
+    std::move(std::begin(uploading), std::end(uploading), std::back_inserter(pending));
+
+    return 0;
+  }
+
+  return static_cast<uint32_t>(uploading.size());
+}
+
+void lpe::rendering::vulkan::GeometryBuffer::Bind(vk::CommandBuffer commandBuffer) const
+{
+  vk::DeviceSize offset = 0;
+
+  commandBuffer.bindVertexBuffers(0, 1, &vertexBuffer, &offset);
+  commandBuffer.bindIndexBuffer(indexBuffer, 0, vk::IndexType::eUint32);
+}
+
+vk::DrawIndexedIndirectCommand lpe::rendering::vulkan::GeometryBuffer::GetDrawCommand(const GeometryRange& range,
+                                                                                      uint32_t instanceCount,
+                                                                                      uint32_t firstInstance)
+{
+  return { range.indexCount, instanceCount, range.firstIndex, range.vertexOffset, firstInstance };
+}
+
+vk::Buffer lpe::rendering::vulkan::GeometryBuffer::GetVertexBuffer() const
+{
+  return vertexBuffer;
+}
+
+vk::Buffer lpe::rendering::vulkan::GeometryBuffer::GetIndexBuffer() const
+{
+  return indexBuffer;
+}
+
+uint32_t lpe::rendering::vulkan::GeometryBuffer::GetVertexUsage() const
+{
+  return vertices ? static_cast<uint32_t>(vertices->GetUsage()) : 0;
+}
+
+uint32_t lpe::rendering::vulkan::GeometryBuffer::GetIndexUsage() const
+{
+  return indices ? static_cast<uint32_t>(indices->GetUsage()) : 0;
+}
+
+size_t lpe::rendering::vulkan::GeometryBuffer::GetQueued() const
+{
+  return pending.size();
+}
@@ -0,0 +1,144 @@
+#ifndef LOWPOLYENGINE_GEOMETRYBUFFER_HPP
+#define LOWPOLYENGINE_GEOMETRYBUFFER_HPP
+
+#include "MemoryManagement.hpp"
+#include "../Mesh.h"
+
+namespace lpe
+{
+namespace rendering
+{
+namespace vulkan
+{
+
+/*!
+ * Place of a mesh inside the GeometryBuffer. Indices stay relative to the mesh,
+ * vertexOffset gets added by the draw. indexCount is 0 if the mesh didn't fit.
+ */
+struct GeometryRange
+{
+  int32_t vertexOffset;
+  uint32_t vertexCount;
+  uint32_t firstIndex;
+  uint32_t indexCount;
+};
+
+/*!
+ * One device local vertex buffer and one index buffer shared by all meshes, the meshes get ranges of them.
+ * All geometry is bound once per frame and draws only differ by {vertexOffset, firstIndex}, so
+ * they can be merged into one drawIndexedIndirect with a vk::DrawIndexedIndirectCommand per mesh
+ * (drawCount > 1 needs the multiDrawIndirect feature).
+ *
+ * Usage: Add meshes, Flush uploads them with one submit (once per frame), Bind and draw.
+ */
+class GeometryBuffer
+{
+private:
+  struct Pending
+  {
+    GeometryRange range;
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+  };
+
+  struct Retired
+  {
+    GeometryRange range;
+    uint64_t frame;
+  };
+
+  std::weak_ptr<VulkanManager> manager;
+  std::weak_ptr<lpe::utils::log::ILogManager> logger;
+
+  vk::Device device;
+  const vk::AllocationCallbacks* allocator;
+  vk::Buffer vertexBuffer;
+  vk::Buffer indexBuffer;
+  uint32_t vertexCapacity;
+  uint32_t indexCapacity;
+  uint32_t framesInFlight;
+  uint64_t frame;
+
+  // ranges in vertices and indices, not bytes
+  std::unique_ptr<ISubAllocator> vertices;
+  std::unique_ptr<ISubAllocator> indices;
+
+  std::vector<Pending> pending;
+  std::vector<Retired> retired;
+
+  void Release(const GeometryRange& range);
+
+public:
+  GeometryBuffer();
+  GeometryBuffer(const GeometryBuffer& other) = delete;
+  GeometryBuffer(GeometryBuffer&& other) noexcept = delete;
+  GeometryBuffer& operator=(const GeometryBuffer& other) = delete;
+  GeometryBuffer& operator=(GeometryBuffer&& other) noexcept = delete;
+  ~GeometryBuffer() = default;
+
+  /*!
+   * @param manager
+   * @param vertexCapacity number of vertices of all meshes together
+   * @param indexCapacity number of indices of all meshes together
+   * @param policy placement of the meshes, BestFit keeps the buffers compact when meshes get removed
+   * @param framesInFlight removed ranges get reused after this many calls to Flush
+   * @return false if the buffers couldn't be created
+   */
+  bool Create(std::shared_ptr<VulkanManager>&& manager,
+              uint32_t vertexCapacity,
+              uint32_t indexCapacity,
+              AllocationPolicy policy = AllocationPolicy::BestFit,
+              uint32_t framesInFlight = 2);
+  void Destroy();
+
+  /*!
+   * Reserves the ranges of the mesh, the geometry gets copied and uploaded by the next Flush.
+   * Meshes without indices are drawn as triangle lists, they get 0, 1, 2, ... as indices.
+   *
+   * @param mesh
+   * @return range with indexCount 0 if the buffers are full
+   */
+  GeometryRange Add(const Mesh& mesh);
+
+  /*!
+   * Releases the ranges once the frames in flight which may still draw the mesh are done,
+   * ranges which were never uploaded are released right away.
+   */
+  void Remove(const GeometryRange& range);
+
+  /*!
+   * Uploads all added meshes with one submit. Meshes which don't fit into the staging memory
+   * anymore stay queued for the next call. Call it once per frame, it also releases the removed ranges
+   * whose frames are done.
+   *
+   * @return number of meshes which are ready to draw
+   */
+  uint32_t Flush();
+
+  /*!
+   * Binds the vertex buffer to binding 0 and the index buffer (uint32)
+   */
+  void Bind(vk::CommandBuffer commandBuffer) const;
+
+  /*!
+   * @param range
+   * @param instanceCount
+   * @param firstInstance
+   * @return draw of the mesh for an indirect buffer
+   */
+  static vk::DrawIndexedIndirectCommand GetDrawCommand(const GeometryRange& range,
+                                                       uint32_t instanceCount = 1,
+                                                       uint32_t firstInstance = 0);
+
+  vk::Buffer GetVertexBuffer() const;
+  vk::Buffer GetIndexBuffer() const;
+  uint32_t GetVertexUsage() const;
+  uint32_t GetIndexUsage() const;
+  size_t GetQueued() const;
+};
+
+} // vulkan
+} // rendering
+} // lpe
+
+#endif //LOWPOLYENGINE_GEOMETRYBUFFER_HPP
@@ -0,0 +1,128 @@
+#include "HostAllocationCallbacks.hpp"
+
+#include <sstream>
+
+lpe::rendering::vulkan::HostAllocationCallbacks::HostAllocationCallbacks()
+  : allocator(ScopeCount)
+{
+  this->callbacks = {
+    this,
+    &HostAllocationCallbacks::Allocate,
+    &HostAllocationCallbacks::Reallocate,
+    &HostAllocationCallbacks::Free,
+    &HostAllocationCallbacks::InternalAllocation,
+    &HostAllocationCallbacks::InternalFree
+  };
+}
+
+VKAPI_ATTR void* VKAPI_CALL lpe::rendering::vulkan::HostAllocationCallbacks::Allocate(void* userData,
+                                                                                       size_t size,
+                                                                                       size_t alignment,
+                                                                                       VkSystemAllocationScope scope)
+{
+  auto self = static_cast<HostAllocationCallbacks*>(userData);
+
+  return self->allocator.Allocate(size, alignment, static_cast<uint32_t>(scope));
+}
+
+VKAPI_ATTR void* VKAPI_CALL lpe::rendering::vulkan::HostAllocationCallbacks::Reallocate(void* userData,
+                                                                                         void* original,
+                                                                                         size_t size,
+                                                                                         size_t alignment,
+                                                                                         VkSystemAllocationScope scope)
+{
+  auto self = static_cast<HostAllocationCallbacks*>(userData);
+
+  return self->allocator.Reallocate(original, size, alignment, static_cast<uint32_t>(scope));
+}
+
+VKAPI_ATTR void VKAPI_CALL lpe::rendering::vulkan::HostAllocationCallbacks::Free(void* userData,
+                                                                                 void* memory)
+{
+  auto self = static_cast<HostAllocationCallbacks*>(userData);
+
+  self->allocator.Free(memory);
+}
+
+VKAPI_ATTR void VKAPI_CALL lpe::rendering::vulkan::HostAllocationCallbacks::InternalAllocation(void* userData,
+                                                                                               size_t size,
+                                                                                               VkInternalAllocationType /*type*/,
+                                                                                               VkSystemAllocationScope scope)
+{
+  auto self = static_cast<HostAllocationCallbacks*>(userData);
+
+  self->allocator.NotifyInternalAllocation(size, static_cast<uint32_t>(scope));
+}
+
+VKAPI_ATTR void VKAPI_CALL lpe::rendering::vulkan::HostAllocationCallbacks::InternalFree(void* userData,
+                                                                                         size_t size,
+                                                                                         VkInternalAllocationType /*type*/,
+                                                                                         VkSystemAllocationScope scope)
+{
+  auto self = static_cast<HostAllocationCallbacks*>(userData);
+
+  self->allocator.NotifyInternalFree(size, static_cast<uint32_t>(scope));
+}
+
+const vk::AllocationCallbacks* lpe::rendering::vulkan::HostAllocationCallbacks::Get() const
+{
+  return &callbacks;
+}
+
+lpe::utils::HostAllocationStatistics lpe::rendering::vulkan::HostAllocationCallbacks::GetStatistics(vk::SystemAllocationScope scope)
+{
+  return allocator.GetStatistics(static_cast<uint32_t>(scope));
+}
+
+lpe::utils::HostAllocationStatistics lpe::rendering::vulkan::HostAllocationCallbacks::GetTotalStatistics()
+{
+  return allocator.GetTotalStatistics();
+}
+
+void lpe::rendering::vulkan::HostAllocationCallbacks::ResetPeaks()
+{
+  allocator.ResetPeaks();
+}
+
+std::string lpe::rendering::vulkan::HostAllocationCallbacks::GetStatisticsJson()
+{
+  std::stringstream stream;
+  stream << "{\"slabSize\":" << allocator.GetSlabSize() << ",\"scopes\":[";
+
+  for (uint32_t scope = 0; scope < ScopeCount; ++scope)
+  {
+    auto statistics = allocator.GetStatistics(scope);
+
+    stream << (scope > 0 ? "," : "")
+           << "{\"scope\":\"" << vk::to_string(static_cast<vk::SystemAllocationScope>(scope)) << "\""
+           << ",\"usage\":" << statistics.Usage
+           << ",\"peakUsage\":" << statistics.PeakUsage
+           << ",\"allocationCount\":" << statistics.AllocationCount
+           << ",\"totalAllocations\":" << statistics.TotalAllocations
+           << ",\"totalFrees\":" << statistics.TotalFrees
+           << ",\"internalUsage\":" << statistics.InternalUsage << "}";
+  }
+  stream << "]}";
+
+  return stream.str();
+}
+
+void lpe::rendering::vulkan::HostAllocationCallbacks::LogLeaks(const std::shared_ptr<lpe::utils::log::ILogManager>& logger)
+{
+  if (!logger)
+  {
+    return;
+  }
+
+  for (uint32_t scope = 0; scope < ScopeCount; ++scope)
+  {
+    auto statistics = allocator.GetStatistics(scope);
+
+    if (statistics.AllocationCount > 0)
+    {
+      logger->Log("Vulkan host memory leak: " + std::to_string(statistics.AllocationCount) + " allocations with " +
+                  std::to_string(statistics.Usage) + " bytes in scope " +
+                  vk::to_string(static_cast<vk::SystemAllocationScope>(scope)));
+    }
+  }
+}
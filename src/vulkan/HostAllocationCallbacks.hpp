@@ -0,0 +1,86 @@
+#ifndef LOWPOLYENGINE_HOSTALLOCATIONCALLBACKS_HPP
+#define LOWPOLYENGINE_HOSTALLOCATIONCALLBACKS_HPP
+
+#include "../HostAllocator.h"
+#include "../LogManager.h"
+
+#include <vulkan/vulkan.hpp>
+#include <string>
+
+namespace lpe
+{
+namespace rendering
+{
+namespace vulkan
+{
+
+/*!
+ * vk::AllocationCallbacks on an engine owned HostAllocator, so the CPU memory of the driver shows up
+ * in the statistics (per vk::SystemAllocationScope) instead of disappearing in the general heap.
+ *
+ * Objects have to be destroyed with the callbacks they were created with and this object has to outlive
+ * all of them, VulkanManager owns one and hands it out by GetAllocationCallbacks.
+ */
+class HostAllocationCallbacks
+{
+private:
+  static constexpr uint32_t ScopeCount = VK_SYSTEM_ALLOCATION_SCOPE_INSTANCE + 1;
+
+  lpe::utils::HostAllocator allocator;
+  vk::AllocationCallbacks callbacks;
+
+  static VKAPI_ATTR void* VKAPI_CALL Allocate(void* userData,
+                                               size_t size,
+                                               size_t alignment,
+                                               VkSystemAllocationScope scope);
+  static VKAPI_ATTR void* VKAPI_CALL Reallocate(void* userData,
+                                                 void* original,
+                                                 size_t size,
+                                                 size_t alignment,
+                                                 VkSystemAllocationScope scope);
+  static VKAPI_ATTR void VKAPI_CALL Free(void* userData,
+                                         void* memory);
+  static VKAPI_ATTR void VKAPI_CALL InternalAllocation(void* userData,
+                                                       size_t size,
+                                                       VkInternalAllocationType type,
+                                                       VkSystemAllocationScope scope);
+  static VKAPI_ATTR void VKAPI_CALL InternalFree(void* userData,
+                                                 size_t size,
+                                                 VkInternalAllocationType type,
+                                                 VkSystemAllocationScope scope);
+
+public:
+  HostAllocationCallbacks();
+  HostAllocationCallbacks(const HostAllocationCallbacks& other) = delete;
+  HostAllocationCallbacks(HostAllocationCallbacks&& other) noexcept = delete;
+  HostAllocationCallbacks& operator=(const HostAllocationCallbacks& other) = delete;
+  HostAllocationCallbacks& operator=(HostAllocationCallbacks&& other) noexcept = delete;
+  ~HostAllocationCallbacks() = default;
+
+  /*!
+   * Pass it to every create and destroy call
+   */
+  const vk::AllocationCallbacks* Get() const;
+
+  lpe::utils::HostAllocationStatistics GetStatistics(vk::SystemAllocationScope scope);
+  lpe::utils::HostAllocationStatistics GetTotalStatistics();
+  void ResetPeaks();
+
+  /*!
+   * One object per scope with usage, peakUsage, allocationCount, totalAllocations, totalFrees and internalUsage
+   */
+  std::string GetStatisticsJson();
+
+  /*!
+   * Logs the allocations the driver didn't free, called by VulkanManager::Close after the instance is gone
+   *
+   * @param logger
+   */
+  void LogLeaks(const std::shared_ptr<lpe::utils::log::ILogManager>& logger);
+};
+
+} // vulkan
+} // rendering
+} // lpe
+
+#endif //LOWPOLYENGINE_HOSTALLOCATIONCALLBACKS_HPP
@@ -2,7 +2,54 @@
 #include "VulkanManager.hpp"
 #include "../ServiceLocator.h"
 
-vk::Buffer lpe::rendering::vulkan::common::CreateBuffer(vk::Device device, vk::DeviceSize size, vk::BufferUsageFlags usage, const uint32_t *queueFamilies, uint32_t queueFamilyCount)
+#include <algorithm>
+#include <sstream>
+
+namespace
+{
+  std::string GetTagName(const lpe::rendering::vulkan::AllocationTag& tag)
+  {
+    std::string name = tag.name ? tag.name : "untagged";
+    if (tag.file)
+    {
+      name += " (" + std::string(tag.file) + ":" + std::to_string(tag.line) + ")";
+    }
+
+    return name;
+  }
+
+  bool IsSameTag(const lpe::rendering::vulkan::AllocationTag& first,
+                 const lpe::rendering::vulkan::AllocationTag& second)
+  {
+    return first.line == second.line &&
+           std::string(first.name ? first.name : "") == std::string(second.name ? second.name : "") &&
+           std::string(first.file ? first.file : "") == std::string(second.file ? second.file : "");
+  }
+
+  void WriteJsonString(std::ostream& stream,
+                       const std::string& value)
+  {
+    stream << '"';
+    for (auto c : value)
+    {
+      if (c == '"' || c == '\\')
+      {
+        stream << '\\' << c;
+      }
+      else if (static_cast<unsigned char>(c) < 0x20)
+      {
+        stream << ' ';
+      }
+      else
+      {
+        stream << c;
+      }
+    }
+    stream << '"';
+  }
+}
+
+vk::Buffer lpe::rendering::vulkan::common::CreateBuffer(vk::Device device, vk::DeviceSize size, vk::BufferUsageFlags usage, const uint32_t *queueFamilies, uint32_t queueFamilyCount, const vk::AllocationCallbacks* allocator)
 {
   vk::Buffer buffer = nullptr;
   vk::BufferCreateInfo createInfo =
@@ -15,7 +62,7 @@ vk::Buffer lpe::rendering::vulkan::common::CreateBuffer(vk::Device device, vk::D
       queueFamilies
     };
 
-  auto result = device.createBuffer(&createInfo, nullptr, &buffer);
+  auto result = device.createBuffer(&createInfo, allocator, &buffer);
   if (result != vk::Result::eSuccess)
   {
     auto mgr = lpe::ServiceLocator::LogManager.Get()
@@ -56,31 +103,36 @@ uint32_t lpe::rendering::vulkan::common::AllocateMemory(vk::Device device,
                                                         vk::PhysicalDevice physicalDevice,
                                                         vk::MemoryRequirements requirements,
                                                         vk::MemoryPropertyFlags properties,
-                                                        vk::DeviceMemory *memory)
+                                                        vk::DeviceMemory *memory,
+                                                        const vk::AllocationCallbacks* allocator)
 {
   const vk::PhysicalDeviceMemoryProperties& deviceProperties = physicalDevice.getMemoryProperties();
-  uint32_t type = 0;
-  vk::Result result = vk::Result::eSuccess;
+  vk::Result result = vk::Result::eErrorOutOfDeviceMemory;
 
-  do
-  {
-    type = GetMemoryType(deviceProperties,
-                         requirements,
-                         properties,
-                         type);
+  *memory = nullptr;
 
+  // a full heap fails the allocation, the next matching type may live on another heap
+  uint32_t type = GetMemoryType(deviceProperties, requirements, properties);
+  while (type < deviceProperties.memoryTypeCount)
+  {
     vk::MemoryAllocateInfo allocateInfo = {
       requirements.size,
       type
     };
 
     result = device.allocateMemory(&allocateInfo,
-                                   nullptr,
+                                   allocator,
                                    memory);
-  } while (result != vk::Result::eSuccess &&
-           type < deviceProperties.memoryTypeCount);
+    if (result == vk::Result::eSuccess)
+    {
+      break;
+    }
+
+    *memory = nullptr;
+    type = GetMemoryType(deviceProperties, requirements, properties, type + 1);
+  }
 
-  if (!(*memory))
+  if (result != vk::Result::eSuccess)
   {
     auto mgr = lpe::ServiceLocator::LogManager.Get()
                                               .lock();
@@ -102,12 +154,13 @@ bool lpe::rendering::vulkan::common::CreateBufferAllocateAndBindMemory(vk::Devic
                                                                        vk::BufferUsageFlags usage,
                                                                        vk::MemoryPropertyFlags properties,
                                                                        const uint32_t *queueFamilies,
-                                                                       uint32_t queueFamilyCount)
+                                                                       uint32_t queueFamilyCount,
+                                                                       const vk::AllocationCallbacks* allocator)
 {
   auto mgr = lpe::ServiceLocator::LogManager.Get()
                                             .lock();
 
-  buffer = CreateBuffer(device, size, usage, queueFamilies, queueFamilyCount);
+  buffer = CreateBuffer(device, size, usage, queueFamilies, queueFamilyCount, allocator);
   if (!buffer)
   {
     if (mgr)
@@ -124,7 +177,8 @@ bool lpe::rendering::vulkan::common::CreateBufferAllocateAndBindMemory(vk::Devic
                               physicalDevice,
                               requirements,
                               properties,
-                              &memory);
+                              &memory,
+                              allocator);
 
   if (!memory)
   {
@@ -141,6 +195,875 @@ bool lpe::rendering::vulkan::common::CreateBufferAllocateAndBindMemory(vk::Devic
   return true;
 }
 
+bool lpe::rendering::vulkan::common::FlushMappedMemory(vk::Device device,
+                                                      vk::DeviceMemory memory,
+                                                      vk::DeviceSize memorySize,
+                                                      vk::DeviceSize nonCoherentAtomSize,
+                                                      vk::DeviceSize offset,
+                                                      vk::DeviceSize size)
+{
+  // flushed ranges have to be multiples of nonCoherentAtomSize (or end at the end of the memory)
+  vk::DeviceSize begin = offset / nonCoherentAtomSize * nonCoherentAtomSize;
+  vk::DeviceSize end = (offset + size + nonCoherentAtomSize - 1) / nonCoherentAtomSize * nonCoherentAtomSize;
+
+  vk::MappedMemoryRange range =
+    {
+      memory,
+      begin,
+      end < memorySize ? end - begin : VK_WHOLE_SIZE
+    };
+
+  return device.flushMappedMemoryRanges(1, &range) == vk::Result::eSuccess;
+}
+
+lpe::rendering::vulkan::DeviceMemoryBackend::DeviceMemoryBackend()
+{
+  this->device = nullptr;
+  this->physicalDevice = nullptr;
+  this->memoryProperties = {};
+  this->memoryBudget = false;
+  this->allocator = nullptr;
+}
+
+void lpe::rendering::vulkan::DeviceMemoryBackend::Create(vk::Device device,
+                                                         vk::PhysicalDevice physicalDevice,
+                                                         bool memoryBudget,
+                                                         const vk::AllocationCallbacks* allocator)
+{
+  this->device = device;
+  this->physicalDevice = physicalDevice;
+  this->allocator = allocator;
+  this->memoryProperties = physicalDevice.getMemoryProperties();
+  this->memoryBudget = memoryBudget;
+
+  heapAllocated.assign(memoryProperties.memoryHeapCount, 0);
+  UpdateBudget();
+}
+
+void lpe::rendering::vulkan::DeviceMemoryBackend::Destroy()
+{
+  for (auto&& block : blocks)
+  {
+    device.freeMemory(GetMemory(block.first), allocator);
+  }
+
+  blocks.clear();
+  heapAllocated.assign(memoryProperties.memoryHeapCount, 0);
+}
+
+uint64_t lpe::rendering::vulkan::DeviceMemoryBackend::Allocate(uint64_t size,
+                                                               uint32_t memoryType,
+                                                               const void* next)
+{
+  auto heap = memoryProperties.memoryTypes[memoryType].heapIndex;
+
+  UpdateBudget();
+  if (heapUsage[heap] + size > heapBudget[heap])
+  {
+    return InvalidHandle;
+  }
+
+  vk::MemoryAllocateInfo allocateInfo = {
+    size,
+    memoryType
+  };
+  allocateInfo.pNext = next;
+
+  vk::DeviceMemory memory = nullptr;
+  if (device.allocateMemory(&allocateInfo, allocator, &memory) != vk::Result::eSuccess)
+  {
+    return InvalidHandle;
+  }
+
+  auto handle = (uint64_t)static_cast<VkDeviceMemory>(memory);
+  blocks[handle] = { size, heap };
+  heapAllocated[heap] += size;
+
+  return handle;
+}
+
+void lpe::rendering::vulkan::DeviceMemoryBackend::Free(uint64_t handle)
+{
+  auto found = blocks.find(handle);
+  assert(found != std::end(blocks));
+
+  heapAllocated[found->second.heap] -= found->second.size;
+  device.freeMemory(GetMemory(handle), allocator);
+
+  blocks.erase(found);
+}
+
+vk::DeviceMemory lpe::rendering::vulkan::DeviceMemoryBackend::GetMemory(uint64_t handle)
+{
+  // VkDeviceMemory is a pointer on 64 bit and an uint64_t on 32 bit platforms
+  return vk::DeviceMemory((VkDeviceMemory)handle);
+}
+
+void lpe::rendering::vulkan::DeviceMemoryBackend::UpdateBudget()
+{
+  auto heapCount = memoryProperties.memoryHeapCount;
+  heapUsage.assign(heapCount, 0);
+  heapBudget.assign(heapCount, 0);
+
+  if (memoryBudget)
+  {
+    auto chain = physicalDevice.getMemoryProperties2<vk::PhysicalDeviceMemoryProperties2,
+                                                     vk::PhysicalDeviceMemoryBudgetPropertiesEXT>();
+    auto& budget = chain.get<vk::PhysicalDeviceMemoryBudgetPropertiesEXT>();
+
+    for (uint32_t heap = 0; heap < heapCount; ++heap)
+    {
+      heapUsage[heap] = budget.heapUsage[heap];
+      heapBudget[heap] = budget.heapBudget[heap];
+    }
+  }
+  else
+  {
+    // without the extension only own allocations are known, leave some room for everyone else
+    for (uint32_t heap = 0; heap < heapCount; ++heap)
+    {
+      heapUsage[heap] = heapAllocated[heap];
+      heapBudget[heap] = memoryProperties.memoryHeaps[heap].size / 10 * 8;
+    }
+  }
+}
+
+const vk::PhysicalDeviceMemoryProperties& lpe::rendering::vulkan::DeviceMemoryBackend::GetMemoryProperties() const
+{
+  return memoryProperties;
+}
+
+uint32_t lpe::rendering::vulkan::DeviceMemoryBackend::GetHeapCount() const
+{
+  return memoryProperties.memoryHeapCount;
+}
+
+vk::DeviceSize lpe::rendering::vulkan::DeviceMemoryBackend::GetHeapAllocated(uint32_t heap) const
+{
+  return heapAllocated[heap];
+}
+
+vk::DeviceSize lpe::rendering::vulkan::DeviceMemoryBackend::GetHeapUsage(uint32_t heap) const
+{
+  return heapUsage[heap];
+}
+
+vk::DeviceSize lpe::rendering::vulkan::DeviceMemoryBackend::GetHeapBudget(uint32_t heap) const
+{
+  return heapBudget[heap];
+}
+
+lpe::rendering::vulkan::GeneralPurposeAllocator::GeneralPurposeAllocator()
+{
+  this->device = nullptr;
+  this->granularity = 1;
+  this->chunkSize = 64 * 1024 * 1024;
+  this->policy = AllocationPolicy::Tlsf;
+}
+
+void lpe::rendering::vulkan::GeneralPurposeAllocator::Create(vk::Device device,
+                                                             vk::PhysicalDevice physicalDevice,
+                                                             vk::DeviceSize chunkSize,
+                                                             AllocationPolicy policy,
+                                                             bool memoryBudget,
+                                                             const vk::AllocationCallbacks* allocator)
+{
+  this->logger = lpe::ServiceLocator::LogManager.Get();
+  this->device = device;
+  this->granularity = std::max<vk::DeviceSize>(physicalDevice.getProperties().limits.bufferImageGranularity, 1);
+  this->chunkSize = chunkSize;
+  this->policy = policy;
+
+  backend.Create(device, physicalDevice, memoryBudget, allocator);
+}
+
+void lpe::rendering::vulkan::GeneralPurposeAllocator::Destroy()
+{
+  auto logPtr = logger.lock();
+  if (logPtr && (!images.empty() || !buffers.empty() || !ranges.empty()))
+  {
+    logPtr->Log("GeneralPurposeAllocator destroyed with " + std::to_string(images.size()) + " images, " +
+                std::to_string(buffers.size()) + " buffers and " + std::to_string(ranges.size()) + " ranges still bound:");
+
+    for (auto&& image : images)
+    {
+      logPtr->Log("  image of " + std::to_string(image.second.size) + " bytes, " + GetTagName(image.second.tag));
+    }
+
+    for (auto&& buffer : buffers)
+    {
+      logPtr->Log("  buffer of " + std::to_string(buffer.second.size) + " bytes, " + GetTagName(buffer.second.tag));
+    }
+
+    for (auto&& range : ranges)
+    {
+      logPtr->Log("  range of " + std::to_string(range.second.size) + " bytes, " + GetTagName(range.second.tag));
+    }
+  }
+
+  for (auto list : { &pools, &transientPools })
+  {
+    for (auto&& pool : *list)
+    {
+      pool.second.Destroy();
+    }
+
+    list->clear();
+  }
+
+  images.clear();
+  buffers.clear();
+  ranges.clear();
+  movedRanges.clear();
+  backend.Destroy();
+
+  logger.reset();
+}
+
+void lpe::rendering::vulkan::GeneralPurposeAllocator::SetChunkSize(vk::DeviceSize chunkSize)
+{
+  this->chunkSize = chunkSize;
+
+  for (auto&& pool : pools)
+  {
+    pool.second.SetChunkSize(chunkSize);
+  }
+}
+
+void lpe::rendering::vulkan::GeneralPurposeAllocator::UpdateBudget()
+{
+  backend.UpdateBudget();
+}
+
+uint32_t lpe::rendering::vulkan::GeneralPurposeAllocator::GetHeapCount() const
+{
+  return backend.GetHeapCount();
+}
+
+vk::DeviceSize lpe::rendering::vulkan::GeneralPurposeAllocator::GetHeapUsage(uint32_t heap) const
+{
+  return backend.GetHeapUsage(heap);
+}
+
+vk::DeviceSize lpe::rendering::vulkan::GeneralPurposeAllocator::GetHeapBudget(uint32_t heap) const
+{
+  return backend.GetHeapBudget(heap);
+}
+
+bool lpe::rendering::vulkan::GeneralPurposeAllocator::WantsDedicated(vk::DeviceSize size,
+                                                                     const vk::MemoryDedicatedRequirements& dedicatedRequirements) const
+{
+  return dedicatedRequirements.requiresDedicatedAllocation ||
+         dedicatedRequirements.prefersDedicatedAllocation ||
+         size >= chunkSize / 2;
+}
+
+lpe::rendering::MemoryPool& lpe::rendering::vulkan::GeneralPurposeAllocator::GetPool(uint32_t memoryType,
+                                                                                      bool transient)
+{
+  auto& list = transient ? transientPools : pools;
+
+  auto found = list.find(memoryType);
+  if (found == std::end(list))
+  {
+    found = list.emplace(memoryType, MemoryPool()).first;
+    found->second.Create(backend, memoryType, chunkSize, policy);
+  }
+
+  return found->second;
+}
+
+bool lpe::rendering::vulkan::GeneralPurposeAllocator::Allocate(vk::MemoryRequirements requirements,
+                                                               vk::MemoryPropertyFlags properties,
+                                                               const vk::MemoryDedicatedAllocateInfo* dedicated,
+                                                               const AllocationTag& tag,
+                                                               Allocation& allocation,
+                                                               bool transient)
+{
+  auto& memoryProperties = backend.GetMemoryProperties();
+
+  for (uint32_t type = 0; type < memoryProperties.memoryTypeCount; ++type)
+  {
+    if (!(requirements.memoryTypeBits & (1 << type)) ||
+        (memoryProperties.memoryTypes[type].propertyFlags & properties) != properties)
+    {
+      continue;
+    }
+
+    auto& pool = GetPool(type, transient);
+
+    PoolAllocation poolAllocation = {};
+    bool result = dedicated ?
+                  pool.AllocateDedicated(requirements.size, dedicated, poolAllocation) :
+                  pool.Allocate(requirements.size, requirements.alignment, poolAllocation);
+
+    if (result)
+    {
+      allocation = { poolAllocation.Chunk, poolAllocation.Offset, requirements.size, requirements.alignment, tag, transient };
+
+      return true;
+    }
+
+    // heap exhausted or over budget, try the next matching type
+  }
+
+  auto logPtr = logger.lock();
+  if (logPtr)
+  {
+    logPtr->Log("GeneralPurposeAllocator could not allocate memory within the heap budgets");
+  }
+
+  return false;
+}
+
+void lpe::rendering::vulkan::GeneralPurposeAllocator::Free(const Allocation& allocation)
+{
+  auto& list = allocation.transient ? transientPools : pools;
+  list[allocation.chunk->GetMemoryType()].Free({ allocation.chunk, allocation.offset });
+}
+
+vk::DeviceSize lpe::rendering::vulkan::GeneralPurposeAllocator::Bind(vk::Image image,
+                                                                     vk::MemoryPropertyFlags properties,
+                                                                     bool linear,
+                                                                     const AllocationTag& tag)
+{
+  assert(images.find(image) == std::end(images));
+
+  vk::ImageMemoryRequirementsInfo2 info = { image };
+  auto chain = device.getImageMemoryRequirements2<vk::MemoryRequirements2, vk::MemoryDedicatedRequirements>(info);
+  auto requirements = chain.get<vk::MemoryRequirements2>().memoryRequirements;
+  bool dedicated = WantsDedicated(requirements.size, chain.get<vk::MemoryDedicatedRequirements>());
+
+  if (!linear && !dedicated)
+  {
+    requirements.alignment = std::max(requirements.alignment, granularity);
+    requirements.size = (requirements.size + granularity - 1) / granularity * granularity;
+  }
+
+  vk::MemoryDedicatedAllocateInfo dedicatedInfo = { image, nullptr };
+
+  Allocation allocation = {};
+  if (!Allocate(requirements, properties, dedicated ? &dedicatedInfo : nullptr, tag, allocation))
+  {
+    return VK_WHOLE_SIZE;
+  }
+
+  device.bindImageMemory(image, DeviceMemoryBackend::GetMemory(allocation.chunk->GetHandle()), allocation.offset);
+  images[image] = allocation;
+
+  return allocation.offset;
+}
+
+vk::DeviceSize lpe::rendering::vulkan::GeneralPurposeAllocator::Bind(vk::Buffer buffer,
+                                                                     vk::MemoryPropertyFlags properties,
+                                                                     const AllocationTag& tag,
+                                                                     bool ownMemory)
+{
+  assert(buffers.find(buffer) == std::end(buffers));
+
+  vk::BufferMemoryRequirementsInfo2 info = { buffer };
+  auto chain = device.getBufferMemoryRequirements2<vk::MemoryRequirements2, vk::MemoryDedicatedRequirements>(info);
+  auto requirements = chain.get<vk::MemoryRequirements2>().memoryRequirements;
+  bool dedicated = ownMemory || WantsDedicated(requirements.size, chain.get<vk::MemoryDedicatedRequirements>());
+
+  vk::MemoryDedicatedAllocateInfo dedicatedInfo = { nullptr, buffer };
+
+  Allocation allocation = {};
+  if (!Allocate(requirements, properties, dedicated ? &dedicatedInfo : nullptr, tag, allocation))
+  {
+    return VK_WHOLE_SIZE;
+  }
+
+  device.bindBufferMemory(buffer, DeviceMemoryBackend::GetMemory(allocation.chunk->GetHandle()), allocation.offset);
+  buffers[buffer] = allocation;
+
+  return allocation.offset;
+}
+
+vk::DeviceMemory lpe::rendering::vulkan::GeneralPurposeAllocator::GetMemory(vk::Buffer buffer) const
+{
+  auto found = buffers.find(buffer);
+  if (found == std::end(buffers))
+  {
+    return nullptr;
+  }
+
+  return DeviceMemoryBackend::GetMemory(found->second.chunk->GetHandle());
+}
+
+vk::DeviceSize lpe::rendering::vulkan::GeneralPurposeAllocator::BindTransient(vk::Image image,
+                                                                              const AllocationTag& tag)
+{
+  assert(images.find(image) == std::end(images));
+
+  // transient attachments are optimal tiled, so they get whole granularity pages like every image
+  auto requirements = device.getImageMemoryRequirements(image);
+  requirements.alignment = std::max(requirements.alignment, granularity);
+  requirements.size = (requirements.size + granularity - 1) / granularity * granularity;
+
+  auto& memoryProperties = backend.GetMemoryProperties();
+  vk::MemoryPropertyFlags properties = vk::MemoryPropertyFlagBits::eDeviceLocal;
+
+  for (uint32_t type = 0; type < memoryProperties.memoryTypeCount; ++type)
+  {
+    if ((requirements.memoryTypeBits & (1 << type)) &&
+        (memoryProperties.memoryTypes[type].propertyFlags & vk::MemoryPropertyFlagBits::eLazilyAllocated))
+    {
+      properties = vk::MemoryPropertyFlagBits::eLazilyAllocated;
+      break;
+    }
+  }
+
+  Allocation allocation = {};
+  if (!Allocate(requirements, properties, nullptr, tag, allocation, true))
+  {
+    return VK_WHOLE_SIZE;
+  }
+
+  device.bindImageMemory(image, DeviceMemoryBackend::GetMemory(allocation.chunk->GetHandle()), allocation.offset);
+  images[image] = allocation;
+
+  return allocation.offset;
+}
+
+vk::DeviceSize lpe::rendering::vulkan::GeneralPurposeAllocator::AllocateRange(vk::MemoryRequirements requirements,
+                                                                              vk::MemoryPropertyFlags properties,
+                                                                              vk::DeviceMemory& memory,
+                                                                              const AllocationTag& tag,
+                                                                              bool transient)
+{
+  // whatever gets bound, it mustn't share a granularity page with other resources of the chunk
+  requirements.alignment = std::max(requirements.alignment, granularity);
+  requirements.size = (requirements.size + granularity - 1) / granularity * granularity;
+
+  Allocation allocation = {};
+  if (!Allocate(requirements, properties, nullptr, tag, allocation, transient))
+  {
+    memory = nullptr;
+
+    return VK_WHOLE_SIZE;
+  }
+
+  memory = DeviceMemoryBackend::GetMemory(allocation.chunk->GetHandle());
+  ranges[{ allocation.chunk->GetHandle(), allocation.offset }] = allocation;
+
+  return allocation.offset;
+}
+
+void lpe::rendering::vulkan::GeneralPurposeAllocator::FreeRange(vk::DeviceMemory memory,
+                                                                vk::DeviceSize offset)
+{
+  auto found = ranges.find({ (uint64_t)static_cast<VkDeviceMemory>(memory), offset });
+  if (found != std::end(ranges))
+  {
+    Free(found->second);
+    ranges.erase(found);
+  }
+}
+
+bool lpe::rendering::vulkan::GeneralPurposeAllocator::SupportsLazilyAllocated() const
+{
+  auto& memoryProperties = backend.GetMemoryProperties();
+
+  for (uint32_t type = 0; type < memoryProperties.memoryTypeCount; ++type)
+  {
+    if (memoryProperties.memoryTypes[type].propertyFlags & vk::MemoryPropertyFlagBits::eLazilyAllocated)
+    {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+void lpe::rendering::vulkan::GeneralPurposeAllocator::Free(vk::Image image)
+{
+  auto found = images.find(image);
+  if (found != std::end(images))
+  {
+    Free(found->second);
+    images.erase(found);
+  }
+}
+
+void lpe::rendering::vulkan::GeneralPurposeAllocator::Free(vk::Buffer buffer)
+{
+  auto found = buffers.find(buffer);
+  if (found != std::end(buffers))
+  {
+    Free(found->second);
+    buffers.erase(found);
+  }
+}
+
+std::vector<lpe::rendering::vulkan::DefragmentationMove> lpe::rendering::vulkan::GeneralPurposeAllocator::BeginDefragmentation(const std::vector<vk::Image>& images,
+                                                                                                                            const std::vector<vk::Buffer>& buffers,
+                                                                                                                            vk::DeviceSize maxBytes,
+                                                                                                                            float maxUsage)
+{
+  assert(pendingMoves.empty());
+
+  struct Candidate
+  {
+    vk::Image image;
+    vk::Buffer buffer;
+    Allocation allocation;
+  };
+
+  // chunks with a resource the caller can't move can't be released anyway
+  std::map<MemoryChunk*, std::vector<Candidate>> candidates;
+  std::set<MemoryChunk*> pinned;
+
+  std::set<vk::Image> movableImages(std::begin(images), std::end(images));
+  std::set<vk::Buffer> movableBuffers(std::begin(buffers), std::end(buffers));
+
+  for (auto&& item : this->images)
+  {
+    if (item.second.transient)
+    {
+      continue;
+    }
+
+    if (movableImages.count(item.first) > 0)
+    {
+      candidates[item.second.chunk].push_back({ item.first, nullptr, item.second });
+    }
+    else
+    {
+      pinned.insert(item.second.chunk);
+    }
+  }
+
+  for (auto&& item : this->buffers)
+  {
+    if (movableBuffers.count(item.first) > 0)
+    {
+      candidates[item.second.chunk].push_back({ nullptr, item.first, item.second });
+    }
+    else
+    {
+      pinned.insert(item.second.chunk);
+    }
+  }
+
+  // the owners of ranges bind their resources themselves
+  for (auto&& item : ranges)
+  {
+    pinned.insert(item.second.chunk);
+  }
+
+  // being emptied already, the old ranges of an earlier step can't move
+  for (auto&& item : movedRanges)
+  {
+    pinned.insert(item.source.chunk);
+  }
+
+  std::vector<MemoryChunk*> sources;
+  for (auto&& item : candidates)
+  {
+    auto chunk = item.first;
+    if (!chunk->IsDedicated() &&
+        pinned.count(chunk) == 0 &&
+        pools[chunk->GetMemoryType()].GetChunks().size() > 1 &&
+        chunk->GetUsage() < maxUsage * chunk->GetSize())
+    {
+      sources.push_back(chunk);
+    }
+  }
+
+  // sparsest first, they need the fewest copies to be released
+  std::sort(std::begin(sources),
+            std::end(sources),
+            [](MemoryChunk* a, MemoryChunk* b)
+            {
+              return a->GetUsage() * b->GetSize() < b->GetUsage() * a->GetSize();
+            });
+
+  std::vector<DefragmentationMove> moves;
+  std::set<MemoryChunk*> receivers;
+  vk::DeviceSize moved = 0;
+  bool full = false;
+
+  for (auto source : sources)
+  {
+    // got resources of an earlier source in this step, it isn't sparse anymore
+    if (full || receivers.count(source) > 0)
+    {
+      continue;
+    }
+
+    auto& pool = pools[source->GetMemoryType()];
+    pool.SetDraining(source);
+
+    // fill the densest chunks first, so sparse ones become candidates of the next step
+    std::vector<MemoryChunk*> destinations;
+    for (auto&& chunk : pool.GetChunks())
+    {
+      if (!pool.IsDraining(chunk.get()))
+      {
+        destinations.push_back(chunk.get());
+      }
+    }
+
+    std::sort(std::begin(destinations),
+              std::end(destinations),
+              [](MemoryChunk* a, MemoryChunk* b)
+              {
+                return a->GetUsage() * b->GetSize() > b->GetUsage() * a->GetSize();
+              });
+
+    for (auto&& candidate : candidates[source])
+    {
+      if (moved + candidate.allocation.size > maxBytes)
+      {
+        full = true;
+        break;
+      }
+
+      for (auto destination : destinations)
+      {
+        auto offset = destination->Allocate(candidate.allocation.size, candidate.allocation.alignment);
+        if (offset == ISubAllocator::InvalidOffset)
+        {
+          continue;
+        }
+
+        Allocation target = { destination, offset, candidate.allocation.size, candidate.allocation.alignment, candidate.allocation.tag, false };
+        pendingMoves.push_back({ candidate.allocation, target });
+        moves.push_back({ candidate.image,
+                          candidate.buffer,
+                          DeviceMemoryBackend::GetMemory(destination->GetHandle()),
+                          offset,
+                          candidate.allocation.size,
+                          nullptr,
+                          nullptr });
+
+        moved += candidate.allocation.size;
+        receivers.insert(destination);
+        break;
+      }
+    }
+  }
+
+  if (moves.empty())
+  {
+    for (auto&& pool : pools)
+    {
+      pool.second.ClearDraining();
+    }
+  }
+
+  return moves;
+}
+
+void lpe::rendering::vulkan::GeneralPurposeAllocator::EndDefragmentation(const std::vector<DefragmentationMove>& moves,
+                                                                         uint64_t frame)
+{
+  assert(moves.size() == pendingMoves.size());
+
+  for (size_t i = 0; i < moves.size(); ++i)
+  {
+    auto& move = moves[i];
+    auto& pending = pendingMoves[i];
+
+    if (move.newImage)
+    {
+      this->images.erase(move.image);
+      this->images[move.newImage] = pending.destination;
+    }
+    else if (move.newBuffer)
+    {
+      this->buffers.erase(move.buffer);
+      this->buffers[move.newBuffer] = pending.destination;
+    }
+    else
+    {
+      Free(pending.destination);
+      continue;
+    }
+
+    // the old resource may still be read by frames in flight, its chunk gets released later
+    movedRanges.push_back({ pending.source, frame });
+  }
+
+  pendingMoves.clear();
+
+  for (auto&& pool : pools)
+  {
+    pool.second.ClearDraining();
+  }
+}
+
+void lpe::rendering::vulkan::GeneralPurposeAllocator::ReleaseMovedRanges(uint64_t completedFrame)
+{
+  for (size_t i = 0; i < movedRanges.size();)
+  {
+    if (movedRanges[i].frame <= completedFrame)
+    {
+      Free(movedRanges[i].source);
+
+      movedRanges[i] = movedRanges.back();
+      movedRanges.pop_back();
+    }
+    else
+    {
+      ++i;
+    }
+  }
+}
+
+size_t lpe::rendering::vulkan::GeneralPurposeAllocator::GetChunkCount() const
+{
+  size_t count = 0;
+  for (auto list : { &pools, &transientPools })
+  {
+    for (auto&& pool : *list)
+    {
+      count += pool.second.GetChunkCount();
+    }
+  }
+
+  return count;
+}
+
+lpe::rendering::vulkan::MemoryStatistics lpe::rendering::vulkan::GeneralPurposeAllocator::GetStatistics() const
+{
+  MemoryStatistics statistics = {};
+
+  for (auto group : { &pools, &transientPools })
+  {
+    for (auto&& pool : *group)
+    {
+      for (auto list : { &pool.second.GetChunks(), &pool.second.GetDedicatedChunks() })
+      {
+        for (auto&& chunk : *list)
+        {
+          ChunkStatistics chunkStatistics = {};
+          chunkStatistics.memoryType = chunk->GetMemoryType();
+          chunkStatistics.heap = backend.GetMemoryProperties().memoryTypes[chunk->GetMemoryType()].heapIndex;
+          chunkStatistics.dedicated = chunk->IsDedicated();
+          chunkStatistics.transient = group == &transientPools;
+          chunkStatistics.size = chunk->GetSize();
+          chunkStatistics.usage = chunk->GetUsage();
+          chunkStatistics.largestFreeBlock = chunk->GetLargestFreeBlock();
+          chunkStatistics.allocationCount = chunk->GetAllocationCount();
+
+          auto free = chunkStatistics.size - chunkStatistics.usage;
+          chunkStatistics.fragmentation = free > 0 ?
+                                          1.0f - static_cast<float>(chunkStatistics.largestFreeBlock) / free :
+                                          0.0f;
+
+          statistics.size += chunkStatistics.size;
+          statistics.usage += chunkStatistics.usage;
+          statistics.chunks.push_back(chunkStatistics);
+        }
+      }
+    }
+  }
+
+  auto addTag = [&statistics](const Allocation& allocation, bool image)
+  {
+    auto found = std::find_if(std::begin(statistics.tags),
+                              std::end(statistics.tags),
+                              [&allocation, image](const TagStatistics& tag)
+                              {
+                                return tag.image == image && IsSameTag(tag.tag, allocation.tag);
+                              });
+
+    if (found == std::end(statistics.tags))
+    {
+      statistics.tags.push_back({ allocation.tag, image, 0, 0 });
+      found = std::prev(std::end(statistics.tags));
+    }
+
+    found->count++;
+    found->size += allocation.size;
+  };
+
+  for (auto&& image : images)
+  {
+    statistics.imageCount++;
+    statistics.imageUsage += image.second.size;
+    addTag(image.second, true);
+  }
+
+  for (auto&& buffer : buffers)
+  {
+    statistics.bufferCount++;
+    statistics.bufferUsage += buffer.second.size;
+    addTag(buffer.second, false);
+  }
+
+  // ranges hold aliased images
+  for (auto&& range : ranges)
+  {
+    statistics.rangeCount++;
+    statistics.rangeUsage += range.second.size;
+    addTag(range.second, true);
+  }
+
+  std::sort(std::begin(statistics.tags),
+            std::end(statistics.tags),
+            [](const TagStatistics& first, const TagStatistics& second)
+            {
+              return first.size > second.size;
+            });
+
+  return statistics;
+}
+
+std::string lpe::rendering::vulkan::GeneralPurposeAllocator::GetStatisticsJson() const
+{
+  auto statistics = GetStatistics();
+
+  std::stringstream stream;
+  stream << "{\"size\":" << statistics.size
+         << ",\"usage\":" << statistics.usage
+         << ",\"chunkSize\":" << chunkSize
+         << ",\"images\":{\"count\":" << statistics.imageCount << ",\"usage\":" << statistics.imageUsage << "}"
+         << ",\"buffers\":{\"count\":" << statistics.bufferCount << ",\"usage\":" << statistics.bufferUsage << "}"
+         << ",\"ranges\":{\"count\":" << statistics.rangeCount << ",\"usage\":" << statistics.rangeUsage << "}";
+
+  stream << ",\"heaps\":[";
+  for (uint32_t heap = 0; heap < backend.GetHeapCount(); ++heap)
+  {
+    stream << (heap > 0 ? "," : "")
+           << "{\"allocated\":" << backend.GetHeapAllocated(heap)
+           << ",\"usage\":" << GetHeapUsage(heap)
+           << ",\"budget\":" << GetHeapBudget(heap) << "}";
+  }
+
+  stream << "],\"chunks\":[";
+  for (size_t i = 0; i < statistics.chunks.size(); ++i)
+  {
+    auto& chunk = statistics.chunks[i];
+    stream << (i > 0 ? "," : "")
+           << "{\"memoryType\":" << chunk.memoryType
+           << ",\"heap\":" << chunk.heap
+           << ",\"dedicated\":" << (chunk.dedicated ? "true" : "false")
+           << ",\"transient\":" << (chunk.transient ? "true" : "false")
+           << ",\"size\":" << chunk.size
+           << ",\"usage\":" << chunk.usage
+           << ",\"largestFreeBlock\":" << chunk.largestFreeBlock
+           << ",\"allocations\":" << chunk.allocationCount
+           << ",\"fragmentation\":" << chunk.fragmentation << "}";
+  }
+
+  stream << "],\"tags\":[";
+  for (size_t i = 0; i < statistics.tags.size(); ++i)
+  {
+    auto& tag = statistics.tags[i];
+    stream << (i > 0 ? "," : "") << "{\"name\":";
+    WriteJsonString(stream, GetTagName(tag.tag));
+    stream << ",\"type\":\"" << (tag.image ? "image" : "buffer") << "\""
+           << ",\"count\":" << tag.count
+           << ",\"size\":" << tag.size << "}";
+  }
+  stream << "]}";
+
+  return stream.str();
+}
+
 void lpe::rendering::vulkan::StackAllocator::Create(std::shared_ptr<lpe::rendering::vulkan::VulkanManager> manager,
                                                     vk::DeviceSize size,
                                                     vk::MemoryPropertyFlags properties,
@@ -149,52 +1072,73 @@ void lpe::rendering::vulkan::StackAllocator::Create(std::shared_ptr<lpe::renderi
   this->logger = lpe::ServiceLocator::LogManager.Get();
   this->manager = manager;
   this->device = manager->GetDevice();
+  this->allocator = manager->GetAllocationCallbacks();
+  this->deviceMemory = &manager->GetDeviceMemory();
   this->size = size;
   this->properties = properties;
   this->memory = nullptr;
+  this->mapped = nullptr;
   this->offset = 0;
   this->marker = 0;
+  this->peakUsage = 0;
   auto physicalDevice = manager->GetPhysicalDevice();
+  this->nonCoherentAtomSize = physicalDevice.getProperties().limits.nonCoherentAtomSize;
 
-  bool result = common::CreateBufferAllocateAndBindMemory(this->device,
-                                                          physicalDevice,
-                                                          this->buffer,
-                                                          this->memory,
-                                                          this->memoryType,
-                                                          this->size,
-                                                          usage,
-                                                          properties);
+  this->buffer = common::CreateBuffer(this->device, this->size, usage, nullptr, 0, allocator);
 
-  if (!result)
+  // own memory, so it can stay mapped as a whole
+  bool result = buffer &&
+                deviceMemory->Bind(buffer, properties, LPE_MEMORY_TAG("StackAllocator"), true) != VK_WHOLE_SIZE;
+
+  if (result)
   {
+    this->memory = deviceMemory->GetMemory(buffer);
+
+    if (properties & vk::MemoryPropertyFlagBits::eHostVisible)
     {
-      auto ptr = logger.lock();
+      result = device.mapMemory(this->memory, 0, this->size, vk::MemoryMapFlags(), &this->mapped) == vk::Result::eSuccess;
+    }
+  }
 
-      if (ptr)
-      {
-        ptr->Log("Could not initialize StackAllocator");
-      }
+  if (!result)
+  {
+    auto ptr = logger.lock();
+    if (ptr)
+    {
+      ptr->Log("Could not initialize StackAllocator");
     }
 
-    assert(buffer);
-    assert(memory);
+    // Allocate fails on the empty allocator from now on
+    Destroy();
   }
 }
 
 void lpe::rendering::vulkan::StackAllocator::Destroy()
 {
-  if(memory)
+  if (offset > 0)
   {
-    device.free(memory);
-    memory = nullptr;
+    auto ptr = logger.lock();
+    if (ptr)
+    {
+      ptr->Log("StackAllocator destroyed with " + std::to_string(offset) + " of " + std::to_string(size) +
+               " bytes still pushed (peak " + std::to_string(peakUsage) + ")");
+    }
+  }
+
+  if(mapped)
+  {
+    device.unmapMemory(memory);
+    mapped = nullptr;
   }
 
   if(buffer)
   {
-    device.destroyBuffer(buffer);
+    deviceMemory->Free(buffer);
+    device.destroyBuffer(buffer, allocator);
     buffer = nullptr;
   }
 
+  memory = nullptr;
   offset = 0;
   marker = 0;
   size = 0;
@@ -203,33 +1147,74 @@ void lpe::rendering::vulkan::StackAllocator::Destroy()
   manager.reset();
 }
 
-vk::DeviceSize lpe::rendering::vulkan::StackAllocator::Push(void *data, vk::DeviceSize size, lpe::rendering::vulkan::MarkerPosition pos)
+lpe::rendering::vulkan::StackAllocation lpe::rendering::vulkan::StackAllocator::Allocate(vk::DeviceSize size, vk::DeviceSize alignment, lpe::rendering::vulkan::MarkerPosition pos)
 {
-  vk::DeviceSize begin = offset;
-
-  assert((begin + size) <= this->size);
-
-  offset = offset + size;
+  vk::DeviceSize previous = offset;
+  vk::DeviceSize begin = (offset + alignment - 1) / alignment * alignment;
 
-  void* memory;
-  auto result = device.mapMemory(this->memory, begin, size, vk::MemoryMapFlags(), &memory);
-
-  assert(result == vk::Result::eSuccess);
+  if (begin > this->size || size > this->size - begin)
+  {
+    auto ptr = logger.lock();
+    if (ptr)
+    {
+      ptr->Log("StackAllocator is full, " + std::to_string(size) + " bytes don't fit into " +
+               std::to_string(this->size - offset) + " free bytes");
+    }
 
-  memcpy(memory, data, size);
+    return { VK_WHOLE_SIZE, nullptr };
+  }
 
-  device.unmapMemory(this->memory);
+  offset = begin + size;
+  peakUsage = std::max(peakUsage, offset);
 
   if (pos == MarkerPosition::Before)
   {
-    marker = begin;
+    marker = previous;
   }
   else if (pos == MarkerPosition::After)
   {
     marker = offset;
   }
 
-  return begin;
+  return { begin, mapped ? static_cast<uint8_t*>(mapped) + begin : nullptr };
+}
+
+void lpe::rendering::vulkan::StackAllocator::Flush(vk::DeviceSize offset, vk::DeviceSize size) const
+{
+  if (!mapped || (properties & vk::MemoryPropertyFlagBits::eHostCoherent))
+  {
+    return;
+  }
+
+  if (!common::FlushMappedMemory(device, memory, this->size, nonCoherentAtomSize, offset, size))
+  {
+    auto ptr = logger.lock();
+    if (ptr)
+    {
+      ptr->Log("Could not flush the mapped memory of the StackAllocator");
+    }
+  }
+}
+
+vk::DeviceSize lpe::rendering::vulkan::StackAllocator::Reserve(vk::DeviceSize size, lpe::rendering::vulkan::MarkerPosition pos, vk::DeviceSize alignment)
+{
+  return Allocate(size, alignment, pos).offset;
+}
+
+vk::DeviceSize lpe::rendering::vulkan::StackAllocator::Push(const void *data, vk::DeviceSize size, lpe::rendering::vulkan::MarkerPosition pos, vk::DeviceSize alignment)
+{
+  assert(mapped);
+
+  auto allocation = Allocate(size, alignment, pos);
+  if (allocation.offset == VK_WHOLE_SIZE)
+  {
+    return VK_WHOLE_SIZE;
+  }
+
+  memcpy(allocation.data, data, size);
+  Flush(allocation.offset, size);
+
+  return allocation.offset;
 }
 
 vk::DeviceSize lpe::rendering::vulkan::StackAllocator::Pop(bool complete)
@@ -256,6 +1241,36 @@ bool lpe::rendering::vulkan::StackAllocator::Fits(vk::DeviceSize size) const
   return offset + size <= this->size;
 }
 
+vk::Buffer lpe::rendering::vulkan::StackAllocator::GetBuffer() const
+{
+  return buffer;
+}
+
+vk::DeviceSize lpe::rendering::vulkan::StackAllocator::GetSize() const
+{
+  return size;
+}
+
+vk::DeviceSize lpe::rendering::vulkan::StackAllocator::GetUsage() const
+{
+  return offset;
+}
+
+vk::DeviceSize lpe::rendering::vulkan::StackAllocator::GetPeakUsage() const
+{
+  return peakUsage;
+}
+
+void lpe::rendering::vulkan::StackAllocator::ResetPeakUsage()
+{
+  peakUsage = offset;
+}
+
+void* lpe::rendering::vulkan::StackAllocator::GetMappedData() const
+{
+  return mapped;
+}
+
 lpe::rendering::vulkan::StackAllocator::StackAllocator()
 {
   this->device = nullptr;
@@ -264,8 +1279,12 @@ lpe::rendering::vulkan::StackAllocator::StackAllocator()
   this->size = 0;
   this->offset = 0;
   this->marker = 0;
+  this->nonCoherentAtomSize = 1;
   this->properties = {};
-  this->memoryType = 0;
+  this->mapped = nullptr;
+  this->peakUsage = 0;
+  this->allocator = nullptr;
+  this->deviceMemory = nullptr;
 }
 
 
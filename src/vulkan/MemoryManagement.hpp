@@ -2,9 +2,12 @@
 #define LOWPOLYENGINE_MEMORYMANAGEMENT_HPP
 
 #include "../LogManager.h"
+#include "../MemoryPool.h"
 
 #include <vulkan/vulkan.hpp>
 #include <map>
+#include <set>
+#include <string>
 
 namespace lpe
 {
@@ -18,18 +21,25 @@ vk::Buffer CreateBuffer(vk::Device device,
                         vk::DeviceSize size,
                         vk::BufferUsageFlags usage,
                         const uint32_t *queueFamilies = nullptr,
-                        uint32_t queueFamilyCount = 0);
+                        uint32_t queueFamilyCount = 0,
+                        const vk::AllocationCallbacks* allocator = nullptr);
 
 uint32_t GetMemoryType(vk::PhysicalDeviceMemoryProperties deviceProperties,
                        vk::MemoryRequirements requirements,
                        vk::MemoryPropertyFlags properties,
                        uint32_t typeOffset = 0);
 
+/*!
+ * Tries every memory type matching requirements and properties until one has room
+ *
+ * @return memory type, UINT32_MAX with memory set to nullptr if none had room
+ */
 uint32_t AllocateMemory(vk::Device device,
                         vk::PhysicalDevice physicalDevice,
                         vk::MemoryRequirements requirements,
                         vk::MemoryPropertyFlags properties,
-                        vk::DeviceMemory *memory);
+                        vk::DeviceMemory *memory,
+                        const vk::AllocationCallbacks* allocator = nullptr);
 
 bool CreateBufferAllocateAndBindMemory(vk::Device device,
                                        vk::PhysicalDevice physicalDevice,
@@ -40,52 +50,408 @@ bool CreateBufferAllocateAndBindMemory(vk::Device device,
                                        vk::BufferUsageFlags usage,
                                        vk::MemoryPropertyFlags properties,
                                        const uint32_t *queueFamilies = nullptr,
-                                       uint32_t queueFamilyCount = 0);
+                                       uint32_t queueFamilyCount = 0,
+                                       const vk::AllocationCallbacks* allocator = nullptr);
+
+/*!
+ * Flushes [offset, offset + size) of mapped memory, widened to multiples of nonCoherentAtomSize
+ *
+ * @return false if the driver call failed
+ */
+bool FlushMappedMemory(vk::Device device,
+                       vk::DeviceMemory memory,
+                       vk::DeviceSize memorySize,
+                       vk::DeviceSize nonCoherentAtomSize,
+                       vk::DeviceSize offset,
+                       vk::DeviceSize size);
 }
 
 class VulkanManager;
 
-class Chunk
+/*!
+ * Who allocated a resource, shown by the statistics and the leak report.
+ * LPE_MEMORY_TAG("name") fills in the callsite.
+ */
+struct AllocationTag
+{
+  const char* name;
+  const char* file;
+  uint32_t line;
+};
+
+#define LPE_MEMORY_TAG(name) lpe::rendering::vulkan::AllocationTag{ name, __FILE__, __LINE__ }
+
+struct ChunkStatistics
+{
+  uint32_t memoryType;
+  uint32_t heap;
+  bool dedicated;
+  bool transient;  // chunk of the transient attachment pools (see BindTransient)
+  vk::DeviceSize size;
+  vk::DeviceSize usage;
+  vk::DeviceSize largestFreeBlock;
+  size_t allocationCount;
+  float fragmentation;  // 1 - largestFreeBlock / free bytes, 0 if the free memory is one range
+};
+
+/*!
+ * Resources of one tag (and resource class)
+ */
+struct TagStatistics
+{
+  AllocationTag tag;
+  bool image;
+  size_t count;
+  vk::DeviceSize size;
+};
+
+struct MemoryStatistics
+{
+  std::vector<ChunkStatistics> chunks;
+  std::vector<TagStatistics> tags;
+
+  vk::DeviceSize size;
+  vk::DeviceSize usage;
+  size_t imageCount;
+  vk::DeviceSize imageUsage;
+  size_t bufferCount;
+  vk::DeviceSize bufferUsage;
+  size_t rangeCount;  // AllocateRange
+  vk::DeviceSize rangeUsage;
+};
+
+/*!
+ * vk::DeviceMemory for the MemoryPools of the GeneralPurposeAllocator, handles are VkDeviceMemory.
+ * Refuses allocations which would exceed the budget of their heap.
+ */
+class DeviceMemoryBackend : public IMemoryBackend
 {
 private:
-  struct DataItem {
-    vk::DeviceSize offset;
+  struct Block
+  {
     vk::DeviceSize size;
+    uint32_t heap;
   };
 
-  vk::DeviceMemory memory;
   vk::Device device;
-  vk::DeviceSize size;
-  vk::DeviceSize alignment;
-  vk::DeviceSize usage;
+  vk::PhysicalDevice physicalDevice;
+  vk::PhysicalDeviceMemoryProperties memoryProperties;
+  bool memoryBudget;
+  const vk::AllocationCallbacks* allocator;
+
+  std::vector<vk::DeviceSize> heapAllocated;  // own device memory per heap
+  std::vector<vk::DeviceSize> heapUsage;
+  std::vector<vk::DeviceSize> heapBudget;
+
+  std::map<uint64_t, Block> blocks;
 
-  std::vector<DataItem> items;
 public:
-  Chunk() = default;
-  ~Chunk() = default;
+  DeviceMemoryBackend();
+  DeviceMemoryBackend(const DeviceMemoryBackend& other) = delete;
+  DeviceMemoryBackend(DeviceMemoryBackend&& other) noexcept = delete;
+  DeviceMemoryBackend& operator=(const DeviceMemoryBackend& other) = delete;
+  DeviceMemoryBackend& operator=(DeviceMemoryBackend&& other) noexcept = delete;
+  ~DeviceMemoryBackend() override = default;
 
-  const vk::DeviceMemory& Create(vk::Device device, vk::PhysicalDevice physicalDevice, vk::MemoryRequirements requirements, vk::MemoryPropertyFlags propertyFlags);
+  /*!
+   * @param device
+   * @param physicalDevice
+   * @param memoryBudget true if VK_EXT_memory_budget is enabled on the device
+   * @param allocator host memory callbacks of the device (VulkanManager::GetAllocationCallbacks)
+   */
+  void Create(vk::Device device,
+              vk::PhysicalDevice physicalDevice,
+              bool memoryBudget = false,
+              const vk::AllocationCallbacks* allocator = nullptr);
   void Destroy();
 
-  bool Fits(vk::DeviceSize size) const;
+  /*!
+   * @param size
+   * @param memoryType
+   * @param next e.g. vk::MemoryDedicatedAllocateInfo
+   * @return VkDeviceMemory or InvalidHandle if allocateMemory failed or the heap has no budget left
+   */
+  uint64_t Allocate(uint64_t size,
+                    uint32_t memoryType,
+                    const void* next = nullptr) override;
+  void Free(uint64_t handle) override;
+
+  static vk::DeviceMemory GetMemory(uint64_t handle);
+
+  void UpdateBudget();
+
+  const vk::PhysicalDeviceMemoryProperties& GetMemoryProperties() const;
+  uint32_t GetHeapCount() const;
+  vk::DeviceSize GetHeapAllocated(uint32_t heap) const;
+  vk::DeviceSize GetHeapUsage(uint32_t heap) const;
+  vk::DeviceSize GetHeapBudget(uint32_t heap) const;
+};
+
+/*!
+ * Move of one resource planned by GeneralPurposeAllocator::BeginDefragmentation.
+ * Exactly one of image and buffer is set.
+ */
+struct DefragmentationMove
+{
+  vk::Image image;
+  vk::Buffer buffer;
+  vk::DeviceMemory memory;  // destination, bind the new resource here
+  vk::DeviceSize offset;
+  vk::DeviceSize size;
+  vk::Image newImage;  // set by the caller once the copy is done, nullptr cancels the move
+  vk::Buffer newBuffer;
 };
 
+/*!
+ * Sub allocates images and buffers from large chunks, one pool of chunks per memory type.
+ * Drivers limit the number of allocations (maxMemoryAllocationCount, often 4096) and allocateMemory is slow,
+ * so resources share chunks of chunkSize bytes. Resources which the driver wants to have on their own
+ * (VK_KHR_dedicated_allocation, core in 1.1) or which take half a chunk get a dedicated allocation.
+ *
+ * bufferImageGranularity: optimal tiled images are padded to whole granularity pages,
+ * so linear resources (buffers, linear images) never share a page with them.
+ *
+ * New device memory is only allocated from heaps with budget left, the budget comes from
+ * VK_EXT_memory_budget if enabled and is 80% of the heap size (minus own allocations) otherwise.
+ * Exceeding it would let the driver move resources to system memory without telling anyone.
+ *
+ * The chunks themselves are managed by MemoryPool, which runs on HostMemoryBackend without a GPU as well.
+ */
 class GeneralPurposeAllocator
 {
 private:
-  std::map<vk::Image, Chunk*> images;
-  std::map<vk::Buffer, Chunk*> buffers;
-  std::vector<Chunk> chunks;
+  struct Allocation
+  {
+    MemoryChunk* chunk;
+    vk::DeviceSize offset;
+    vk::DeviceSize size;
+    vk::DeviceSize alignment;
+    AllocationTag tag;
+    bool transient;
+  };
 
+  struct PendingMove
+  {
+    Allocation source;
+    Allocation destination;
+  };
+
+  std::weak_ptr<lpe::utils::log::ILogManager> logger;
+
+  vk::Device device;
+  vk::DeviceSize granularity;
+  vk::DeviceSize chunkSize;
+  AllocationPolicy policy;
 
+  DeviceMemoryBackend backend;
+  std::map<uint32_t, MemoryPool> pools;
+  std::map<uint32_t, MemoryPool> transientPools;
+  std::map<vk::Image, Allocation> images;
+  std::map<vk::Buffer, Allocation> buffers;
+  std::map<std::pair<uint64_t, vk::DeviceSize>, Allocation> ranges;  // (VkDeviceMemory, offset)
+
+  struct MovedRange
+  {
+    Allocation source;
+    uint64_t frame;
+  };
+
+  std::vector<PendingMove> pendingMoves;
+  std::vector<MovedRange> movedRanges;  // sources of EndDefragmentation, freed by ReleaseMovedRanges
+
+  bool Allocate(vk::MemoryRequirements requirements,
+                vk::MemoryPropertyFlags properties,
+                const vk::MemoryDedicatedAllocateInfo* dedicated,
+                const AllocationTag& tag,
+                Allocation& allocation,
+                bool transient = false);
+  MemoryPool& GetPool(uint32_t memoryType,
+                      bool transient = false);
+  void Free(const Allocation& allocation);
+  bool WantsDedicated(vk::DeviceSize size,
+                      const vk::MemoryDedicatedRequirements& dedicatedRequirements) const;
 
 public:
-  GeneralPurposeAllocator() = default;
+  GeneralPurposeAllocator();
+  GeneralPurposeAllocator(const GeneralPurposeAllocator& other) = delete;
+  GeneralPurposeAllocator(GeneralPurposeAllocator&& other) noexcept = delete;
+  GeneralPurposeAllocator& operator=(const GeneralPurposeAllocator& other) = delete;
+  GeneralPurposeAllocator& operator=(GeneralPurposeAllocator&& other) noexcept = delete;
   ~GeneralPurposeAllocator() = default;
 
-  vk::DeviceSize Bind(vk::Image image);
-  vk::DeviceSize Bind(vk::Buffer buffer);
+  /*!
+   * @param device
+   * @param physicalDevice
+   * @param chunkSize
+   * @param policy
+   * @param memoryBudget true if VK_EXT_memory_budget is enabled on the device
+   * @param allocator host memory callbacks for allocateMemory and freeMemory
+   */
+  void Create(vk::Device device,
+              vk::PhysicalDevice physicalDevice,
+              vk::DeviceSize chunkSize = 64 * 1024 * 1024,
+              AllocationPolicy policy = AllocationPolicy::Tlsf,
+              bool memoryBudget = false,
+              const vk::AllocationCallbacks* allocator = nullptr);
+
+  /*!
+   * Logs every image and buffer which still has memory (with its tag) before the chunks get freed
+   */
+  void Destroy();
+
+  /*!
+   * Queries the heap budgets again, the driver updates them when other processes allocate.
+   * Called before every new allocation, call it once per frame to keep GetHeapBudget current.
+   */
+  void UpdateBudget();
+
+  uint32_t GetHeapCount() const;
+
+  /*!
+   * @param heap
+   * @return device memory of the heap in use (by all processes with VK_EXT_memory_budget, own allocations otherwise)
+   */
+  vk::DeviceSize GetHeapUsage(uint32_t heap) const;
+  vk::DeviceSize GetHeapBudget(uint32_t heap) const;
+
+  /*!
+   * Only affects chunks created afterwards
+   */
+  void SetChunkSize(vk::DeviceSize chunkSize);
+
+  /*!
+   * Allocates and binds memory for the image
+   *
+   * @param image
+   * @param properties
+   * @param linear true for images with vk::ImageTiling::eLinear
+   * @param tag e.g. LPE_MEMORY_TAG("shadow map")
+   * @return offset inside its chunk or VK_WHOLE_SIZE on failure
+   */
+  vk::DeviceSize Bind(vk::Image image,
+                      vk::MemoryPropertyFlags properties = vk::MemoryPropertyFlagBits::eDeviceLocal,
+                      bool linear = false,
+                      const AllocationTag& tag = {});
+
+  /*!
+   * Allocates and binds memory for the buffer
+   *
+   * @param buffer
+   * @param properties
+   * @param tag
+   * @param ownMemory give the buffer a dedicated vk::DeviceMemory, e.g. for staging buffers which stay mapped
+   * as a whole (a vk::DeviceMemory can only be mapped once at a time)
+   * @return offset inside its chunk or VK_WHOLE_SIZE on failure
+   */
+  vk::DeviceSize Bind(vk::Buffer buffer,
+                      vk::MemoryPropertyFlags properties = vk::MemoryPropertyFlagBits::eDeviceLocal,
+                      const AllocationTag& tag = {},
+                      bool ownMemory = false);
+
+  /*!
+   * @return memory the buffer is bound to by Bind, nullptr if it has none
+   */
+  vk::DeviceMemory GetMemory(vk::Buffer buffer) const;
+
+  /*!
+   * Allocates and binds memory for an image with vk::ImageUsageFlagBits::eTransientAttachment, e.g. depth or
+   * MSAA color which is cleared and discarded within one render pass (see Attachment::IsTransient).
+   * Lazily allocated memory is used if the driver offers it for the image: tile based GPUs keep the
+   * attachment in tile memory and only back pages which actually get touched. Otherwise the image goes to
+   * the device local transient pools, separate from the regular chunks, so render targets recreated on
+   * every resize don't fragment them and attachments of different passes can share chunks.
+   * Transient images never take part in a defragmentation.
+   *
+   * @param image
+   * @param tag
+   * @return offset inside its chunk or VK_WHOLE_SIZE on failure
+   */
+  vk::DeviceSize BindTransient(vk::Image image,
+                               const AllocationTag& tag = {});
+
+  /*!
+   * @return true if some memory type is lazily allocated, BindTransient doesn't take device local memory then
+   */
+  bool SupportsLazilyAllocated() const;
 
+  /*!
+   * Allocates memory which isn't bound to anything, the caller binds its resources itself.
+   * Used for several images aliasing the same memory (see AliasedRenderTargets).
+   *
+   * @param requirements memoryTypeBits of all resources which get bound to the range
+   * @param properties
+   * @param memory receives the vk::DeviceMemory of the range
+   * @param tag
+   * @param transient allocate from the transient pools (see BindTransient)
+   * @return offset inside memory or VK_WHOLE_SIZE on failure
+   */
+  vk::DeviceSize AllocateRange(vk::MemoryRequirements requirements,
+                               vk::MemoryPropertyFlags properties,
+                               vk::DeviceMemory& memory,
+                               const AllocationTag& tag = {},
+                               bool transient = false);
+
+  /*!
+   * Releases a range of AllocateRange, resources bound to it have to be destroyed before
+   */
+  void FreeRange(vk::DeviceMemory memory,
+                 vk::DeviceSize offset);
+
+  /*!
+   * Releases the memory range, the image or buffer itself isn't destroyed
+   */
+  void Free(vk::Image image);
+  void Free(vk::Buffer buffer);
+
+  /*!
+   * First half of an incremental defragmentation step. Picks the most sparsely used chunks which only
+   * hold movable resources and reserves compact ranges in the other chunks of their pool, up to maxBytes.
+   * Vulkan can't rebind memory, so for every move the caller creates a copy of the resource bound to
+   * move.memory at move.offset, copies the contents (e.g. on the transfer queue) and once the copy is
+   * done passes the new handle to EndDefragmentation. Moved resources must not be freed in between.
+   *
+   * @param images resources the caller is able to recreate
+   * @param buffers
+   * @param maxBytes limit for one step, spread the work over several frames
+   * @param maxUsage only chunks used below this ratio are emptied
+   * @return moves, empty if there is nothing worth defragmenting
+   */
+  std::vector<DefragmentationMove> BeginDefragmentation(const std::vector<vk::Image>& images,
+                                                        const std::vector<vk::Buffer>& buffers,
+                                                        vk::DeviceSize maxBytes,
+                                                        float maxUsage = 0.5f);
+
+  /*!
+   * Second half: the new handles take over the destination ranges. The old ranges stay allocated,
+   * frames in flight (on any queue) may still read the old resources, until ReleaseMovedRanges is called
+   * with a completed frame >= frame. Destroy the old resources after those frames as well, their Free
+   * calls are ignored.
+   *
+   * @param moves result of BeginDefragmentation with newImage / newBuffer filled in
+   * @param frame index of the frame which recorded the last use of the old resources
+   */
+  void EndDefragmentation(const std::vector<DefragmentationMove>& moves,
+                          uint64_t frame);
+
+  /*!
+   * Frees the old ranges of EndDefragmentation whose frame is done on the GPU,
+   * chunks which became empty are released.
+   *
+   * @param completedFrame every frame up to this index finished on all queues, UINT64_MAX frees everything
+   */
+  void ReleaseMovedRanges(uint64_t completedFrame);
+
+  size_t GetChunkCount() const;
+
+  /*!
+   * Usage and fragmentation of every chunk and the memory per tag, e.g. to tune the chunk size
+   */
+  MemoryStatistics GetStatistics() const;
+
+  /*!
+   * GetStatistics plus the heap budgets as JSON
+   */
+  std::string GetStatisticsJson() const;
 };
 
 enum class MarkerPosition
@@ -95,6 +461,15 @@ enum class MarkerPosition
   After
 };
 
+/*!
+ * Range of a StackAllocator, data points to the persistent mapping (nullptr for device local memory)
+ */
+struct StackAllocation
+{
+  vk::DeviceSize offset;
+  void* data;
+};
+
 // TODO: rule of three constructors
 class StackAllocator
 {
@@ -103,34 +478,107 @@ private:
   std::weak_ptr<lpe::utils::log::ILogManager> logger;
 
   vk::Device device;
+  const vk::AllocationCallbacks* allocator;
+  GeneralPurposeAllocator* deviceMemory;  // of the manager, the buffer has its own vk::DeviceMemory there
   vk::Buffer buffer;
   vk::DeviceMemory memory;
   vk::DeviceSize size;
   vk::DeviceSize offset;
   vk::DeviceSize marker;
+  vk::DeviceSize nonCoherentAtomSize;
   vk::MemoryPropertyFlags properties;
-  uint32_t memoryType;
+  void* mapped;
+  vk::DeviceSize peakUsage;
 
 public:
   StackAllocator();
 
   ~StackAllocator() = default;
 
+  /*!
+   * The buffer gets its own vk::DeviceMemory from the GeneralPurposeAllocator of the manager,
+   * so it counts against the heap budget and shows up in the statistics
+   *
+   * @param manager
+   * @param size
+   * @param properties
+   * @param usage
+   */
   void Create(std::shared_ptr<lpe::rendering::vulkan::VulkanManager> manager,
               vk::DeviceSize size,
               vk::MemoryPropertyFlags properties = vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent,
               vk::BufferUsageFlags usage = vk::BufferUsageFlagBits::eTransferSrc);
+
+  /*!
+   * Logs the bytes which were never popped
+   */
   void Destroy();
 
-  vk::DeviceSize Push(void *data,
+  /*!
+   * Reserves size bytes and returns where to write them, the memory stays mapped from Create to Destroy
+   * so callers (e.g. worker threads) can fill the range directly without another copy.
+   * Call Flush afterwards, it only costs a driver call for memory which isn't host coherent.
+   *
+   * @param size
+   * @param alignment
+   * @param pos
+   * @return offset inside GetBuffer() and the mapped pointer to it, { VK_WHOLE_SIZE, nullptr } if the range
+   * doesn't fit (nothing gets reserved then)
+   */
+  StackAllocation Allocate(vk::DeviceSize size,
+                           vk::DeviceSize alignment = 1,
+                           MarkerPosition pos = MarkerPosition::None);
+
+  /*!
+   * Makes host writes to [offset, offset + size) visible to the device if the memory isn't host coherent
+   */
+  void Flush(vk::DeviceSize offset,
+             vk::DeviceSize size) const;
+
+  /*!
+   * Reserves size bytes without writing them. Same as Allocate(size, alignment, pos).offset
+   *
+   * @param size
+   * @param pos
+   * @param alignment
+   * @return offset of the reserved range, VK_WHOLE_SIZE if it doesn't fit
+   */
+  vk::DeviceSize Reserve(vk::DeviceSize size,
+                         MarkerPosition pos = MarkerPosition::None,
+                         vk::DeviceSize alignment = 1);
+
+  /*!
+   * Copies size bytes into a new range of host visible memory
+   *
+   * @return offset of the range, VK_WHOLE_SIZE if it doesn't fit (nothing gets copied then)
+   */
+  vk::DeviceSize Push(const void *data,
                       vk::DeviceSize size,
-                      MarkerPosition pos = MarkerPosition::None);
+                      MarkerPosition pos = MarkerPosition::None,
+                      vk::DeviceSize alignment = 1);
   vk::DeviceSize Pop(bool complete = false);
 
   void SetMarker(vk::DeviceSize offset);
   void RemoveMarker();
 
   bool Fits(vk::DeviceSize size) const;
+
+  vk::Buffer GetBuffer() const;
+  vk::DeviceSize GetSize() const;
+  vk::DeviceSize GetUsage() const;
+
+  /*!
+   * Highest usage since Create or ResetPeakUsage, the size the allocator actually needs
+   */
+  vk::DeviceSize GetPeakUsage() const;
+  void ResetPeakUsage();
+
+  /*!
+   * Host visible allocators stay mapped from Create to Destroy
+   *
+   * @return nullptr for device local memory
+   */
+  void* GetMappedData() const;
 };
 
 
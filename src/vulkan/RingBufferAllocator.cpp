@@ -0,0 +1,239 @@
+#include "RingBufferAllocator.hpp"
+#include "VulkanManager.hpp"
+#include "../ServiceLocator.h"
+
+lpe::rendering::vulkan::RingBufferAllocator::RingBufferAllocator()
+{
+  this->device = nullptr;
+  this->allocator = nullptr;
+  this->deviceMemory = nullptr;
+  this->buffer = nullptr;
+  this->memory = nullptr;
+  this->size = 0;
+  this->nonCoherentAtomSize = 1;
+  this->properties = {};
+  this->mapped = nullptr;
+  this->frame = 0;
+}
+
+bool lpe::rendering::vulkan::RingBufferAllocator::Create(std::shared_ptr<VulkanManager>&& manager,
+                                                         vk::DeviceSize size,
+                                                         uint32_t framesInFlight,
+                                                         vk::MemoryPropertyFlags properties,
+                                                         vk::BufferUsageFlags usage)
+{
+  assert(framesInFlight > 0);
+  assert(properties & vk::MemoryPropertyFlagBits::eHostVisible);
+
+  this->logger = lpe::ServiceLocator::LogManager.Get();
+  this->manager = manager;
+  this->device = manager->GetDevice();
+  this->allocator = manager->GetAllocationCallbacks();
+  this->deviceMemory = &manager->GetDeviceMemory();
+  this->size = size;
+  this->properties = properties;
+  this->frame = 0;
+
+  auto physicalDevice = manager->GetPhysicalDevice();
+  this->nonCoherentAtomSize = physicalDevice.getProperties().limits.nonCoherentAtomSize;
+
+  this->buffer = common::CreateBuffer(this->device, this->size, usage, nullptr, 0, allocator);
+
+  // own memory, so it can stay mapped as a whole
+  bool result = buffer &&
+                deviceMemory->Bind(buffer, properties, LPE_MEMORY_TAG("RingBufferAllocator"), true) != VK_WHOLE_SIZE;
+
+  if (result)
+  {
+    this->memory = deviceMemory->GetMemory(buffer);
+
+    result = device.mapMemory(this->memory, 0, this->size, vk::MemoryMapFlags(), &this->mapped) == vk::Result::eSuccess;
+  }
+
+  // signaled like a finished frame, EndFrame resets them before they are handed to a submit
+  vk::FenceCreateInfo fenceCreateInfo = { vk::FenceCreateFlagBits::eSignaled };
+
+  fences.assign(framesInFlight, nullptr);
+  pending.assign(framesInFlight, false);
+
+  for (uint32_t i = 0; i < framesInFlight && result; ++i)
+  {
+    result = device.createFence(&fenceCreateInfo, allocator, &fences[i]) == vk::Result::eSuccess;
+  }
+
+  if (!result)
+  {
+    auto logPtr = logger.lock();
+    if (logPtr)
+    {
+      logPtr->Log("Could not initialize RingBufferAllocator");
+    }
+
+    Destroy();
+
+    return false;
+  }
+
+  ring.Create(size);
+
+  return true;
+}
+
+void lpe::rendering::vulkan::RingBufferAllocator::Destroy()
+{
+  std::vector<vk::Fence> used;
+  for (size_t i = 0; i < fences.size(); ++i)
+  {
+    if (fences[i] && pending[i])
+    {
+      used.push_back(fences[i]);
+    }
+  }
+
+  if (!used.empty())
+  {
+    device.waitForFences(static_cast<uint32_t>(used.size()), used.data(), VK_TRUE, std::numeric_limits<uint64_t>::max());
+  }
+
+  for (auto&& fence : fences)
+  {
+    if (fence)
+    {
+      device.destroyFence(fence, allocator);
+    }
+  }
+
+  fences.clear();
+  pending.clear();
+
+  if (mapped)
+  {
+    device.unmapMemory(memory);
+    mapped = nullptr;
+  }
+
+  if (buffer)
+  {
+    deviceMemory->Free(buffer);
+    device.destroyBuffer(buffer, allocator);
+    buffer = nullptr;
+  }
+
+  memory = nullptr;
+
+  ring.Create(0);
+  size = 0;
+  frame = 0;
+
+  logger.reset();
+  manager.reset();
+}
+
+bool lpe::rendering::vulkan::RingBufferAllocator::BeginFrame()
+{
+  assert(!fences.empty());
+
+  auto index = frame % fences.size();
+  if (!pending[index])
+  {
+    return true;
+  }
+
+  auto result = device.waitForFences(1, &fences[index], VK_TRUE, std::numeric_limits<uint64_t>::max());
+  if (result != vk::Result::eSuccess)
+  {
+    auto logPtr = logger.lock();
+    if (logPtr)
+    {
+      logPtr->Log("Could not wait for the fence of the RingBufferAllocator");
+    }
+
+    return false;
+  }
+
+  // frames end in the order of their fences, so the oldest closed frame is the one of this fence
+  ring.RetireFrame();
+  pending[index] = false;
+
+  return true;
+}
+
+lpe::rendering::vulkan::StackAllocation lpe::rendering::vulkan::RingBufferAllocator::Allocate(vk::DeviceSize size, vk::DeviceSize alignment)
+{
+  auto offset = ring.Allocate(size, alignment);
+  if (offset == RingAllocator::InvalidOffset)
+  {
+    auto logPtr = logger.lock();
+    if (logPtr)
+    {
+      logPtr->Log("RingBufferAllocator is full, the frames in flight use too much memory");
+    }
+
+    return { VK_WHOLE_SIZE, nullptr };
+  }
+
+  return { offset, static_cast<uint8_t*>(mapped) + offset };
+}
+
+void lpe::rendering::vulkan::RingBufferAllocator::Flush(vk::DeviceSize offset, vk::DeviceSize size) const
+{
+  if (properties & vk::MemoryPropertyFlagBits::eHostCoherent)
+  {
+    return;
+  }
+
+  if (!common::FlushMappedMemory(device, memory, this->size, nonCoherentAtomSize, offset, size))
+  {
+    auto logPtr = logger.lock();
+    if (logPtr)
+    {
+      logPtr->Log("Could not flush the mapped memory of the RingBufferAllocator");
+    }
+  }
+}
+
+vk::Fence lpe::rendering::vulkan::RingBufferAllocator::EndFrame()
+{
+  assert(!fences.empty());
+
+  auto index = frame % fences.size();
+  assert(!pending[index]);
+
+  device.resetFences(1, &fences[index]);
+
+  ring.EndFrame();
+  pending[index] = true;
+  ++frame;
+
+  return fences[index];
+}
+
+vk::Buffer lpe::rendering::vulkan::RingBufferAllocator::GetBuffer() const
+{
+  return buffer;
+}
+
+vk::DeviceSize lpe::rendering::vulkan::RingBufferAllocator::GetSize() const
+{
+  return size;
+}
+
+vk::DeviceSize lpe::rendering::vulkan::RingBufferAllocator::GetUsage() const
+{
+  return ring.GetUsage();
+}
+
+vk::DeviceSize lpe::rendering::vulkan::RingBufferAllocator::GetPeakUsage() const
+{
+  return ring.GetPeakUsage();
+}
+
+vk::DeviceSize lpe::rendering::vulkan::RingBufferAllocator::GetPeakFrameUsage() const
+{
+  return ring.GetPeakFrameUsage();
+}
+
+void lpe::rendering::vulkan::RingBufferAllocator::ResetPeaks()
+{
+  ring.ResetPeaks();
+}
@@ -0,0 +1,123 @@
+#ifndef LOWPOLYENGINE_RINGBUFFERALLOCATOR_HPP
+#define LOWPOLYENGINE_RINGBUFFERALLOCATOR_HPP
+
+#include "MemoryManagement.hpp"
+#include "../RingAllocator.h"
+
+namespace lpe
+{
+namespace rendering
+{
+namespace vulkan
+{
+
+/*!
+ * Persistently mapped buffer for data which changes every frame (uniforms, instance data, small uploads).
+ * Each frame appends to a ring and gets a fence, the range of a frame is only reused after its fence
+ * signaled, so the CPU never overwrites data the GPU still reads and doesn't wait as long as the
+ * frames in flight fit into the buffer.
+ *
+ * Usage per frame: BeginFrame, Allocate/Flush as often as needed, record, submit with the fence of EndFrame.
+ */
+class RingBufferAllocator
+{
+private:
+  std::weak_ptr<VulkanManager> manager;
+  std::weak_ptr<lpe::utils::log::ILogManager> logger;
+
+  vk::Device device;
+  const vk::AllocationCallbacks* allocator;
+  GeneralPurposeAllocator* deviceMemory;  // of the manager, the buffer has its own vk::DeviceMemory there
+  vk::Buffer buffer;
+  vk::DeviceMemory memory;
+  vk::DeviceSize size;
+  vk::DeviceSize nonCoherentAtomSize;
+  vk::MemoryPropertyFlags properties;
+  void* mapped;
+
+  RingAllocator ring;
+  std::vector<vk::Fence> fences;
+  std::vector<bool> pending;
+  uint64_t frame;
+
+public:
+  RingBufferAllocator();
+  RingBufferAllocator(const RingBufferAllocator& other) = delete;
+  RingBufferAllocator(RingBufferAllocator&& other) noexcept = delete;
+  RingBufferAllocator& operator=(const RingBufferAllocator& other) = delete;
+  RingBufferAllocator& operator=(RingBufferAllocator&& other) noexcept = delete;
+  ~RingBufferAllocator() = default;
+
+  /*!
+   * @param manager
+   * @param size of the whole ring, should hold framesInFlight frames
+   * @param framesInFlight number of frames the GPU may still read while the CPU writes the next one
+   * @param properties has to be host visible
+   * @param usage
+   * @return false if the buffer, the memory (e.g. no budget left) or the fences couldn't be created
+   */
+  bool Create(std::shared_ptr<VulkanManager>&& manager,
+              vk::DeviceSize size,
+              uint32_t framesInFlight = 2,
+              vk::MemoryPropertyFlags properties = vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent,
+              vk::BufferUsageFlags usage = vk::BufferUsageFlagBits::eTransferSrc | vk::BufferUsageFlagBits::eUniformBuffer |
+                                           vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eVertexBuffer |
+                                           vk::BufferUsageFlagBits::eIndexBuffer);
+
+  /*!
+   * Waits for all frames in flight
+   */
+  void Destroy();
+
+  /*!
+   * Waits until the GPU is done with the frame which used the same fence (framesInFlight frames ago)
+   * and reclaims its range.
+   *
+   * @return false if waiting for the fence failed
+   */
+  bool BeginFrame();
+
+  /*!
+   * Reserves size bytes in the current frame. Uniform buffers need minUniformBufferOffsetAlignment.
+   *
+   * @param size
+   * @param alignment
+   * @return offset inside GetBuffer() and mapped pointer, data is nullptr if the ring is full
+   */
+  StackAllocation Allocate(vk::DeviceSize size,
+                           vk::DeviceSize alignment = 1);
+
+  /*!
+   * Makes host writes visible to the device if the memory isn't host coherent
+   */
+  void Flush(vk::DeviceSize offset,
+             vk::DeviceSize size) const;
+
+  /*!
+   * Closes the current frame
+   *
+   * @return fence which the submit reading this frame's data has to signal
+   */
+  vk::Fence EndFrame();
+
+  vk::Buffer GetBuffer() const;
+  vk::DeviceSize GetSize() const;
+  vk::DeviceSize GetUsage() const;
+
+  /*!
+   * Largest usage of all frames in flight together, close to GetSize() means BeginFrame has to wait soon
+   */
+  vk::DeviceSize GetPeakUsage() const;
+
+  /*!
+   * Largest usage of one frame
+   */
+  vk::DeviceSize GetPeakFrameUsage() const;
+  void ResetPeaks();
+};
+
+} // vulkan
+} // rendering
+} // lpe
+
+#endif //LOWPOLYENGINE_RINGBUFFERALLOCATOR_HPP
@@ -0,0 +1,180 @@
+#include "TextureLoader.hpp"
+#include "VulkanManager.hpp"
+#include "../ServiceLocator.h"
+
+void lpe::rendering::vulkan::TextureLoader::Create(std::shared_ptr<VulkanManager>&& manager,
+                                                   uint32_t threadCount)
+{
+  this->logger = lpe::ServiceLocator::LogManager.Get();
+  this->manager = manager;
+
+  pool.Start(threadCount);
+}
+
+void lpe::rendering::vulkan::TextureLoader::Destroy()
+{
+  pool.Stop();
+  requests.clear();
+
+  manager.reset();
+  logger.reset();
+}
+
+void lpe::rendering::vulkan::TextureLoader::Add(VulkanImage& image,
+                                                std::weak_ptr<lpe::utils::Resource> resource,
+                                                int desiredChannels)
+{
+  requests.push_back({ &image, std::move(resource), desiredChannels });
+}
+
+uint32_t lpe::rendering::vulkan::TextureLoader::Flush()
+{
+  auto vulkan = manager.lock();
+  if (!vulkan || requests.empty())
+  {
+    return 0;
+  }
+
+  auto& allocator = vulkan->GetDeviceLocalMemory();
+  assert(allocator.GetMappedData());
+
+  // headers only: reserve a staging range for every image which still fits
+  std::vector<Pending> pending;
+  std::vector<Request> deferred;
+
+  for (auto&& request : requests)
+  {
+    auto resource = request.resource.lock();
+    if (!resource)
+    {
+      continue;
+    }
+
+    const uint8_t* data;
+    uint64_t size = resource->GetData(&data);
+
+    ImageUpload upload = {};
+    if (!request.image->PrepareUpload(vulkan, data, size, request.desiredChannels, upload))
+    {
+      auto logPtr = logger.lock();
+      if (logPtr)
+      {
+        logPtr->Log("TextureLoader dropped a texture which could not be read");
+      }
+
+      continue;
+    }
+
+    if (!allocator.Fits(upload.size + upload.alignment))
+    {
+      deferred.push_back(request);
+      continue;
+    }
+
+    if (!request.image->Create(std::shared_ptr<VulkanManager>(vulkan)))
+    {
+      auto logPtr = logger.lock();
+      if (logPtr)
+      {
+        logPtr->Log("TextureLoader dropped a texture whose image could not be created");
+      }
+
+      continue;
+    }
+
+    auto staging = allocator.Allocate(upload.size,
+                                      upload.alignment,
+                                      pending.empty() ? MarkerPosition::Before : MarkerPosition::None);
+
+    pending.push_back({ request.image, std::move(resource), std::move(upload), staging, false });
+  }
+
+  requests = std::move(deferred);
+
+  if (pending.empty())
+  {
+    auto logPtr = logger.lock();
+    if (logPtr && !requests.empty())
+    {
+      logPtr->Log("Texture does not fit into the staging memory");
+    }
+
+    return 0;
+  }
+
+  // every job writes its own range, no locking needed
+  for (auto&& item : pending)
+  {
+    pool.Submit([&item]()
+                {
+                  const uint8_t* data;
+                  uint64_t size = item.resource->GetData(&data);
+
+                  item.written = item.image->WriteUpload(data, size, item.upload, static_cast<uint8_t*>(item.staging.data));
+                });
+  }
+
+  pool.Wait();
+
+  auto commandBuffer = vulkan->BeginSingleTimeCommands();
+  if (!commandBuffer)
+  {
+    allocator.Pop();
+
+    for (auto&& item : pending)
+    {
+      item.image->Destroy();
+    }
+
+    auto logPtr = logger.lock();
+    if (logPtr)
+    {
+      logPtr->Log("TextureLoader dropped " + std::to_string(pending.size()) + " textures, no command buffer for the upload");
+    }
+
+    return 0;
+  }
+
+  for (auto&& item : pending)
+  {
+    if (item.written)
+    {
+      allocator.Flush(item.staging.offset, item.upload.size);
+      item.image->RecordUpload(commandBuffer, allocator.GetBuffer(), item.staging.offset, item.upload);
+    }
+  }
+
+  bool uploaded = vulkan->EndSingleTimeCommands(commandBuffer);
+
+  allocator.Pop();
+
+  uint32_t ready = 0;
+
+  for (auto&& item : pending)
+  {
+    if (uploaded && item.written && item.image->CreateView())
+    {
+      ++ready;
+    }
+    else
+    {
+      item.image->Destroy();
+    }
+  }
+
+  if (ready < pending.size())
+  {
+    auto logPtr = logger.lock();
+    if (logPtr)
+    {
+      logPtr->Log("TextureLoader dropped " + std::to_string(pending.size() - ready) + " textures whose upload failed");
+    }
+  }
+
+  return ready;
+}
+
+size_t lpe::rendering::vulkan::TextureLoader::GetQueued() const
+{
+  return requests.size();
+}
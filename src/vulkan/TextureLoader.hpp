@@ -0,0 +1,86 @@
+#ifndef LOWPOLYENGINE_TEXTURELOADER_HPP
+#define LOWPOLYENGINE_TEXTURELOADER_HPP
+
+#include "VulkanImage.hpp"
+#include "../ThreadPool.h"
+
+namespace lpe
+{
+namespace rendering
+{
+namespace vulkan
+{
+
+/*!
+ * Batches texture uploads: images get decoded on worker threads straight into the mapped
+ * staging memory and all copies go to the GPU with a single submit.
+ */
+class TextureLoader
+{
+private:
+  struct Request
+  {
+    VulkanImage* image;
+    std::weak_ptr<lpe::utils::Resource> resource;
+    int desiredChannels;
+  };
+
+  struct Pending
+  {
+    VulkanImage* image;
+    std::shared_ptr<lpe::utils::Resource> resource;
+    ImageUpload upload;
+    StackAllocation staging;
+    bool written;
+  };
+
+  std::weak_ptr<VulkanManager> manager;
+  std::weak_ptr<lpe::utils::log::ILogManager> logger;
+
+  lpe::utils::ThreadPool pool;
+  std::vector<Request> requests;
+
+public:
+  TextureLoader() = default;
+  TextureLoader(const TextureLoader& other) = delete;
+  TextureLoader(TextureLoader&& other) noexcept = delete;
+  TextureLoader& operator=(const TextureLoader& other) = delete;
+  TextureLoader& operator=(TextureLoader&& other) noexcept = delete;
+  ~TextureLoader() = default;
+
+  /*!
+   * @param manager
+   * @param threadCount 0 uses one thread per hardware thread
+   */
+  void Create(std::shared_ptr<VulkanManager>&& manager,
+              uint32_t threadCount = 0);
+
+  void Destroy();
+
+  /*!
+   * Queues an image, it gets created by the next Flush. The image has to stay alive until then.
+   *
+   * @param image
+   * @param resource
+   * @param desiredChannels
+   */
+  void Add(VulkanImage& image,
+           std::weak_ptr<lpe::utils::Resource> resource,
+           int desiredChannels = STBI_rgb_alpha);
+
+  /*!
+   * Decodes all queued images in parallel and uploads them with one submit.
+   * Images which don't fit into the staging memory anymore stay queued for the next call.
+   *
+   * @return number of images which are ready to use
+   */
+  uint32_t Flush();
+
+  size_t GetQueued() const;
+};
+
+} // vulkan
+} // rendering
+} // lpe
+
+#endif //LOWPOLYENGINE_TEXTURELOADER_HPP
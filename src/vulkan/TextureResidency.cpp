@@ -0,0 +1,585 @@
+#include "TextureResidency.hpp"
+#include "VulkanManager.hpp"
+#include "../ServiceLocator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+
+lpe::rendering::vulkan::TextureResidency::TextureResidency()
+{
+  this->budget = 0;
+  this->used = 0;
+  this->tailSize = 64;
+  this->framesInFlight = 2;
+  this->frame = 0;
+}
+
+void lpe::rendering::vulkan::TextureResidency::Create(std::shared_ptr<VulkanManager>&& manager,
+                                                      vk::DeviceSize budget,
+                                                      uint32_t tailSize,
+                                                      uint32_t framesInFlight)
+{
+  this->logger = lpe::ServiceLocator::LogManager.Get();
+  this->manager = manager;
+  this->budget = budget;
+  this->tailSize = tailSize;
+  this->framesInFlight = framesInFlight;
+  this->used = 0;
+  this->frame = 0;
+}
+
+void lpe::rendering::vulkan::TextureResidency::Destroy()
+{
+  for (auto&& entry : entries)
+  {
+    if (entry.active)
+    {
+      entry.image.Destroy();
+    }
+  }
+
+  Collect(true);
+
+  entries.clear();
+  freeHandles.clear();
+  changed.clear();
+  used = 0;
+
+  manager.reset();
+  logger.reset();
+}
+
+uint32_t lpe::rendering::vulkan::TextureResidency::Add(std::weak_ptr<lpe::utils::Resource> resource)
+{
+  Entry entry = {};
+  entry.resource = resource;
+  entry.lastUsed = frame;
+  entry.active = true;
+
+  auto ptr = resource.lock();
+  if (ptr)
+  {
+    const uint8_t* data;
+    uint64_t size = ptr->GetData(&data);
+
+    CookedTextureHeader header;
+    std::vector<CookedTextureLevel> levels;
+
+    if (ReadCookedTextureHeader(data, size, header, levels))
+    {
+      entry.size = std::max(header.Width, header.Height);
+      entry.tailLevel = header.LevelCount - 1;
+
+      for (uint32_t level = 0; level < header.LevelCount; ++level)
+      {
+        entry.levelSizes.push_back(levels[level].Size);
+
+        if (entry.tailLevel == header.LevelCount - 1 &&
+            std::max(levels[level].Width, levels[level].Height) <= tailSize)
+        {
+          entry.tailLevel = level;
+        }
+      }
+    }
+  }
+
+  // everything else is loaded as a whole
+  entry.levelCount = entry.levelSizes.empty() ? 1 : static_cast<uint32_t>(entry.levelSizes.size());
+  entry.residentLevel = entry.levelCount;
+  entry.requestedLevel = entry.tailLevel;
+
+  if (freeHandles.empty())
+  {
+    entries.push_back(std::move(entry));
+
+    return static_cast<uint32_t>(entries.size() - 1);
+  }
+
+  uint32_t handle = freeHandles.back();
+  freeHandles.pop_back();
+  entries[handle] = std::move(entry);
+
+  return handle;
+}
+
+void lpe::rendering::vulkan::TextureResidency::Remove(uint32_t handle)
+{
+  assert(handle < entries.size() && entries[handle].active);
+
+  auto& entry = entries[handle];
+
+  Retire(entry.image);
+  entry = {};
+
+  freeHandles.push_back(handle);
+}
+
+void lpe::rendering::vulkan::TextureResidency::Request(uint32_t handle,
+                                                       float screenSize)
+{
+  assert(handle < entries.size() && entries[handle].active);
+
+  auto& entry = entries[handle];
+
+  // one texel per pixel: every halving of the coverage drops one level
+  uint32_t level = entry.levelCount - 1;
+  if (entry.size > 0 && screenSize >= 1.0f)
+  {
+    float ratio = entry.size / screenSize;
+    level = ratio > 1.0f ?
+            static_cast<uint32_t>(std::floor(std::log2(ratio))) :
+            0;
+  }
+
+  level = std::min(level, entry.levelCount - 1);
+
+  entry.requestedLevel = entry.lastUsed == frame ?
+                         std::min(entry.requestedLevel, level) :
+                         level;
+  entry.lastUsed = frame;
+}
+
+vk::DeviceSize lpe::rendering::vulkan::TextureResidency::GetEstimate(const Entry& entry,
+                                                                     uint32_t level) const
+{
+  vk::DeviceSize size = 0;
+
+  for (uint32_t i = level; i < entry.levelSizes.size(); ++i)
+  {
+    size += entry.levelSizes[i];
+  }
+
+  return size;
+}
+
+void lpe::rendering::vulkan::TextureResidency::Retire(VulkanImage& image)
+{
+  if (image.GetImage())
+  {
+    retired.push_back({ image, frame });
+  }
+
+  image = VulkanImage();
+}
+
+void lpe::rendering::vulkan::TextureResidency::Collect(bool all)
+{
+  // the memory of moved images is reused after the same frames as the retired images
+  auto vulkan = manager.lock();
+  if (vulkan && (all || frame >= framesInFlight))
+  {
+    vulkan->GetDeviceMemory().ReleaseMovedRanges(all ? UINT64_MAX : frame - framesInFlight);
+  }
+
+  for (size_t i = 0; i < retired.size();)
+  {
+    if (all || frame >= retired[i].frame + framesInFlight)
+    {
+      used -= retired[i].image.GetMemorySize();
+      retired[i].image.Destroy();
+
+      retired[i] = std::move(retired.back());
+      retired.pop_back();
+    }
+    else
+    {
+      ++i;
+    }
+  }
+}
+
+uint32_t lpe::rendering::vulkan::TextureResidency::Update()
+{
+  uint64_t current = frame++;
+
+  auto vulkan = manager.lock();
+  if (!vulkan)
+  {
+    return 0;
+  }
+
+  changed.clear();
+  Collect(false);
+
+  // future: usage once the retired images are gone, allocated: everything alive right now
+  vk::DeviceSize retiredSize = 0;
+  for (auto&& item : retired)
+  {
+    retiredSize += item.image.GetMemorySize();
+  }
+
+  vk::DeviceSize future = used - retiredSize;
+  vk::DeviceSize allocated = used;
+
+  auto getWanted = [current](const Entry& entry)
+  {
+    // unseen textures keep what they have, the tail is always needed
+    uint32_t level = entry.lastUsed == current ?
+                     entry.requestedLevel :
+                     entry.residentLevel;
+
+    return std::min(level, entry.tailLevel);
+  };
+
+  std::vector<uint32_t> candidates;
+  std::vector<uint32_t> victims;
+
+  for (uint32_t handle = 0; handle < entries.size(); ++handle)
+  {
+    const auto& entry = entries[handle];
+    if (!entry.active)
+    {
+      continue;
+    }
+
+    if (getWanted(entry) < entry.residentLevel)
+    {
+      candidates.push_back(handle);
+    }
+
+    if (entry.lastUsed < current && entry.residentLevel < entry.tailLevel)
+    {
+      victims.push_back(handle);
+    }
+  }
+
+  // missing textures first, then the ones missing the most levels
+  std::sort(std::begin(candidates),
+            std::end(candidates),
+            [this, &getWanted](uint32_t a, uint32_t b)
+            {
+              const auto& first = entries[a];
+              const auto& second = entries[b];
+
+              bool firstMissing = first.residentLevel == first.levelCount;
+              bool secondMissing = second.residentLevel == second.levelCount;
+              if (firstMissing != secondMissing)
+              {
+                return firstMissing;
+              }
+
+              return first.residentLevel - getWanted(first) > second.residentLevel - getWanted(second);
+            });
+
+  std::sort(std::begin(victims),
+            std::end(victims),
+            [this](uint32_t a, uint32_t b)
+            {
+              return entries[a].lastUsed < entries[b].lastUsed;
+            });
+
+  std::vector<std::pair<uint32_t, uint32_t>> plan;
+  std::vector<bool> planned(entries.size(), false);
+  size_t nextVictim = 0;
+
+  // drops the least recently used texture back to its tail
+  auto evict = [&]()
+  {
+    while (nextVictim < victims.size())
+    {
+      uint32_t handle = victims[nextVictim++];
+      if (planned[handle])
+      {
+        continue;
+      }
+
+      const auto& entry = entries[handle];
+      auto tail = GetEstimate(entry, entry.tailLevel);
+
+      plan.emplace_back(handle, entry.tailLevel);
+      planned[handle] = true;
+      future = future - entry.image.GetMemorySize() + tail;
+      allocated += tail;
+
+      return true;
+    }
+
+    return false;
+  };
+
+  for (auto handle : candidates)
+  {
+    const auto& entry = entries[handle];
+    uint32_t level = getWanted(entry);
+
+    if (entry.residentLevel == entry.levelCount)
+    {
+      auto estimate = GetEstimate(entry, level);
+
+      while (future + estimate > budget && evict())
+      {
+      }
+
+      if (future + estimate > budget)
+      {
+        auto logPtr = logger.lock();
+        if (logPtr)
+        {
+          logPtr->Log("Texture residency budget is too small for the tail levels");
+        }
+      }
+
+      plan.emplace_back(handle, level);
+      planned[handle] = true;
+      future += estimate;
+      allocated += estimate;
+
+      continue;
+    }
+
+    auto resident = entry.image.GetMemorySize();
+    vk::DeviceSize estimate = 0;
+
+    for (; level < entry.residentLevel; ++level)
+    {
+      estimate = GetEstimate(entry, level);
+
+      while (future - resident + estimate > budget && evict())
+      {
+      }
+
+      if (future - resident + estimate <= budget)
+      {
+        break;
+      }
+    }
+
+    // the old image lives until it is retired, wait for memory of earlier evictions otherwise
+    if (level == entry.residentLevel || allocated + estimate > budget)
+    {
+      continue;
+    }
+
+    plan.emplace_back(handle, level);
+    planned[handle] = true;
+    future = future - resident + estimate;
+    allocated += estimate;
+  }
+
+  // the budget might have been lowered
+  while (future > budget && evict())
+  {
+  }
+
+  if (plan.empty())
+  {
+    return 0;
+  }
+
+  auto& allocator = vulkan->GetDeviceLocalMemory();
+  assert(allocator.GetMappedData());
+
+  std::vector<Change> changes;
+  bool reserved = false;
+
+  for (auto&& item : plan)
+  {
+    auto resource = entries[item.first].resource.lock();
+    if (!resource)
+    {
+      continue;
+    }
+
+    const uint8_t* data;
+    uint64_t size = resource->GetData(&data);
+
+    Change change = {};
+    change.handle = item.first;
+    change.level = item.second;
+
+    // textures which don't fit into the staging memory are retried by the next update
+    if (!change.image.PrepareUpload(vulkan, data, size, STBI_rgb_alpha, change.upload, change.level) ||
+        !allocator.Fits(change.upload.size + change.upload.alignment) ||
+        !change.image.Create(std::shared_ptr<VulkanManager>(vulkan)))
+    {
+      continue;
+    }
+
+    change.staging = allocator.Allocate(change.upload.size,
+                                        change.upload.alignment,
+                                        reserved ? MarkerPosition::None : MarkerPosition::Before);
+    reserved = true;
+
+    if (!change.image.WriteUpload(data, size, change.upload, static_cast<uint8_t*>(change.staging.data)))
+    {
+      change.image.Destroy();
+      continue;
+    }
+
+    allocator.Flush(change.staging.offset, change.upload.size);
+
+    used += change.image.GetMemorySize();
+    changes.push_back(std::move(change));
+  }
+
+  vk::CommandBuffer commandBuffer = nullptr;
+  if (!changes.empty())
+  {
+    commandBuffer = vulkan->BeginSingleTimeCommands();
+  }
+
+  if (!commandBuffer)
+  {
+    if (reserved)
+    {
+      allocator.Pop();
+    }
+
+    for (auto&& change : changes)
+    {
+      used -= change.image.GetMemorySize();
+      change.image.Destroy();
+    }
+
+    return 0;
+  }
+
+  for (auto&& change : changes)
+  {
+    change.image.RecordUpload(commandBuffer, allocator.GetBuffer(), change.staging.offset, change.upload);
+  }
+
+  bool uploaded = vulkan->EndSingleTimeCommands(commandBuffer);
+
+  allocator.Pop();
+
+  for (auto&& change : changes)
+  {
+    if (uploaded && change.image.CreateView())
+    {
+      auto& entry = entries[change.handle];
+
+      Retire(entry.image);
+      entry.image = change.image;
+      entry.residentLevel = change.level;
+
+      changed.push_back(change.handle);
+    }
+    else
+    {
+      used -= change.image.GetMemorySize();
+      change.image.Destroy();
+    }
+  }
+
+  return static_cast<uint32_t>(changed.size());
+}
+
+uint32_t lpe::rendering::vulkan::TextureResidency::Defragment(vk::DeviceSize maxBytes)
+{
+  auto vulkan = manager.lock();
+  if (!vulkan)
+  {
+    return 0;
+  }
+
+  std::map<vk::Image, uint32_t> handles;
+  std::vector<vk::Image> images;
+  for (uint32_t handle = 0; handle < entries.size(); ++handle)
+  {
+    auto& image = entries[handle].image;
+    if (entries[handle].active && image.GetImage() && image.GetMemorySize() > 0)
+    {
+      handles[image.GetImage()] = handle;
+      images.push_back(image.GetImage());
+    }
+  }
+
+  auto& memory = vulkan->GetDeviceMemory();
+  auto moves = memory.BeginDefragmentation(images, {}, maxBytes);
+  if (moves.empty())
+  {
+    return 0;
+  }
+
+  std::vector<VulkanImage> moved(moves.size());
+  std::vector<bool> created(moves.size(), false);
+
+  auto commandBuffer = vulkan->BeginSingleTimeCommands();
+
+  for (size_t i = 0; i < moves.size() && commandBuffer; ++i)
+  {
+    auto& source = entries[handles[moves[i].image]].image;
+
+    // same configuration, new vk::Image at the destination
+    moved[i] = source;
+    created[i] = moved[i].Create(std::shared_ptr<VulkanManager>(vulkan), moves[i].memory, moves[i].offset);
+
+    if (created[i])
+    {
+      moved[i].RecordCopy(commandBuffer, source);
+    }
+  }
+
+  bool copied = commandBuffer && vulkan->EndSingleTimeCommands(commandBuffer);
+
+  for (size_t i = 0; i < moves.size(); ++i)
+  {
+    if (copied && created[i] && moved[i].CreateView())
+    {
+      moves[i].newImage = moved[i].GetImage();
+    }
+  }
+
+  // hands the destination ranges over to the new images before anything gets destroyed
+  memory.EndDefragmentation(moves, frame);
+
+  uint32_t count = 0;
+  for (size_t i = 0; i < moves.size(); ++i)
+  {
+    if (moves[i].newImage)
+    {
+      auto handle = handles[moves[i].image];
+      auto& entry = entries[handle];
+
+      // the old image is still in use by the frames in flight
+      Retire(entry.image);
+      entry.image = moved[i];
+      used += entry.image.GetMemorySize();
+
+      changed.push_back(handle);
+      ++count;
+    }
+    else if (created[i])
+    {
+      moved[i].Destroy();
+    }
+  }
+
+  return count;
+}
+
+const std::vector<uint32_t>& lpe::rendering::vulkan::TextureResidency::GetChanged() const
+{
+  return changed;
+}
+
+const lpe::rendering::vulkan::VulkanImage& lpe::rendering::vulkan::TextureResidency::GetImage(uint32_t handle) const
+{
+  assert(handle < entries.size() && entries[handle].active);
+
+  return entries[handle].image;
+}
+
+uint32_t lpe::rendering::vulkan::TextureResidency::GetResidentLevel(uint32_t handle) const
+{
+  assert(handle < entries.size() && entries[handle].active);
+
+  return entries[handle].residentLevel;
+}
+
+vk::DeviceSize lpe::rendering::vulkan::TextureResidency::GetBudget() const
+{
+  return budget;
+}
+
+void lpe::rendering::vulkan::TextureResidency::SetBudget(vk::DeviceSize budget)
+{
+  this->budget = budget;
+}
+
+vk::DeviceSize lpe::rendering::vulkan::TextureResidency::GetUsed() const
+{
+  return used;
+}
@@ -0,0 +1,155 @@
+#ifndef LOWPOLYENGINE_TEXTURERESIDENCY_HPP
+#define LOWPOLYENGINE_TEXTURERESIDENCY_HPP
+
+#include "VulkanImage.hpp"
+
+namespace lpe
+{
+namespace rendering
+{
+namespace vulkan
+{
+
+/*!
+ * Keeps the device memory of cooked textures below a budget.
+ * Every texture starts with its small tail levels, larger levels are streamed in when the texture
+ * covers enough pixels on screen. Under pressure the large levels of textures which were not
+ * requested recently get dropped again, least recently used first.
+ *
+ * Vulkan images can't grow or shrink their mip chain, so a residency change creates a new image
+ * from the cooked data (which stays in memory as resource) and retires the old one once the frames
+ * in flight are done with it. Users have to rebind the views of all handles listed by GetChanged.
+ */
+class TextureResidency
+{
+private:
+  struct Entry
+  {
+    std::weak_ptr<lpe::utils::Resource> resource;
+    VulkanImage image;
+    std::vector<vk::DeviceSize> levelSizes;
+    uint32_t size;
+    uint32_t levelCount;
+    uint32_t tailLevel;
+    uint32_t residentLevel;  // levelCount = nothing resident
+    uint32_t requestedLevel;
+    uint64_t lastUsed;
+    bool active;
+  };
+
+  struct Retired
+  {
+    VulkanImage image;
+    uint64_t frame;
+  };
+
+  struct Change
+  {
+    uint32_t handle;
+    uint32_t level;
+    VulkanImage image;
+    ImageUpload upload;
+    StackAllocation staging;
+  };
+
+  std::weak_ptr<VulkanManager> manager;
+  std::weak_ptr<lpe::utils::log::ILogManager> logger;
+
+  std::vector<Entry> entries;
+  std::vector<uint32_t> freeHandles;
+  std::vector<Retired> retired;
+  std::vector<uint32_t> changed;
+
+  vk::DeviceSize budget;
+  vk::DeviceSize used;
+  uint32_t tailSize;
+  uint32_t framesInFlight;
+  uint64_t frame;
+
+  vk::DeviceSize GetEstimate(const Entry& entry,
+                             uint32_t level) const;
+  void Retire(VulkanImage& image);
+  void Collect(bool all);
+
+public:
+  TextureResidency();
+  TextureResidency(const TextureResidency& other) = delete;
+  TextureResidency(TextureResidency&& other) noexcept = delete;
+  TextureResidency& operator=(const TextureResidency& other) = delete;
+  TextureResidency& operator=(TextureResidency&& other) noexcept = delete;
+  ~TextureResidency() = default;
+
+  /*!
+   * @param manager
+   * @param budget device memory for all managed textures in bytes
+   * @param tailSize levels up to this width and height are always resident
+   * @param framesInFlight replaced images are destroyed after this many calls to Update
+   */
+  void Create(std::shared_ptr<VulkanManager>&& manager,
+              vk::DeviceSize budget,
+              uint32_t tailSize = 64,
+              uint32_t framesInFlight = 2);
+
+  void Destroy();
+
+  /*!
+   * Registers a cooked texture, its tail levels are loaded by the next Update.
+   * Other textures can't be streamed and become fully resident.
+   *
+   * @param resource
+   * @return handle
+   */
+  uint32_t Add(std::weak_ptr<lpe::utils::Resource> resource);
+
+  void Remove(uint32_t handle);
+
+  /*!
+   * Marks the texture as visible in the current frame.
+   *
+   * @param handle
+   * @param screenSize approximate number of pixels the texture covers along its larger side
+   */
+  void Request(uint32_t handle,
+               float screenSize);
+
+  /*!
+   * Uploads the requested levels which fit into the budget and the staging memory
+   * (all of them with one submit) and evicts levels of unused textures to make room.
+   * Call it once per frame.
+   *
+   * @return number of images which got replaced
+   */
+  uint32_t Update();
+
+  /*!
+   * One incremental defragmentation step of the device memory: images in sparsely used chunks get
+   * copied into other chunks (one submit, up to maxBytes) so the chunks can be released.
+   * Call it after Update, moved handles are added to GetChanged and need their views rebound as well.
+   *
+   * @param maxBytes
+   * @return number of moved images
+   */
+  uint32_t Defragment(vk::DeviceSize maxBytes = 16 * 1024 * 1024);
+
+  /*!
+   * Handles whose image got replaced by the last Update (or Defragment)
+   */
+  const std::vector<uint32_t>& GetChanged() const;
+
+  const VulkanImage& GetImage(uint32_t handle) const;
+
+  /*!
+   * Level of the cooked texture which is level 0 of the current image
+   */
+  uint32_t GetResidentLevel(uint32_t handle) const;
+
+  vk::DeviceSize GetBudget() const;
+  void SetBudget(vk::DeviceSize budget);
+  vk::DeviceSize GetUsed() const;
+};
+
+} // vulkan
+} // rendering
+} // lpe
+
+#endif //LOWPOLYENGINE_TEXTURERESIDENCY_HPP
@@ -1,7 +1,18 @@
 #include "VulkanImage.hpp"
 #include "VulkanManager.hpp"
+#include "../PixelConversion.h"
 #include "../ServiceLocator.h"
 
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include <emmintrin.h>
+#define LPE_SSE2
+#endif
+
 
 lpe::rendering::vulkan::VulkanImage& lpe::rendering::vulkan::VulkanImage::SetFormat(vk::Format format)
 {
@@ -54,6 +65,7 @@ bool lpe::rendering::vulkan::VulkanImage::Create(std::shared_ptr<lpe::rendering:
 
   // maybe use this->manager instead?
   this->device = manager->GetDevice();
+  this->allocator = manager->GetAllocationCallbacks();
 
   if (!lpe::rendering::vulkan::common::CreateImageView(device,
                                                        image,
@@ -64,7 +76,12 @@ bool lpe::rendering::vulkan::VulkanImage::Create(std::shared_ptr<lpe::rendering:
                                                        this->baseMipLevel,
                                                        this->mipLevels,
                                                        this->baseLayer,
-                                                       this->layers))
+                                                       this->layers,
+                                                       vk::ComponentSwizzle::eR,
+                                                       vk::ComponentSwizzle::eG,
+                                                       vk::ComponentSwizzle::eB,
+                                                       vk::ComponentSwizzle::eA,
+                                                       this->allocator))
   {
     auto logPtr = logger.lock();
     if (logPtr)
@@ -80,6 +97,8 @@ bool lpe::rendering::vulkan::VulkanImage::Create(std::shared_ptr<lpe::rendering:
 
 lpe::rendering::vulkan::VulkanImage::VulkanImage()
 {
+  this->allocator = nullptr;
+  this->memorySize = 0;
   this->format = vk::Format::eUndefined;
   this->mipLevels = VK_REMAINING_MIP_LEVELS;
   this->baseMipLevel = 0;
@@ -134,17 +153,30 @@ void lpe::rendering::vulkan::VulkanImage::Destroy()
 
   if (imageView)
   {
-    device.destroyImageView(imageView);
+    device.destroyImageView(imageView, allocator);
     imageView = nullptr;
   }
 
+  // swapchain images don't own their memory
+  if (image && memorySize > 0)
+  {
+    auto vulkan = manager.lock();
+    if (vulkan)
+    {
+      vulkan->GetDeviceMemory().Free(image);
+    }
+
+    memorySize = 0;
+  }
+
   if (image)
   {
-    device.destroyImage(image);
+    device.destroyImage(image, allocator);
     image = nullptr;
   }
 
   device = nullptr;
+  allocator = nullptr;
   manager.reset();
 }
 
@@ -160,28 +192,373 @@ bool lpe::rendering::vulkan::VulkanImage::Create(std::shared_ptr<VulkanManager>&
 
   const uint8_t *data;
   uint64_t size = ptr->GetData(&data);
-  int width, height, channels;
-  auto stbImage = stbi_load_from_memory(data, static_cast<int>(size), &width, &height, &channels, desiredChannels);
 
-  assert(stbImage && width > 0 && height > 0 && channels > 0);
+  ImageUpload upload = {};
+  if (!PrepareUpload(manager, data, size, desiredChannels, upload))
+  {
+    return false;
+  }
+
+  if (!this->Create(std::move(manager))) // TODO: still don't know if rvalue param is the best option. But nvm for now
+  {
+    return false;
+  }
+
+  auto vulkan = this->manager.lock();
+
+  auto& allocator = vulkan->GetDeviceLocalMemory();
+
+  if (!allocator.Fits(upload.size + upload.alignment))
+  {
+    auto logPtr = logger.lock();
+    if (logPtr)
+    {
+      logPtr->Log("Image does not fit into the staging memory");
+    }
+
+    Destroy();
+
+    return false;
+  }
+
+  auto staging = allocator.Allocate(upload.size, upload.alignment, MarkerPosition::Before);
+  if (!staging.data)
+  {
+    Destroy();
+
+    return false;
+  }
+
+  if (!WriteUpload(data, size, upload, static_cast<uint8_t*>(staging.data)))
+  {
+    allocator.Pop();
+    Destroy();
+
+    return false;
+  }
+
+  allocator.Flush(staging.offset, upload.size);
+
+  auto commandBuffer = vulkan->BeginSingleTimeCommands();
+  if (!commandBuffer)
+  {
+    allocator.Pop();
+    Destroy();
+
+    return false;
+  }
+
+  RecordUpload(commandBuffer, allocator.GetBuffer(), staging.offset, upload);
+
+  bool uploaded = vulkan->EndSingleTimeCommands(commandBuffer);
+
+  // EndSingleTimeCommands waits for the copy, so the staging memory can be reused right away
+  allocator.Pop();
+
+  if (!uploaded || !CreateView())
+  {
+    Destroy();
+
+    return false;
+  }
+
+  return true;
+}
+
+bool lpe::rendering::vulkan::VulkanImage::PrepareUpload(const std::shared_ptr<VulkanManager>& manager,
+                                                        const uint8_t* data,
+                                                        uint64_t size,
+                                                        int desiredChannels,
+                                                        ImageUpload& upload,
+                                                        uint32_t firstLevel)
+{
+  this->logger = lpe::ServiceLocator::LogManager.Get();
+
+  upload.regions.clear();
+  upload.desiredChannels = desiredChannels;
+  upload.generateMipmaps = false;
+  upload.sourceOffset = 0;
+
+  CookedTextureHeader header;
+  std::vector<CookedTextureLevel> levels;
+  upload.cooked = ReadCookedTextureHeader(data, size, header, levels);
+
+  if (upload.cooked)
+  {
+    switch (static_cast<BlockFormat>(header.Format))
+    {
+      case BlockFormat::BC1:
+        format = vk::Format::eBc1RgbUnormBlock;
+        break;
+      case BlockFormat::BC3:
+        format = vk::Format::eBc3UnormBlock;
+        break;
+      case BlockFormat::BC7:
+        format = vk::Format::eBc7UnormBlock;
+        break;
+      default:
+        format = vk::Format::eR8G8B8A8Unorm;
+        break;
+    }
+
+    auto features = manager->GetPhysicalDevice().getFormatProperties(format).optimalTilingFeatures;
+    if (!(features & vk::FormatFeatureFlagBits::eSampledImage))
+    {
+      auto logPtr = logger.lock();
+      if (logPtr)
+      {
+        logPtr->Log("Cooked texture format " + vk::to_string(format) + " is not supported by the device");
+      }
+
+      return false;
+    }
+
+    firstLevel = std::min(firstLevel, static_cast<uint32_t>(levels.size()) - 1);
+    levels.erase(std::begin(levels), std::begin(levels) + firstLevel);
+
+    extent.width = levels[0].Width;
+    extent.height = levels[0].Height;
+    extent.depth = 1;
+    tiling = vk::ImageTiling::eOptimal;
+    mipLevels = std::min(mipLevels, static_cast<uint32_t>(levels.size()));
+
+    // levels are stored smallest first, so the used ones form one continuous range
+    upload.sourceOffset = levels[mipLevels - 1].Offset;
+    upload.size = levels[0].Offset + levels[0].Size - upload.sourceOffset;
+    upload.alignment = CookedTextureAlignment;
+
+    for (uint32_t level = 0; level < mipLevels; ++level)
+    {
+      upload.regions.push_back({ levels[level].Offset - upload.sourceOffset,
+                                 0,
+                                 0,
+                                 { aspectFlags, level, 0, 1 },
+                                 { 0, 0, 0 },
+                                 { levels[level].Width, levels[level].Height, 1 } });
+    }
+
+    return true;
+  }
+
+  // only the header gets parsed here, decoding happens in WriteUpload
+  int width, height, channels;
+  if (!stbi_info_from_memory(data, static_cast<int>(size), &width, &height, &channels))
+  {
+    auto logPtr = logger.lock();
+    if (logPtr)
+    {
+      logPtr->Log("Could not read image header");
+    }
 
-  vk::DeviceSize imageSize = static_cast<vk::DeviceSize>(width * height * desiredChannels);
+    return false;
+  }
 
   extent.width = static_cast<uint32_t>(width);
   extent.height = static_cast<uint32_t>(height);
+  extent.depth = 1;
+
+  if (format == vk::Format::eUndefined)
+  {
+    switch (desiredChannels)
+    {
+      case STBI_grey:
+        format = vk::Format::eR8Unorm;
+        break;
+      case STBI_grey_alpha:
+        format = vk::Format::eR8G8Unorm;
+        break;
+      case STBI_rgb:
+        format = vk::Format::eR8G8B8Unorm;
+        break;
+      default:
+        format = vk::Format::eR8G8B8A8Unorm;
+        break;
+    }
+  }
 
-  this->Create(std::move(manager)); // TODO: still don't know if rvalue param is the best option. But nvm for now
+  uint32_t maxLevels = common::GetMipLevelCount(extent);
+  mipLevels = std::min(mipLevels, maxLevels); // VK_REMAINING_MIP_LEVELS means the full chain
 
-  auto vulkan = this->manager.lock();
+  auto formatProperties = manager->GetPhysicalDevice().getFormatProperties(format);
+  auto features = tiling == vk::ImageTiling::eOptimal ?
+                  formatProperties.optimalTilingFeatures :
+                  formatProperties.linearTilingFeatures;
+  auto blitFeatures = vk::FormatFeatureFlagBits::eBlitSrc |
+                      vk::FormatFeatureFlagBits::eBlitDst |
+                      vk::FormatFeatureFlagBits::eSampledImageFilterLinear;
+  upload.generateMipmaps = mipLevels > 1 && (features & blitFeatures) == blitFeatures;
+
+  if (upload.generateMipmaps)
+  {
+    usage |= vk::ImageUsageFlagBits::eTransferSrc;
+  }
+
+  auto pixelSize = static_cast<uint32_t>(desiredChannels);
+
+  // bufferOffset has to be a multiple of 4 and of the texel size
+  upload.alignment = pixelSize % 2 ? 4 * pixelSize : 4;
+
+  uint32_t levelCount = upload.generateMipmaps ? 1 : mipLevels;
+  vk::DeviceSize levelOffset = 0;
+  vk::Extent3D levelExtent = extent;
+
+  for (uint32_t level = 0; level < levelCount; ++level)
+  {
+    upload.regions.push_back({ levelOffset, 0, 0, { aspectFlags, level, 0, 1 }, { 0, 0, 0 }, levelExtent });
+
+    levelOffset += static_cast<vk::DeviceSize>(levelExtent.width) * levelExtent.height * pixelSize;
+    levelOffset = (levelOffset + upload.alignment - 1) / upload.alignment * upload.alignment;
+
+    levelExtent.width = std::max(levelExtent.width / 2, 1u);
+    levelExtent.height = std::max(levelExtent.height / 2, 1u);
+  }
+
+  upload.size = levelOffset;
+
+  return true;
+}
+
+bool lpe::rendering::vulkan::VulkanImage::WriteUpload(const uint8_t* data,
+                                                      uint64_t size,
+                                                      const ImageUpload& upload,
+                                                      void* staging) const
+{
+  auto out = static_cast<uint8_t*>(staging);
 
-  auto allocator = vulkan->GetDeviceLocalMemory();
+  if (upload.cooked)
+  {
+    memcpy(out, data + upload.sourceOffset, upload.size);
+
+    return true;
+  }
+
+  // decode with the channels of the file, stb would convert pixel by pixel
+  int width, height, channels;
+  auto stbImage = stbi_load_from_memory(data,
+                                        static_cast<int>(size),
+                                        &width,
+                                        &height,
+                                        &channels,
+                                        0);
 
-  assert(allocator.Fits(imageSize));
+  if (!stbImage)
+  {
+    return false;
+  }
 
-  auto offset = allocator.Push(stbImage, imageSize);
+  auto pixelSize = static_cast<uint32_t>(upload.desiredChannels);
+  const auto& base = upload.regions[0].imageExtent;
+  size_t pixelCount = static_cast<size_t>(base.width) * base.height;
+
+  // CPU mips read from cached scratch memory, staging memory is usually write combined
+  std::vector<uint8_t> converted;
+  std::vector<uint8_t> scratch[2];
+  const uint8_t* previous = stbImage;
+
+  if (static_cast<uint32_t>(channels) == pixelSize)
+  {
+    memcpy(out, stbImage, pixelCount * pixelSize);
+  }
+  else if (upload.regions.size() > 1)
+  {
+    converted.resize(pixelCount * pixelSize);
+    ConvertChannels(stbImage, static_cast<uint32_t>(channels), converted.data(), pixelSize, pixelCount);
+
+    memcpy(out, converted.data(), converted.size());
+    previous = converted.data();
+  }
+  else
+  {
+    ConvertChannels(stbImage, static_cast<uint32_t>(channels), out, pixelSize, pixelCount);
+  }
+
+  for (size_t level = 1; level < upload.regions.size(); ++level)
+  {
+    const auto& source = upload.regions[level - 1].imageExtent;
+    const auto& target = upload.regions[level].imageExtent;
+    auto& current = scratch[level % 2];
+
+    current.resize(static_cast<size_t>(target.width) * target.height * pixelSize);
+    common::DownsampleImage(previous, source.width, source.height, pixelSize, current.data());
+
+    memcpy(out + upload.regions[level].bufferOffset, current.data(), current.size());
+    previous = current.data();
+  }
 
   stbi_image_free(stbImage);
 
+  return true;
+}
+
+void lpe::rendering::vulkan::VulkanImage::RecordUpload(vk::CommandBuffer commandBuffer,
+                                                       vk::Buffer staging,
+                                                       vk::DeviceSize offset,
+                                                       const ImageUpload& upload) const
+{
+  vk::ImageMemoryBarrier barrier = {
+    {},
+    vk::AccessFlagBits::eTransferWrite,
+    vk::ImageLayout::eUndefined,
+    vk::ImageLayout::eTransferDstOptimal,
+    VK_QUEUE_FAMILY_IGNORED,
+    VK_QUEUE_FAMILY_IGNORED,
+    image,
+    {
+      aspectFlags,
+      0,
+      mipLevels,
+      0,
+      layers
+    }
+  };
+
+  commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTopOfPipe,
+                                vk::PipelineStageFlagBits::eTransfer,
+                                vk::DependencyFlags(),
+                                0,
+                                nullptr,
+                                0,
+                                nullptr,
+                                1,
+                                &barrier);
+
+  std::vector<vk::BufferImageCopy> regions = upload.regions;
+  for (auto&& region : regions)
+  {
+    region.bufferOffset += offset;
+  }
+
+  commandBuffer.copyBufferToImage(staging,
+                                  image,
+                                  vk::ImageLayout::eTransferDstOptimal,
+                                  static_cast<uint32_t>(regions.size()),
+                                  regions.data());
+
+  if (upload.generateMipmaps)
+  {
+    common::GenerateMipmaps(commandBuffer, image, extent, mipLevels, layers, aspectFlags);
+  }
+  else
+  {
+    barrier.setSrcAccessMask(vk::AccessFlagBits::eTransferWrite)
+           .setDstAccessMask(vk::AccessFlagBits::eShaderRead)
+           .setOldLayout(vk::ImageLayout::eTransferDstOptimal)
+           .setNewLayout(vk::ImageLayout::eShaderReadOnlyOptimal);
+
+    commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer,
+                                  vk::PipelineStageFlagBits::eFragmentShader,
+                                  vk::DependencyFlags(),
+                                  0,
+                                  nullptr,
+                                  0,
+                                  nullptr,
+                                  1,
+                                  &barrier);
+  }
+}
+
+bool lpe::rendering::vulkan::VulkanImage::CreateView()
+{
   if (!lpe::rendering::vulkan::common::CreateImageView(device,
                                                        image,
                                                        this->imageView,
@@ -191,7 +568,12 @@ bool lpe::rendering::vulkan::VulkanImage::Create(std::shared_ptr<VulkanManager>&
                                                        this->baseMipLevel,
                                                        this->mipLevels,
                                                        this->baseLayer,
-                                                       this->layers))
+                                                       this->layers,
+                                                       vk::ComponentSwizzle::eR,
+                                                       vk::ComponentSwizzle::eG,
+                                                       vk::ComponentSwizzle::eB,
+                                                       vk::ComponentSwizzle::eA,
+                                                       this->allocator))
   {
     auto logPtr = logger.lock();
     if (logPtr)
@@ -202,7 +584,6 @@ bool lpe::rendering::vulkan::VulkanImage::Create(std::shared_ptr<VulkanManager>&
     return false;
   }
 
-
   return true;
 }
 
@@ -226,11 +607,24 @@ lpe::rendering::vulkan::VulkanImage& lpe::rendering::vulkan::VulkanImage::SetDep
   return *this;
 }
 
-bool lpe::rendering::vulkan::VulkanImage::Create(std::shared_ptr<lpe::rendering::vulkan::VulkanManager>&& manager)
+bool lpe::rendering::vulkan::VulkanImage::CreateImage(const std::shared_ptr<VulkanManager>& manager)
 {
   this->logger = lpe::ServiceLocator::LogManager.Get();
   this->manager = manager;
   this->device = manager->GetDevice();
+  this->allocator = manager->GetAllocationCallbacks();
+  this->imageView = nullptr;
+
+  // VK_REMAINING_* are only valid for views
+  if (this->mipLevels == VK_REMAINING_MIP_LEVELS)
+  {
+    this->mipLevels = 1;
+  }
+
+  if (this->layers == VK_REMAINING_ARRAY_LAYERS)
+  {
+    this->layers = 1;
+  }
 
   vk::ImageCreateInfo imageCreateInfo =
     {
@@ -238,7 +632,7 @@ bool lpe::rendering::vulkan::VulkanImage::Create(std::shared_ptr<lpe::rendering:
       this->type,
       this->format,
       this->extent,
-      this->baseLayer,
+      this->mipLevels,
       this->layers,
       this->samples,
       this->tiling,
@@ -246,7 +640,7 @@ bool lpe::rendering::vulkan::VulkanImage::Create(std::shared_ptr<lpe::rendering:
       vk::SharingMode::eExclusive
     };
 
-  auto result = device.createImage(&imageCreateInfo, nullptr, &this->image);
+  auto result = device.createImage(&imageCreateInfo, allocator, &this->image);
 
   if(result != vk::Result::eSuccess)
   {
@@ -264,6 +658,213 @@ bool lpe::rendering::vulkan::VulkanImage::Create(std::shared_ptr<lpe::rendering:
   return true;
 }
 
+bool lpe::rendering::vulkan::VulkanImage::Create(std::shared_ptr<lpe::rendering::vulkan::VulkanManager>&& manager)
+{
+  if (!CreateImage(manager))
+  {
+    return false;
+  }
+
+  auto offset = manager->GetDeviceMemory().Bind(this->image,
+                                                vk::MemoryPropertyFlagBits::eDeviceLocal,
+                                                this->tiling == vk::ImageTiling::eLinear,
+                                                LPE_MEMORY_TAG("VulkanImage"));
+
+  if (offset == VK_WHOLE_SIZE)
+  {
+    auto ptr = logger.lock();
+    if (ptr)
+    {
+      ptr->Log("Could not allocate Image memory");
+    }
+
+    device.destroyImage(this->image, allocator);
+    this->image = nullptr;
+
+    return false;
+  }
+
+  this->memorySize = device.getImageMemoryRequirements(this->image).size;
+
+  return true;
+}
+
+bool lpe::rendering::vulkan::VulkanImage::Create(std::shared_ptr<VulkanManager>&& manager,
+                                                 vk::DeviceMemory memory,
+                                                 vk::DeviceSize offset)
+{
+  if (!CreateImage(manager))
+  {
+    return false;
+  }
+
+  device.bindImageMemory(this->image, memory, offset);
+  this->memorySize = device.getImageMemoryRequirements(this->image).size;
+
+  return true;
+}
+
+lpe::rendering::vulkan::VulkanImage& lpe::rendering::vulkan::VulkanImage::SetAttachment(const Attachment& attachment,
+                                                                                        uint32_t width,
+                                                                                        uint32_t height)
+{
+  bool transient = attachment.IsTransient();
+
+  this->format = attachment.Format;
+  this->samples = attachment.Samples;
+  this->extent = vk::Extent3D{ width, height, 1 };
+  this->mipLevels = 1;
+  this->baseMipLevel = 0;
+  this->layers = 1;
+  this->baseLayer = 0;
+  this->type = vk::ImageType::e2D;
+  this->viewType = vk::ImageViewType::e2D;
+  this->tiling = vk::ImageTiling::eOptimal;
+  this->aspectFlags = common::GetAspectFlags(this->format);
+
+  vk::ImageUsageFlags attachmentUsage = this->aspectFlags & vk::ImageAspectFlagBits::eColor ?
+                                        vk::ImageUsageFlagBits::eColorAttachment :
+                                        vk::ImageUsageFlagBits::eDepthStencilAttachment;
+
+  // transient images may only be used as attachments
+  this->usage = transient ?
+                attachmentUsage | vk::ImageUsageFlagBits::eTransientAttachment | (this->usage & vk::ImageUsageFlagBits::eInputAttachment) :
+                attachmentUsage | this->usage;
+
+  return *this;
+}
+
+bool lpe::rendering::vulkan::VulkanImage::CreateAttachment(std::shared_ptr<VulkanManager>&& manager,
+                                                           Attachment& attachment,
+                                                           uint32_t width,
+                                                           uint32_t height)
+{
+  bool transient = attachment.IsTransient();
+
+  SetAttachment(attachment, width, height);
+
+  if (!CreateImage(manager))
+  {
+    return false;
+  }
+
+  auto& memory = manager->GetDeviceMemory();
+  auto offset = transient ?
+                memory.BindTransient(this->image, LPE_MEMORY_TAG("transient attachment")) :
+                memory.Bind(this->image, vk::MemoryPropertyFlagBits::eDeviceLocal, false, LPE_MEMORY_TAG("attachment"));
+
+  if (offset == VK_WHOLE_SIZE)
+  {
+    auto ptr = logger.lock();
+    if (ptr)
+    {
+      ptr->Log("Could not allocate attachment memory");
+    }
+
+    device.destroyImage(this->image, allocator);
+    this->image = nullptr;
+
+    return false;
+  }
+
+  this->memorySize = device.getImageMemoryRequirements(this->image).size;
+
+  if (!CreateView())
+  {
+    Destroy();
+
+    return false;
+  }
+
+  attachment.ImageView = this->imageView;
+
+  return true;
+}
+
+void lpe::rendering::vulkan::VulkanImage::RecordCopy(vk::CommandBuffer commandBuffer,
+                                                     const VulkanImage& source) const
+{
+  vk::ImageSubresourceRange range = {
+    aspectFlags,
+    0,
+    mipLevels,
+    0,
+    layers
+  };
+
+  std::array<vk::ImageMemoryBarrier, 2> barriers = {
+    vk::ImageMemoryBarrier{
+      vk::AccessFlagBits::eShaderRead,
+      vk::AccessFlagBits::eTransferRead,
+      vk::ImageLayout::eShaderReadOnlyOptimal,
+      vk::ImageLayout::eTransferSrcOptimal,
+      VK_QUEUE_FAMILY_IGNORED,
+      VK_QUEUE_FAMILY_IGNORED,
+      source.image,
+      range
+    },
+    vk::ImageMemoryBarrier{
+      {},
+      vk::AccessFlagBits::eTransferWrite,
+      vk::ImageLayout::eUndefined,
+      vk::ImageLayout::eTransferDstOptimal,
+      VK_QUEUE_FAMILY_IGNORED,
+      VK_QUEUE_FAMILY_IGNORED,
+      image,
+      range
+    }
+  };
+
+  commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eFragmentShader | vk::PipelineStageFlagBits::eTopOfPipe,
+                                vk::PipelineStageFlagBits::eTransfer,
+                                vk::DependencyFlags(),
+                                0,
+                                nullptr,
+                                0,
+                                nullptr,
+                                static_cast<uint32_t>(barriers.size()),
+                                barriers.data());
+
+  std::vector<vk::ImageCopy> regions;
+  for (uint32_t level = 0; level < mipLevels; ++level)
+  {
+    vk::ImageSubresourceLayers subresource = { aspectFlags, level, 0, layers };
+    vk::Extent3D levelExtent = {
+      std::max(extent.width >> level, 1u),
+      std::max(extent.height >> level, 1u),
+      std::max(extent.depth >> level, 1u)
+    };
+
+    regions.push_back({ subresource, { 0, 0, 0 }, subresource, { 0, 0, 0 }, levelExtent });
+  }
+
+  commandBuffer.copyImage(source.image,
+                          vk::ImageLayout::eTransferSrcOptimal,
+                          image,
+                          vk::ImageLayout::eTransferDstOptimal,
+                          static_cast<uint32_t>(regions.size()),
+                          regions.data());
+
+  barriers[0].setSrcAccessMask(vk::AccessFlagBits::eTransferRead)
+             .setDstAccessMask(vk::AccessFlagBits::eShaderRead)
+             .setOldLayout(vk::ImageLayout::eTransferSrcOptimal)
+             .setNewLayout(vk::ImageLayout::eShaderReadOnlyOptimal);
+  barriers[1].setSrcAccessMask(vk::AccessFlagBits::eTransferWrite)
+             .setDstAccessMask(vk::AccessFlagBits::eShaderRead)
+             .setOldLayout(vk::ImageLayout::eTransferDstOptimal)
+             .setNewLayout(vk::ImageLayout::eShaderReadOnlyOptimal);
+
+  commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer,
+                                vk::PipelineStageFlagBits::eFragmentShader,
+                                vk::DependencyFlags(),
+                                0,
+                                nullptr,
+                                0,
+                                nullptr,
+                                static_cast<uint32_t>(barriers.size()),
+                                barriers.data());
+}
+
 bool lpe::rendering::vulkan::common::CreateImageView(vk::Device device,
                                                      vk::Image image,
                                                      vk::ImageView& view,
@@ -277,7 +878,8 @@ bool lpe::rendering::vulkan::common::CreateImageView(vk::Device device,
                                                      vk::ComponentSwizzle r,
                                                      vk::ComponentSwizzle g,
                                                      vk::ComponentSwizzle b,
-                                                     vk::ComponentSwizzle a)
+                                                     vk::ComponentSwizzle a,
+                                                     const vk::AllocationCallbacks* allocator)
 {
   vk::ImageViewCreateInfo createInfo = {
     {},
@@ -299,7 +901,220 @@ bool lpe::rendering::vulkan::common::CreateImageView(vk::Device device,
     }
   };
 
-  auto result = device.createImageView(&createInfo, nullptr, &view);
+  auto result = device.createImageView(&createInfo, allocator, &view);
 
   return result == vk::Result::eSuccess;
 }
+
+vk::Image lpe::rendering::vulkan::VulkanImage::GetImage() const
+{
+  return image;
+}
+
+vk::ImageView lpe::rendering::vulkan::VulkanImage::GetImageView() const
+{
+  return imageView;
+}
+
+uint32_t lpe::rendering::vulkan::VulkanImage::GetMipLevels() const
+{
+  return mipLevels;
+}
+
+vk::DeviceSize lpe::rendering::vulkan::VulkanImage::GetMemorySize() const
+{
+  return memorySize;
+}
+
+vk::ImageAspectFlags lpe::rendering::vulkan::common::GetAspectFlags(vk::Format format)
+{
+  switch (format)
+  {
+    case vk::Format::eD16Unorm:
+    case vk::Format::eX8D24UnormPack32:
+    case vk::Format::eD32Sfloat:
+      return vk::ImageAspectFlagBits::eDepth;
+    case vk::Format::eS8Uint:
+      return vk::ImageAspectFlagBits::eStencil;
+    case vk::Format::eD16UnormS8Uint:
+    case vk::Format::eD24UnormS8Uint:
+    case vk::Format::eD32SfloatS8Uint:
+      return vk::ImageAspectFlagBits::eDepth | vk::ImageAspectFlagBits::eStencil;
+    default:
+      return vk::ImageAspectFlagBits::eColor;
+  }
+}
+
+uint32_t lpe::rendering::vulkan::common::GetMipLevelCount(vk::Extent3D extent)
+{
+  uint32_t size = std::max(extent.width, std::max(extent.height, extent.depth));
+  uint32_t levels = 1;
+
+  while (size > 1)
+  {
+    size /= 2;
+    ++levels;
+  }
+
+  return levels;
+}
+
+void lpe::rendering::vulkan::common::GenerateMipmaps(vk::CommandBuffer commandBuffer,
+                                                     vk::Image image,
+                                                     vk::Extent3D extent,
+                                                     uint32_t mipLevels,
+                                                     uint32_t layers,
+                                                     vk::ImageAspectFlags aspectFlags)
+{
+  vk::ImageMemoryBarrier barrier = {
+    vk::AccessFlagBits::eTransferWrite,
+    vk::AccessFlagBits::eTransferRead,
+    vk::ImageLayout::eTransferDstOptimal,
+    vk::ImageLayout::eTransferSrcOptimal,
+    VK_QUEUE_FAMILY_IGNORED,
+    VK_QUEUE_FAMILY_IGNORED,
+    image,
+    {
+      aspectFlags,
+      0,
+      1,
+      0,
+      layers
+    }
+  };
+
+  auto width = static_cast<int32_t>(extent.width);
+  auto height = static_cast<int32_t>(extent.height);
+  auto depth = static_cast<int32_t>(extent.depth);
+
+  for (uint32_t level = 1; level < mipLevels; ++level)
+  {
+    // previous level: written by the copy or the last blit, read by this blit
+    barrier.subresourceRange.baseMipLevel = level - 1;
+    barrier.setSrcAccessMask(vk::AccessFlagBits::eTransferWrite)
+           .setDstAccessMask(vk::AccessFlagBits::eTransferRead)
+           .setOldLayout(vk::ImageLayout::eTransferDstOptimal)
+           .setNewLayout(vk::ImageLayout::eTransferSrcOptimal);
+
+    commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer,
+                                  vk::PipelineStageFlagBits::eTransfer,
+                                  vk::DependencyFlags(),
+                                  0,
+                                  nullptr,
+                                  0,
+                                  nullptr,
+                                  1,
+                                  &barrier);
+
+    int32_t nextWidth = std::max(width / 2, 1);
+    int32_t nextHeight = std::max(height / 2, 1);
+    int32_t nextDepth = std::max(depth / 2, 1);
+
+    vk::ImageBlit blit = {};
+    blit.srcSubresource = { aspectFlags, level - 1, 0, layers };
+    blit.srcOffsets[0] = vk::Offset3D{ 0, 0, 0 };
+    blit.srcOffsets[1] = vk::Offset3D{ width, height, depth };
+    blit.dstSubresource = { aspectFlags, level, 0, layers };
+    blit.dstOffsets[0] = vk::Offset3D{ 0, 0, 0 };
+    blit.dstOffsets[1] = vk::Offset3D{ nextWidth, nextHeight, nextDepth };
+
+    commandBuffer.blitImage(image,
+                            vk::ImageLayout::eTransferSrcOptimal,
+                            image,
+                            vk::ImageLayout::eTransferDstOptimal,
+                            1,
+                            &blit,
+                            vk::Filter::eLinear);
+
+    // previous level is done
+    barrier.setSrcAccessMask(vk::AccessFlagBits::eTransferRead)
+           .setDstAccessMask(vk::AccessFlagBits::eShaderRead)
+           .setOldLayout(vk::ImageLayout::eTransferSrcOptimal)
+           .setNewLayout(vk::ImageLayout::eShaderReadOnlyOptimal);
+
+    commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer,
+                                  vk::PipelineStageFlagBits::eFragmentShader,
+                                  vk::DependencyFlags(),
+                                  0,
+                                  nullptr,
+                                  0,
+                                  nullptr,
+                                  1,
+                                  &barrier);
+
+    width = nextWidth;
+    height = nextHeight;
+    depth = nextDepth;
+  }
+
+  // last level was never used as blit source
+  barrier.subresourceRange.baseMipLevel = mipLevels - 1;
+  barrier.setSrcAccessMask(vk::AccessFlagBits::eTransferWrite)
+         .setDstAccessMask(vk::AccessFlagBits::eShaderRead)
+         .setOldLayout(vk::ImageLayout::eTransferDstOptimal)
+         .setNewLayout(vk::ImageLayout::eShaderReadOnlyOptimal);
+
+  commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer,
+                                vk::PipelineStageFlagBits::eFragmentShader,
+                                vk::DependencyFlags(),
+                                0,
+                                nullptr,
+                                0,
+                                nullptr,
+                                1,
+                                &barrier);
+}
+
+void lpe::rendering::vulkan::common::DownsampleImage(const uint8_t* src,
+                                                     uint32_t width,
+                                                     uint32_t height,
+                                                     uint32_t channels,
+                                                     uint8_t* dst)
+{
+  uint32_t dstWidth = std::max(width / 2, 1u);
+  uint32_t dstHeight = std::max(height / 2, 1u);
+  size_t pitch = static_cast<size_t>(width) * channels;
+
+  for (uint32_t y = 0; y < dstHeight; ++y)
+  {
+    const uint8_t* row0 = src + std::min(2 * y, height - 1) * pitch;
+    const uint8_t* row1 = src + std::min(2 * y + 1, height - 1) * pitch;
+    uint8_t* out = dst + static_cast<size_t>(y) * dstWidth * channels;
+    uint32_t x = 0;
+
+#ifdef LPE_SSE2
+    if (channels == 4)
+    {
+      // 4 source pixels of both rows -> 2 destination pixels, (a + b + c + d + 2) / 4 in 16 bit
+      const __m128i zero = _mm_setzero_si128();
+      const __m128i round = _mm_set1_epi16(2);
+
+      for (; 2 * x + 3 < width && x + 1 < dstWidth; x += 2)
+      {
+        __m128i top = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + 8 * x));
+        __m128i bottom = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + 8 * x));
+
+        __m128i low = _mm_add_epi16(_mm_unpacklo_epi8(top, zero), _mm_unpacklo_epi8(bottom, zero));
+        __m128i high = _mm_add_epi16(_mm_unpackhi_epi8(top, zero), _mm_unpackhi_epi8(bottom, zero));
+        __m128i sum = _mm_add_epi16(_mm_unpacklo_epi64(low, high), _mm_unpackhi_epi64(low, high));
+
+        sum = _mm_srli_epi16(_mm_add_epi16(sum, round), 2);
+
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(out + 4 * x), _mm_packus_epi16(sum, zero));
+      }
+    }
+#endif
+
+    for (; x < dstWidth; ++x)
+    {
+      size_t left = static_cast<size_t>(std::min(2 * x, width - 1)) * channels;
+      size_t right = static_cast<size_t>(std::min(2 * x + 1, width - 1)) * channels;
+
+      for (uint32_t c = 0; c < channels; ++c)
+      {
+        uint32_t sum = row0[left + c] + row0[right + c] + row1[left + c] + row1[right + c];
+        out[x * channels + c] = static_cast<uint8_t>((sum + 2) / 4);
+      }
+    }
+  }
+}
@@ -4,8 +4,10 @@
 // #define STB_IMAGE_IMPLEMENTATION in lpe.hpp
 #include <stb_image.h>
 #include <vulkan/vulkan.hpp>
+#include "../CookedTexture.h"
 #include "../LogManager.h"
 #include "../Resource.h"
+#include "../VkAttachment.h"
 
 namespace lpe
 {
@@ -28,11 +30,73 @@ bool CreateImageView(vk::Device device,
                      vk::ComponentSwizzle r = vk::ComponentSwizzle::eR,
                      vk::ComponentSwizzle g = vk::ComponentSwizzle::eG,
                      vk::ComponentSwizzle b = vk::ComponentSwizzle::eB,
-                     vk::ComponentSwizzle a = vk::ComponentSwizzle::eA);
+                     vk::ComponentSwizzle a = vk::ComponentSwizzle::eA,
+                     const vk::AllocationCallbacks* allocator = nullptr);
+
+/*!
+ * Number of levels of a full mip chain down to 1x1(x1)
+ */
+uint32_t GetMipLevelCount(vk::Extent3D extent);
+
+/*!
+ * eDepth and / or eStencil for depth stencil formats, eColor for everything else
+ */
+vk::ImageAspectFlags GetAspectFlags(vk::Format format);
+
+/*!
+ * Records a vkCmdBlitImage cascade which fills level 1 to mipLevels - 1 from level 0.
+ * All levels have to be in eTransferDstOptimal, afterwards all of them are in eShaderReadOnlyOptimal.
+ * The format needs eBlitSrc, eBlitDst and eSampledImageFilterLinear support.
+ *
+ * @param commandBuffer
+ * @param image
+ * @param extent extent of level 0
+ * @param mipLevels
+ * @param layers
+ * @param aspectFlags
+ */
+void GenerateMipmaps(vk::CommandBuffer commandBuffer,
+                     vk::Image image,
+                     vk::Extent3D extent,
+                     uint32_t mipLevels,
+                     uint32_t layers = 1,
+                     vk::ImageAspectFlags aspectFlags = vk::ImageAspectFlagBits::eColor);
+
+/*!
+ * CPU fallback for formats which can't be blitted.
+ * 2x2 box filter of an 8 bit per channel image, odd edges get clamped.
+ * dst needs space for max(width / 2, 1) * max(height / 2, 1) * channels bytes
+ *
+ * @param src
+ * @param width
+ * @param height
+ * @param channels
+ * @param dst
+ */
+void DownsampleImage(const uint8_t* src,
+                     uint32_t width,
+                     uint32_t height,
+                     uint32_t channels,
+                     uint8_t* dst);
 }
 
 class VulkanManager;
 
+/*!
+ * Everything needed to fill an image from a staging buffer.
+ * Region offsets are relative to the start of the staging range.
+ */
+struct ImageUpload
+{
+  std::vector<vk::BufferImageCopy> regions;
+  vk::DeviceSize size;
+  vk::DeviceSize alignment;
+  uint64_t sourceOffset;
+  int desiredChannels;
+  bool cooked;
+  bool generateMipmaps;
+};
+
 class VulkanImage
 {
 private:
@@ -40,8 +104,10 @@ private:
   std::weak_ptr<lpe::utils::log::ILogManager> logger;
 
   vk::Device device;  // hold actual VkDevice handle in case manager ptr gets lost
+  const vk::AllocationCallbacks* allocator;  // same for the callbacks, destroy needs the ones of create
   vk::Image image;
   vk::ImageView imageView;
+  vk::DeviceSize memorySize;  // 0 = no memory bound by this image (swapchain)
   vk::Format format;
   uint32_t mipLevels;
   uint32_t baseMipLevel;
@@ -54,6 +120,7 @@ private:
   vk::ImageViewType viewType;
   vk::ImageAspectFlags aspectFlags;
   vk::Extent3D extent;
+
 public:
   VulkanImage();
 
@@ -73,7 +140,23 @@ public:
               vk::Image image);
 
   /*!
-   * Creates a 2D vk::Image and vk::ImageView from a resource
+   * Creates the vk::Image bound to memory at offset instead of memory of the GeneralPurposeAllocator.
+   * Used to move images for defragmentation (see DefragmentationMove), the view gets created by CreateView.
+   *
+   * @param manager
+   * @param memory
+   * @param offset
+   * @return
+   */
+  bool Create(std::shared_ptr<VulkanManager>&& manager,
+              vk::DeviceMemory memory,
+              vk::DeviceSize offset);
+
+  /*!
+   * Creates a 2D vk::Image and vk::ImageView from a resource.
+   * Cooked textures (see CookTexture) get uploaded as they are, including their mip levels.
+   * Everything else is decoded by stb. Without explicit mip levels the full chain gets generated then,
+   * on the GPU if the format is blittable and on the CPU otherwise.
    *
    * @param manager
    * @param resource
@@ -84,12 +167,111 @@ public:
               std::weak_ptr<lpe::utils::Resource> resource,
               int desiredChannels = STBI_rgb_alpha);
 
+  /*!
+   * Creates a render target of width x height with format and samples of the attachment and sets
+   * attachment.ImageView. Attachments which are never loaded or stored (Attachment::IsTransient) become
+   * eTransientAttachment images in lazily allocated or transient pool memory (GeneralPurposeAllocator::BindTransient),
+   * only eInputAttachment of the usage is kept for them. Other attachments keep the usage, e.g. eSampled.
+   *
+   * @param manager
+   * @param attachment
+   * @param width
+   * @param height
+   * @return
+   */
+  bool CreateAttachment(std::shared_ptr<VulkanManager>&& manager,
+                        Attachment& attachment,
+                        uint32_t width,
+                        uint32_t height);
+
   void Destroy();
 
+  /*!
+   * Reads the image header (stb or cooked texture) and configures extent, format and mip levels.
+   * Nothing gets decoded, call Create(manager) afterwards to create the vk::Image.
+   *
+   * @param manager
+   * @param data
+   * @param size
+   * @param desiredChannels
+   * @param upload receives staging size, alignment and copy regions
+   * @param firstLevel cooked textures skip their larger levels, the image starts at this level of the file
+   * @return
+   */
+  bool PrepareUpload(const std::shared_ptr<VulkanManager>& manager,
+                     const uint8_t* data,
+                     uint64_t size,
+                     int desiredChannels,
+                     ImageUpload& upload,
+                     uint32_t firstLevel = 0);
+
+  /*!
+   * Decodes the image (and CPU mips if needed) into upload.size bytes of staging memory.
+   * Doesn't touch any Vulkan object, so it can run on worker threads.
+   *
+   * @param data
+   * @param size
+   * @param upload
+   * @param staging mapped staging memory
+   * @return
+   */
+  bool WriteUpload(const uint8_t* data,
+                   uint64_t size,
+                   const ImageUpload& upload,
+                   void* staging) const;
+
+  /*!
+   * Records layout transitions, the buffer to image copy and the mip generation.
+   * Afterwards the image is in eShaderReadOnlyOptimal.
+   *
+   * @param commandBuffer
+   * @param staging
+   * @param offset start of the staging range within staging
+   * @param upload
+   */
+  void RecordUpload(vk::CommandBuffer commandBuffer,
+                    vk::Buffer staging,
+                    vk::DeviceSize offset,
+                    const ImageUpload& upload) const;
+
+  /*!
+   * Records the copy of all levels and layers of source (same size and format) into this image.
+   * Both images have to be in eShaderReadOnlyOptimal before and are again afterwards.
+   *
+   * @param commandBuffer
+   * @param source
+   */
+  void RecordCopy(vk::CommandBuffer commandBuffer,
+                  const VulkanImage& source) const;
+
+  /*!
+   * Creates the vk::Image without memory, the caller binds it (e.g. to memory shared by aliased images)
+   * and calls CreateView afterwards. GetMemorySize stays 0, the memory isn't owned by the image.
+   *
+   * @param manager
+   * @return
+   */
+  bool CreateImage(const std::shared_ptr<VulkanManager>& manager);
+
+  bool CreateView();
+
 
 
   VulkanImage& SetFormat(vk::Format format);
 
+  /*!
+   * Configures a single level 2D render target for the attachment (format, samples, aspect and usage,
+   * see CreateAttachment), the usage set before gets extended
+   *
+   * @param attachment
+   * @param width
+   * @param height
+   * @return
+   */
+  VulkanImage& SetAttachment(const Attachment& attachment,
+                             uint32_t width,
+                             uint32_t height);
+
   VulkanImage& SetLevel(uint32_t level);
 
   VulkanImage& SetLayers(uint32_t layers);
@@ -117,6 +299,17 @@ public:
   VulkanImage& SetHeight(uint32_t height);
 
   VulkanImage& SetDepth(uint32_t depth);
+
+  vk::Image GetImage() const;
+
+  vk::ImageView GetImageView() const;
+
+  uint32_t GetMipLevels() const;
+
+  /*!
+   * Size of the device memory owned by the image, 0 for swapchain images
+   */
+  vk::DeviceSize GetMemorySize() const;
 };
 
 }
@@ -19,7 +19,7 @@ void lpe::rendering::vulkan::VulkanManager::Initialize()
 
   assert(base.instance);
 
-  if (glfwCreateWindowSurface(base.instance, window, nullptr, &base.surface) != VK_SUCCESS)
+  if (glfwCreateWindowSurface(base.instance, window, reinterpret_cast<const VkAllocationCallbacks*>(hostAllocator.Get()), &base.surface) != VK_SUCCESS)
   {
     logger->Log("Could not create Surface.");
 
@@ -36,6 +36,18 @@ void lpe::rendering::vulkan::VulkanManager::Initialize()
   assert(device.graphicsQueue);
   assert(device.presentQueue);
 
+  if (!CreateCommandPool())
+  {
+    logger->Log("Could not create CommandPool.");
+
+    return;
+  }
+
+  deviceMemory.Create(device.device, base.physicalDevice, defaultChunkSize, AllocationPolicy::Tlsf, memoryBudgetSupported, hostAllocator.Get());
+
+  // staging memory needs the device
+  localAllocator.Create(lpe::utils::SimplePointer<VulkanManager>(this), 128 * 1024 * 1024); // StackAllocator with 128 MiB
+
   assert(CreateSwapchain(vk::PresentModeKHR::eFifo,
                          vk::Format::eR8G8B8A8Unorm,
                          vk::ColorSpaceKHR::eSrgbNonlinear));
@@ -97,7 +109,7 @@ bool lpe::rendering::vulkan::VulkanManager::CreateInstance()
     instanceExtensions.data()
   };
 
-  if (vk::createInstance(&instanceCreateInfo, nullptr, &base.instance) != vk::Result::eSuccess)
+  if (vk::createInstance(&instanceCreateInfo, hostAllocator.Get(), &base.instance) != vk::Result::eSuccess)
   {
     logger->Log("Could not create Instance. Is Vulkan even supported on your Device?");
 
@@ -118,9 +130,6 @@ bool lpe::rendering::vulkan::VulkanManager::CreateInstance()
 //                                        &debugReportCallback,
 //                                        "vkCreateDebugReportCallbackEXT");
 
-
-  localAllocator.Create(lpe::utils::SimplePointer<VulkanManager>(this), 128 * 1024 * 1024); // StackAllocator with 128 MiB
-
   return true;
 }
 
@@ -177,10 +186,21 @@ void lpe::rendering::vulkan::VulkanManager::Close()
                   image.Destroy();
                 });
 
-  device.device.destroySwapchainKHR(swapchain.swapchain);
-  device.device.destroy();
-  vkDestroySurfaceKHR(base.instance, base.surface, nullptr);
-  base.instance.destroy();
+  localAllocator.Destroy();
+  deviceMemory.Destroy();
+
+  if (commandPool)
+  {
+    device.device.destroyCommandPool(commandPool, hostAllocator.Get());
+    commandPool = nullptr;
+  }
+
+  device.device.destroySwapchainKHR(swapchain.swapchain, hostAllocator.Get());
+  device.device.destroy(hostAllocator.Get());
+  vkDestroySurfaceKHR(base.instance, base.surface, reinterpret_cast<const VkAllocationCallbacks*>(hostAllocator.Get()));
+  base.instance.destroy(hostAllocator.Get());
+
+  hostAllocator.LogLeaks(logger);
 
   swapchain = nullptr;
   device = nullptr;
@@ -304,18 +324,40 @@ bool lpe::rendering::vulkan::VulkanManager::CreateDeviceAndGetQueues()
   vk::PhysicalDeviceFeatures requiredFeatures = {};
   requiredFeatures.samplerAnisotropy = VK_TRUE;
 
+  // optional extensions, the memory subsystem falls back to its own bookkeeping without them
+  std::vector<const char *> extensions = deviceExtensions;
+  auto availableExtensions = base.physicalDevice.enumerateDeviceExtensionProperties();
+
+  memoryBudgetSupported = std::any_of(std::begin(availableExtensions),
+                                      std::end(availableExtensions),
+                                      [](const vk::ExtensionProperties& extension)
+                                      {
+                                        return strcmp(extension.extensionName, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME) == 0;
+                                      });
+
+  if (memoryBudgetSupported &&
+      std::none_of(std::begin(extensions),
+                   std::end(extensions),
+                   [](const char* extensionName)
+                   {
+                     return strcmp(extensionName, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME) == 0;
+                   }))
+  {
+    extensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+  }
+
   vk::DeviceCreateInfo createInfo = {
     {},
     static_cast<uint32_t >(queueCreateInfos.size()),
     queueCreateInfos.data(),
     0,
     nullptr,
-    static_cast<uint32_t>(deviceExtensions.size()),
-    deviceExtensions.data(),
+    static_cast<uint32_t>(extensions.size()),
+    extensions.data(),
     &requiredFeatures
   };
 
-  if (base.physicalDevice.createDevice(&createInfo, nullptr, &device.device) != vk::Result::eSuccess)
+  if (base.physicalDevice.createDevice(&createInfo, hostAllocator.Get(), &device.device) != vk::Result::eSuccess)
   {
     logger->Log("Could not create Device. Is Vulkan fully supported on your Device? (also check validation layers!)");
 
@@ -348,6 +390,16 @@ bool lpe::rendering::vulkan::VulkanManager::CreateDeviceAndGetQueues()
   return true;
 }
 
+bool lpe::rendering::vulkan::VulkanManager::CreateCommandPool()
+{
+  vk::CommandPoolCreateInfo createInfo = {
+    vk::CommandPoolCreateFlagBits::eTransient | vk::CommandPoolCreateFlagBits::eResetCommandBuffer,
+    device.graphicsQueue.queueFamilyIndex
+  };
+
+  return device.device.createCommandPool(&createInfo, hostAllocator.Get(), &commandPool) == vk::Result::eSuccess;
+}
+
 bool lpe::rendering::vulkan::VulkanManager::CreateSwapchain(vk::PresentModeKHR preferredMode,
                                                             vk::Format preferredFormat,
                                                             vk::ColorSpaceKHR preferredColorSpace)
@@ -460,7 +512,7 @@ bool lpe::rendering::vulkan::VulkanManager::CreateSwapchain(vk::PresentModeKHR p
               .setPQueueFamilyIndices(queueFamilies.data());
   }
 
-  auto result = device.device.createSwapchainKHR(&createInfo, nullptr, &swapchain.swapchain);
+  auto result = device.device.createSwapchainKHR(&createInfo, hostAllocator.Get(), &swapchain.swapchain);
   if(result != vk::Result::eSuccess)
   {
     logger->Log("Could not create swapchain.");
@@ -472,7 +524,7 @@ bool lpe::rendering::vulkan::VulkanManager::CreateSwapchain(vk::PresentModeKHR p
 
   if(old)
   {
-    device.device.destroySwapchainKHR(old, nullptr);
+    device.device.destroySwapchainKHR(old, hostAllocator.Get());
   }
 
   return true;
@@ -507,6 +559,13 @@ lpe::rendering::vulkan::VulkanManager& lpe::rendering::vulkan::VulkanManager::Se
   return *this;
 }
 
+lpe::rendering::vulkan::VulkanManager& lpe::rendering::vulkan::VulkanManager::SetDefaultMemoryChunkSize(vk::DeviceSize defaultSize)
+{
+  this->defaultChunkSize = defaultSize;
+  deviceMemory.SetChunkSize(defaultSize);
+  return *this;
+}
+
 lpe::rendering::vulkan::VulkanManager& lpe::rendering::vulkan::VulkanManager::AddInstanceLayer(const char *layerName)
 {
   this->layers.emplace_back(layerName);
@@ -555,6 +614,98 @@ lpe::rendering::vulkan::StackAllocator& lpe::rendering::vulkan::VulkanManager::G
   return this->localAllocator;
 }
 
+lpe::rendering::vulkan::GeneralPurposeAllocator& lpe::rendering::vulkan::VulkanManager::GetDeviceMemory()
+{
+  return this->deviceMemory;
+}
+
+const vk::AllocationCallbacks* lpe::rendering::vulkan::VulkanManager::GetAllocationCallbacks() const
+{
+  return hostAllocator.Get();
+}
+
+lpe::rendering::vulkan::HostAllocationCallbacks& lpe::rendering::vulkan::VulkanManager::GetHostMemory()
+{
+  return this->hostAllocator;
+}
+
+const lpe::rendering::vulkan::VulkanQueue& lpe::rendering::vulkan::VulkanManager::GetGraphicsQueue() const
+{
+  return device.graphicsQueue;
+}
+
+vk::CommandBuffer lpe::rendering::vulkan::VulkanManager::BeginSingleTimeCommands()
+{
+  vk::CommandBuffer commandBuffer = nullptr;
+  vk::CommandBufferAllocateInfo allocateInfo = {
+    commandPool,
+    vk::CommandBufferLevel::ePrimary,
+    1
+  };
+
+  if (device.device.allocateCommandBuffers(&allocateInfo, &commandBuffer) != vk::Result::eSuccess)
+  {
+    logger->Log("Could not allocate CommandBuffer");
+
+    return nullptr;
+  }
+
+  vk::CommandBufferBeginInfo beginInfo = {
+    vk::CommandBufferUsageFlagBits::eOneTimeSubmit
+  };
+
+  if (commandBuffer.begin(&beginInfo) != vk::Result::eSuccess)
+  {
+    logger->Log("Could not begin CommandBuffer");
+
+    device.device.freeCommandBuffers(commandPool, 1, &commandBuffer);
+
+    return nullptr;
+  }
+
+  return commandBuffer;
+}
+
+bool lpe::rendering::vulkan::VulkanManager::EndSingleTimeCommands(vk::CommandBuffer commandBuffer)
+{
+  commandBuffer.end();
+
+  vk::Fence fence = nullptr;
+  vk::FenceCreateInfo fenceCreateInfo = {};
+  vk::Result result = device.device.createFence(&fenceCreateInfo, hostAllocator.Get(), &fence);
+
+  if (result == vk::Result::eSuccess)
+  {
+    vk::SubmitInfo submitInfo = {
+      0,
+      nullptr,
+      nullptr,
+      1,
+      &commandBuffer
+    };
+
+    result = device.graphicsQueue.queue.submit(1, &submitInfo, fence);
+
+    if (result == vk::Result::eSuccess)
+    {
+      result = device.device.waitForFences(1, &fence, VK_TRUE, std::numeric_limits<uint64_t>::max());
+    }
+
+    device.device.destroyFence(fence, hostAllocator.Get());
+  }
+
+  device.device.freeCommandBuffers(commandPool, 1, &commandBuffer);
+
+  if (result != vk::Result::eSuccess)
+  {
+    logger->Log("Could not submit single time commands");
+
+    return false;
+  }
+
+  return true;
+}
+
 lpe::rendering::vulkan::VulkanManager::QueueIndices::operator bool() const
 {
   // compute queue is not explicitly required by now
@@ -5,6 +5,7 @@
 #include "../LogManager.h"
 #include "VulkanBase.hpp"
 #include "MemoryManagement.hpp"
+#include "HostAllocationCallbacks.hpp"
 
 #define LPE_API_VERSION VK_MAKE_VERSION(0, 1, 0)
 
@@ -18,11 +19,17 @@ namespace vulkan
 class VulkanManager : public lpe::rendering::IRenderManager
 {
 private:
+  HostAllocationCallbacks hostAllocator;  // first member, outlives every object created with it
+
   VulkanBase base;
   VulkanDevice device;
   VulkanSwapchain swapchain;
 
   StackAllocator localAllocator;
+  GeneralPurposeAllocator deviceMemory;
+  vk::DeviceSize defaultChunkSize = 64 * 1024 * 1024;
+
+  vk::CommandPool commandPool;
 
   VkDebugReportCallbackEXT debugReportCallback;
 
@@ -32,6 +39,7 @@ private:
 
   std::vector<const char *> instanceExtensions;
   std::vector<const char *> deviceExtensions;
+  bool memoryBudgetSupported = false;
   std::vector<const char *> layers;
 
   std::shared_ptr<lpe::utils::log::ILogManager> logger;
@@ -64,6 +72,8 @@ private:
   bool PickPhysicalDevice();
   bool CreateDeviceAndGetQueues();
 
+  bool CreateCommandPool();
+
   bool CreateSwapchain(vk::PresentModeKHR preferredMode,
                        vk::Format preferredFormat,
                        vk::ColorSpaceKHR preferredColorSpace);
@@ -90,6 +100,38 @@ public:
   vk::PhysicalDevice GetPhysicalDevice() const;
   vk::SwapchainKHR GetSwapchain() const;
   StackAllocator& GetDeviceLocalMemory();
+
+  /*!
+   * Pools for images and buffers which live longer than a frame
+   */
+  GeneralPurposeAllocator& GetDeviceMemory();
+
+  /*!
+   * Callbacks for the CPU memory of the driver, pass them to every create and the matching destroy call
+   */
+  const vk::AllocationCallbacks* GetAllocationCallbacks() const;
+
+  /*!
+   * Statistics of the driver's CPU memory per vk::SystemAllocationScope
+   */
+  HostAllocationCallbacks& GetHostMemory();
+  const VulkanQueue& GetGraphicsQueue() const;
+
+  /*!
+   * Allocates and begins a primary command buffer for one time work like uploads
+   *
+   * @return nullptr on failure
+   */
+  vk::CommandBuffer BeginSingleTimeCommands();
+
+  /*!
+   * Ends and submits the command buffer to the graphics queue and blocks until it is finished.
+   * The command buffer gets freed afterwards.
+   *
+   * @param commandBuffer
+   * @return
+   */
+  bool EndSingleTimeCommands(vk::CommandBuffer commandBuffer);
 };
 
 } // vulkan
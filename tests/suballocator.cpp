@@ -0,0 +1,408 @@
+#include "gtest/gtest.h"
+#include "../src/SubAllocator.h"
+#include "../src/RingAllocator.h"
+#include "../src/MemoryPool.h"
+#include "../src/FrameArena.h"
+#include "../src/HostAllocator.h"
+#include "../src/AliasingPlanner.h"
+
+#include <cstring>
+#include <deque>
+#include <map>
+#include <random>
+
+namespace {
+  using lpe::rendering::AllocationPolicy;
+  using lpe::rendering::ISubAllocator;
+
+  const AllocationPolicy policies[] = { AllocationPolicy::BestFit, AllocationPolicy::Tlsf, AllocationPolicy::Buddy, AllocationPolicy::Linear };
+
+  TEST(LPE_TEST_SUBALLOCATOR, NO_OVERLAP) {
+    for (auto policy : policies) {
+      auto allocator = lpe::rendering::CreateSubAllocator(policy);
+      allocator->Create(1 << 20);
+
+      std::mt19937 random(42);
+      std::map<uint64_t, uint64_t> live;
+
+      for (uint32_t i = 0; i < 4000; ++i) {
+        if (!live.empty() && random() % 3 == 0) {
+          auto iter = live.begin();
+          std::advance(iter, random() % live.size());
+          allocator->Free(iter->first);
+          live.erase(iter);
+          continue;
+        }
+
+        uint64_t size = 1 + random() % 4096;
+        uint64_t alignment = 1ull << (random() % 9);
+        uint64_t offset = allocator->Allocate(size, alignment);
+        if (offset == ISubAllocator::InvalidOffset) {
+          continue;
+        }
+
+        EXPECT_EQ(offset % alignment, 0u);
+        EXPECT_LE(offset + size, allocator->GetSize());
+
+        auto next = live.lower_bound(offset);
+        if (next != live.end()) {
+          EXPECT_LE(offset + size, next->first);
+        }
+        if (next != live.begin()) {
+          EXPECT_LE(std::prev(next)->second, offset);
+        }
+
+        live.emplace(offset, offset + size);
+      }
+
+      EXPECT_EQ(allocator->GetAllocationCount(), live.size());
+    }
+  }
+
+  TEST(LPE_TEST_SUBALLOCATOR, MERGES_FREED_MEMORY) {
+    for (auto policy : policies) {
+      auto allocator = lpe::rendering::CreateSubAllocator(policy);
+      allocator->Create(1 << 16);
+
+      std::vector<uint64_t> offsets;
+      uint64_t offset;
+      while ((offset = allocator->Allocate(1024)) != ISubAllocator::InvalidOffset) {
+        offsets.push_back(offset);
+      }
+
+      EXPECT_EQ(offsets.size(), 64u);
+      EXPECT_FALSE(allocator->CanAllocate(1024));
+
+      for (size_t i = 0; i < offsets.size(); i += 2) {
+        allocator->Free(offsets[i]);
+      }
+      for (size_t i = 1; i < offsets.size(); i += 2) {
+        allocator->Free(offsets[i]);
+      }
+
+      EXPECT_EQ(allocator->GetUsage(), 0u);
+      EXPECT_EQ(allocator->GetAllocationCount(), 0u);
+      EXPECT_EQ(allocator->Allocate(1 << 16), 0u);
+    }
+  }
+
+  TEST(LPE_TEST_SUBALLOCATOR, LARGEST_FREE_BLOCK) {
+    for (auto policy : policies) {
+      auto allocator = lpe::rendering::CreateSubAllocator(policy);
+      allocator->Create(1 << 16);
+      EXPECT_EQ(allocator->GetLargestFreeBlock(), 1u << 16);
+
+      std::vector<uint64_t> offsets;
+      uint64_t offset;
+      while ((offset = allocator->Allocate(1024)) != ISubAllocator::InvalidOffset) {
+        offsets.push_back(offset);
+      }
+      EXPECT_EQ(allocator->GetLargestFreeBlock(), 0u);
+
+      // a hole in the middle, linear only gets memory back at the end
+      allocator->Free(offsets[10]);
+      allocator->Free(offsets[11]);
+      EXPECT_EQ(allocator->GetLargestFreeBlock(), policy == AllocationPolicy::Linear ? 0u : 2048u);
+
+      allocator->Free(offsets.back());
+      EXPECT_GE(allocator->GetLargestFreeBlock(), 1024u);
+      EXPECT_TRUE(allocator->CanAllocate(allocator->GetLargestFreeBlock()));
+    }
+  }
+
+  TEST(LPE_TEST_SUBALLOCATOR, LARGEST_FREE_BLOCK_ALLOCATES) {
+    const uint64_t sizes[] = { 17, 100, 1000, 4097, 123456 };
+
+    for (auto policy : policies) {
+      for (auto size : sizes) {
+        auto allocator = lpe::rendering::CreateSubAllocator(policy);
+        allocator->Create(size);
+
+        // odd sized allocations leave odd sized free blocks behind
+        for (uint64_t request = 3; allocator->GetLargestFreeBlock() > 0; request = request * 3 + 1) {
+          auto largest = allocator->GetLargestFreeBlock();
+          EXPECT_LE(largest, size - allocator->GetUsage());
+          EXPECT_TRUE(allocator->CanAllocate(largest));
+
+          auto clone = allocator->Clone();
+          EXPECT_NE(clone->Allocate(largest), ISubAllocator::InvalidOffset);
+
+          if (allocator->Allocate(std::min(request, largest)) == ISubAllocator::InvalidOffset) {
+            ADD_FAILURE();
+            break;
+          }
+        }
+      }
+    }
+  }
+
+  TEST(LPE_TEST_SUBALLOCATOR, CLONE_IS_INDEPENDENT) {
+    for (auto policy : policies) {
+      auto allocator = lpe::rendering::CreateSubAllocator(policy);
+      allocator->Create(1 << 12);
+      auto offset = allocator->Allocate(2048);
+
+      auto clone = allocator->Clone();
+      clone->Free(offset);
+
+      EXPECT_EQ(allocator->GetAllocationCount(), 1u);
+      EXPECT_EQ(clone->GetAllocationCount(), 0u);
+    }
+  }
+
+  TEST(LPE_TEST_SUBALLOCATOR, BUDDY_NON_POWER_OF_TWO) {
+    auto allocator = lpe::rendering::CreateSubAllocator(AllocationPolicy::Buddy);
+    allocator->Create(3 << 12);
+
+    EXPECT_NE(allocator->Allocate(2 << 12), ISubAllocator::InvalidOffset);
+    EXPECT_NE(allocator->Allocate(1 << 12), ISubAllocator::InvalidOffset);
+    EXPECT_FALSE(allocator->CanAllocate(1));
+  }
+
+  TEST(LPE_TEST_SUBALLOCATOR, MEMORY_POOL_CHUNKS) {
+    for (auto policy : policies) {
+      lpe::rendering::HostMemoryBackend backend(4 << 20);
+      lpe::rendering::MemoryPool pool;
+      pool.Create(backend, 0, 1 << 20, policy);
+
+      std::vector<lpe::rendering::PoolAllocation> allocations;
+      lpe::rendering::PoolAllocation allocation = {};
+      while (pool.Allocate(256 << 10, 256, allocation)) {
+        EXPECT_EQ(allocation.Offset % 256, 0u);
+        EXPECT_LE(allocation.Offset + (256 << 10), allocation.Chunk->GetSize());
+        allocations.push_back(allocation);
+      }
+
+      // the backend limit behaves like a full heap, Tlsf searches for the worst case padding
+      // and can't use the last quarter of a chunk for an aligned quarter
+      EXPECT_EQ(allocations.size(), policy == AllocationPolicy::Tlsf ? 12u : 16u);
+      EXPECT_EQ(pool.GetChunkCount(), 4u);
+      EXPECT_EQ(backend.GetAllocatedSize(), 4u << 20);
+
+      // empty chunks get released
+      for (size_t i = allocations.size() / 2; i < allocations.size(); ++i) {
+        pool.Free(allocations[i]);
+      }
+      allocations.resize(allocations.size() / 2);
+      EXPECT_EQ(pool.GetChunkCount(), 2u);
+
+      // allocations larger than a chunk get their own, large enough for the policy to place them
+      ASSERT_TRUE(pool.Allocate(3 << 19, 4096, allocation));
+      EXPECT_NE(allocation.Offset, ISubAllocator::InvalidOffset);
+      EXPECT_EQ(allocation.Offset % 4096, 0u);
+      EXPECT_LE(allocation.Offset + (3 << 19), allocation.Chunk->GetSize());
+      pool.Free(allocation);
+
+      // nothing is left behind when the backend can't provide the chunk
+      auto chunkCount = pool.GetChunkCount();
+      EXPECT_FALSE(pool.Allocate(8 << 20, 256, allocation));
+      EXPECT_FALSE(pool.AllocateDedicated(8 << 20, nullptr, allocation));
+      EXPECT_EQ(pool.GetChunkCount(), chunkCount);
+
+      // dedicated chunks hold exactly one resource of any size at offset 0
+      ASSERT_TRUE(pool.AllocateDedicated(1000001, nullptr, allocation));
+      EXPECT_EQ(allocation.Offset, 0u);
+      EXPECT_EQ(allocation.Chunk->GetSize(), 1000001u);
+      EXPECT_EQ(allocation.Chunk->GetUsage(), 1000001u);
+      EXPECT_FALSE(allocation.Chunk->Fits(1, 1));
+      EXPECT_EQ(pool.GetDedicatedChunks().size(), 1u);
+      pool.Free(allocation);
+      EXPECT_TRUE(pool.GetDedicatedChunks().empty());
+
+      for (auto&& item : allocations) {
+        pool.Free(item);
+      }
+
+      // one empty chunk stays for the next allocation
+      EXPECT_EQ(pool.GetChunkCount(), 1u);
+      EXPECT_EQ(pool.GetPeakChunkCount(), 4u);
+      EXPECT_EQ(pool.GetFragmentation(), 0.0f);
+
+      pool.Destroy();
+      EXPECT_EQ(backend.GetAllocationCount(), 0u);
+    }
+  }
+
+  TEST(LPE_TEST_SUBALLOCATOR, RING_FRAMES_IN_FLIGHT) {
+    lpe::rendering::RingAllocator ring;
+    ring.Create(1 << 16);
+
+    std::mt19937 random(7);
+    std::deque<std::map<uint64_t, uint64_t>> frames;
+    std::map<uint64_t, uint64_t> current;
+    uint32_t wraps = 0;
+
+    for (uint32_t frame = 0; frame < 500; ++frame) {
+      if (frames.size() == 3) {
+        ring.RetireFrame();
+        frames.pop_front();
+      }
+
+      uint64_t previous = 0;
+      for (uint32_t i = 0; i < 1 + random() % 20; ++i) {
+        uint64_t size = 1 + random() % 2048;
+        uint64_t alignment = 1ull << (random() % 8);
+        uint64_t offset = ring.Allocate(size, alignment);
+        if (offset == lpe::rendering::RingAllocator::InvalidOffset) {
+          continue;
+        }
+
+        EXPECT_EQ(offset % alignment, 0u);
+        EXPECT_LE(offset + size, ring.GetSize());
+        wraps += offset < previous;
+        previous = offset;
+
+        for (auto&& live : frames) {
+          for (auto&& range : live) {
+            EXPECT_TRUE(offset + size <= range.first || range.second <= offset);
+          }
+        }
+
+        current.emplace(offset, offset + size);
+      }
+
+      ring.EndFrame();
+      frames.push_back(std::move(current));
+      current.clear();
+    }
+
+    EXPECT_GT(wraps, 0u);
+    EXPECT_LE(ring.GetPeakUsage(), ring.GetSize());
+
+    while (ring.GetPendingFrameCount() > 0) {
+      ring.RetireFrame();
+    }
+    EXPECT_EQ(ring.GetUsage(), 0u);
+    EXPECT_EQ(ring.Allocate(1 << 16), 0u);
+  }
+
+  TEST(LPE_TEST_SUBALLOCATOR, RING_EMPTY_FRAMES) {
+    lpe::rendering::RingAllocator ring;
+    ring.Create(1000);
+
+    EXPECT_NE(ring.Allocate(100), lpe::rendering::RingAllocator::InvalidOffset);
+    ring.EndFrame();
+
+    // a frame without allocations is queued while the ring is empty
+    ring.EndFrame();
+    ring.RetireFrame();
+
+    auto live = ring.Allocate(300);
+    ASSERT_NE(live, lpe::rendering::RingAllocator::InvalidOffset);
+    ring.EndFrame();
+    ring.RetireFrame();
+
+    // the range of the frame in flight must not be handed out again
+    for (uint64_t size : { 600u, 50u, 80u }) {
+      auto offset = ring.Allocate(size);
+      if (offset != lpe::rendering::RingAllocator::InvalidOffset) {
+        EXPECT_TRUE(offset + size <= live || live + 300 <= offset);
+      }
+    }
+  }
+
+  TEST(LPE_TEST_SUBALLOCATOR, FRAME_ARENA_RESET) {
+    lpe::utils::LinearArena arena(256);
+
+    for (uint32_t frame = 0; frame < 3; ++frame) {
+      lpe::utils::ArenaVector<uint64_t> values{ lpe::utils::ArenaAllocator<uint64_t>(arena) };
+      for (uint64_t i = 0; i < 1000; ++i) {
+        values.push_back(i);
+      }
+
+      auto aligned = arena.Allocate(100, 64);
+      EXPECT_EQ(reinterpret_cast<uintptr_t>(aligned) % 64, 0u);
+      EXPECT_EQ(values[999], 999u);
+
+      arena.Reset();
+      EXPECT_EQ(arena.GetUsage(), 0u);
+    }
+
+    // the first frame grew the arena, the blocks got merged and the later frames fit
+    EXPECT_GE(arena.GetCapacity(), arena.GetPeakUsage());
+    void* first = arena.Allocate(1);
+    arena.Reset();
+    EXPECT_EQ(arena.Allocate(1), first);
+  }
+
+  TEST(LPE_TEST_SUBALLOCATOR, HOST_ALLOCATOR_SCOPES) {
+    lpe::utils::HostAllocator allocator(2);
+
+    auto small = static_cast<uint8_t*>(allocator.Allocate(24, 8, 0));
+    auto aligned = allocator.Allocate(100, 256, 1);
+    auto large = static_cast<uint8_t*>(allocator.Allocate(1 << 20, 16, 1));
+    ASSERT_NE(small, nullptr);
+    ASSERT_NE(aligned, nullptr);
+    ASSERT_NE(large, nullptr);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(aligned) % 256, 0u);
+    EXPECT_EQ(allocator.GetStatistics(0).Usage, 24u);
+    EXPECT_EQ(allocator.GetStatistics(1).Usage, 100u + (1 << 20));
+
+    std::memset(small, 0xAB, 24);
+    large[(1 << 20) - 1] = 1;
+
+    // growing inside the size class keeps the pointer, beyond it the data moves
+    EXPECT_EQ(allocator.Reallocate(small, 16, 8, 0), small);
+    auto grown = static_cast<uint8_t*>(allocator.Reallocate(small, 1000, 8, 0));
+    ASSERT_NE(grown, nullptr);
+    EXPECT_EQ(grown[15], 0xAB);
+    EXPECT_EQ(allocator.GetStatistics(0).Usage, 1000u);
+    EXPECT_EQ(allocator.GetStatistics(0).AllocationCount, 1u);
+
+    allocator.Free(grown);
+    allocator.Free(aligned);
+    EXPECT_EQ(allocator.Reallocate(large, 0, 16, 1), nullptr);
+    allocator.Free(nullptr);
+
+    auto total = allocator.GetTotalStatistics();
+    EXPECT_EQ(total.Usage, 0u);
+    EXPECT_EQ(total.AllocationCount, 0u);
+    EXPECT_EQ(total.TotalAllocations, total.TotalFrees);
+    EXPECT_EQ(allocator.GetStatistics(1).PeakUsage, 100u + (1 << 20));
+
+    // freed slots get reused without new slabs
+    auto slabSize = allocator.GetSlabSize();
+    for (uint32_t i = 0; i < 10000; ++i) {
+      allocator.Free(allocator.Allocate(48, 16));
+    }
+    EXPECT_EQ(allocator.GetSlabSize(), slabSize);
+  }
+
+  TEST(LPE_TEST_SUBALLOCATOR, ALIASING_PLANNER) {
+    lpe::rendering::AliasingPlanner planner;
+
+    // shadow map (passes 0-1), two post process targets ping ponging (2-3, 3-4), depth (1-2), bloom (4-5)
+    auto shadow = planner.Add(4 << 20, 4096, 0, 1);
+    auto first = planner.Add(8 << 20, 4096, 2, 3);
+    auto second = planner.Add(8 << 20, 4096, 3, 4);
+    auto depth = planner.Add(8 << 20, 4096, 1, 2);
+    auto bloom = planner.Add(2 << 20, 256, 4, 5);
+
+    auto size = planner.Plan();
+    EXPECT_EQ(size, planner.GetSize());
+    EXPECT_LT(size, planner.GetUnaliasedSize());
+    EXPECT_EQ(planner.GetUnaliasedSize(), 30u << 20);
+
+    for (uint32_t i = 0; i < planner.GetResourceCount(); ++i) {
+      auto& resource = planner.GetResource(i);
+      EXPECT_EQ(planner.GetOffset(i) % resource.Alignment, 0u);
+      EXPECT_LE(planner.GetOffset(i) + resource.Size, size);
+
+      // resources which share bytes are never alive at the same time
+      for (auto alias : planner.GetAliases(i)) {
+        auto& other = planner.GetResource(alias);
+        EXPECT_TRUE(resource.LastPass < other.FirstPass || other.LastPass < resource.FirstPass);
+      }
+    }
+
+    // at most two 8MiB targets are alive at once
+    EXPECT_EQ(size, 16u << 20);
+    EXPECT_FALSE(planner.GetAliases(shadow).empty());
+    EXPECT_FALSE(planner.GetAliases(bloom).empty());
+    EXPECT_NE(planner.GetOffset(first), planner.GetOffset(second));
+    EXPECT_NE(planner.GetOffset(first), planner.GetOffset(depth));
+
+    planner.Clear();
+    EXPECT_EQ(planner.Plan(), 0u);
+  }
+}
@@ -0,0 +1,48 @@
+#include "gtest/gtest.h"
+#include "../src/Triangulator.h"
+
+#include <cmath>
+
+namespace {
+  float SignedArea(const std::vector<glm::vec2>& points, const std::vector<uint32_t>& indices) {
+    float area = 0.0f;
+    for (size_t i = 0; i < indices.size(); i += 3) {
+      glm::vec2 a = points[indices[i]];
+      glm::vec2 b = points[indices[i + 1]];
+      glm::vec2 c = points[indices[i + 2]];
+      area += 0.5f * ((b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x));
+    }
+    return area;
+  }
+
+  TEST(LPE_TEST_TRIANGULATOR, SQUARE_WITH_HOLE) {
+    lpe::rendering::Triangulator triangulator;
+    std::vector<glm::vec2> points = { {0, 0}, {10, 0}, {10, 10}, {0, 10}, {3, 3}, {3, 7}, {7, 7}, {7, 3} };
+    std::vector<uint32_t> indices;
+
+    EXPECT_EQ(triangulator.Triangulate(points, { 4 }, indices), 24u);
+    EXPECT_FLOAT_EQ(SignedArea(points, indices), 84.0f);
+  }
+
+  TEST(LPE_TEST_TRIANGULATOR, KEEPS_WINDING) {
+    lpe::rendering::Triangulator triangulator;
+    std::vector<glm::vec2> points = { {0, 0}, {0, 10}, {10, 10}, {10, 0} };
+    std::vector<uint32_t> indices;
+
+    EXPECT_EQ(triangulator.Triangulate(points, {}, indices), 6u);
+    EXPECT_FLOAT_EQ(SignedArea(points, indices), -100.0f);
+  }
+
+  TEST(LPE_TEST_TRIANGULATOR, LARGE_POLYGON) {
+    lpe::rendering::Triangulator triangulator;
+    std::vector<glm::vec2> points;
+    for (uint32_t i = 0; i < 10000; ++i) {
+      float angle = 6.2831853f * i / 10000.0f;
+      float radius = i % 2 ? 0.99f : 1.0f;
+      points.emplace_back(radius * std::cos(angle), radius * std::sin(angle));
+    }
+    std::vector<uint32_t> indices;
+
+    EXPECT_EQ(triangulator.Triangulate(points, {}, indices), (10000u - 2u) * 3u);
+  }
+}